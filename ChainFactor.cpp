@@ -0,0 +1,160 @@
+// ChainFactor.cpp
+#include "ChainFactor.hpp"
+#include "TopologyGraph.hpp"
+#include "YieldProfile.hpp"
+#include <vector>
+#include <limits>
+
+namespace {
+using Q    = ChainFactor::Q;
+using i128 = __int128;
+
+// ===== 정확한 유리수 (int64 기약 분수, 중간 계산은 int128) =====
+// 결과가 int64를 넘으면 ok = false (호출자는 known = false로)
+struct Arith {
+    bool ok = true;
+
+    static i128 gcd(i128 a, i128 b) noexcept {
+        if (a < 0) a = -a;
+        while (b != 0) { const i128 t = a % b; a = b; b = t < 0 ? -t : t; }
+        return a;
+    }
+
+    Q make(i128 n, i128 d) noexcept {
+        if (d < 0) { n = -n; d = -d; }
+        if (n == 0) return Q{0, 1};
+        const i128 g = gcd(n, d);
+        if (g > 1) { n /= g; d /= g; }
+        constexpr i128 lo = std::numeric_limits<std::int64_t>::min() + 1;
+        constexpr i128 hi = std::numeric_limits<std::int64_t>::max();
+        if (n < lo || n > hi || d > hi) { ok = false; return Q{0, 1}; }
+        return Q{(std::int64_t)n, (std::int64_t)d};
+    }
+
+    Q mul(Q a, Q b) noexcept { return make((i128)a.num * b.num, (i128)a.den * b.den); }
+    Q div(Q a, Q b) noexcept { return make((i128)a.num * b.den, (i128)a.den * b.num); }   // b != 0
+    Q sub(Q a, Q b) noexcept { return make((i128)a.num * b.den - (i128)b.num * a.den, (i128)a.den * b.den); }
+};
+
+inline int sign(Q q) noexcept { return (q.num > 0) - (q.num < 0); }
+
+// ===== 블록 하나 소거 =====
+// 변수: [이전 끝 (1~2개)] + [블록 곡선]. 왼쪽 끝과 새 오른쪽 끝만 남기고 나머지를 피벗 부호대로 센다
+ChainFactor eliminate_block(const ChainFactor* prev, LKind kind, int param)
+{
+    const CurveEntry& ce = curve_entry(spec_of(kind, param));
+    const int k = ce.ports.size, bl = ce.ports.left, br = ce.ports.right;
+    if (k <= 0 || bl < 0 || br < 0) return ChainFactor{};   // 곡선 없는 블록: 끊긴 체인
+
+    const int base = prev ? prev->ends : 0;
+    const int m = base + k;
+    thread_local std::vector<Q> M;
+    M.assign((std::size_t)m * m, Q{});
+    auto at = [&](int i, int j) -> Q& { return M[(std::size_t)i * m + j]; };
+
+    if (prev) {
+        at(0, 0) = prev->s[0];
+        if (prev->ends == 2) { at(0, 1) = at(1, 0) = prev->s[1]; at(1, 1) = prev->s[2]; }
+    }
+    const Eigen::MatrixXi& B = ce.tensor.GetIntersectionFormRef();
+    for (int i = 0; i < k; ++i)
+        for (int j = 0; j < k; ++j) at(base + i, base + j) = Q{B(i, j), 1};
+    if (prev) {
+        const int oldR = base - 1;   // ends == 1이면 왼쪽 끝과 같은 곡선
+        at(oldR, base + bl).num += 1;
+        at(base + bl, oldR).num += 1;
+    }
+
+    ChainFactor out;
+    out.known = true;
+    if (prev) { out.pos = prev->pos; out.zero = prev->zero; out.neg = prev->neg; }
+    const int keepL = prev ? 0 : bl;
+    const int keepR = base + br;
+
+    Arith a;
+    thread_local std::vector<char> alive;
+    alive.assign((std::size_t)m, 1);
+    for (int x = 0; x < m; ++x) {
+        if (x == keepL || x == keepR) continue;
+        const Q piv = at(x, x);
+        alive[x] = 0;
+        if (piv.num == 0) {
+            // 지금까지 피벗이 모두 음수: 대각 0인데 행이 0이 아니면 Schur complement에 [[0,b],[b,c]] -> 양의 고윳값
+            for (int j = 0; j < m; ++j)
+                if (alive[j] && at(x, j).num != 0) { ++out.pos; return out; }
+            ++out.zero;   // 고립된 곡선: 앞으로 붙는 블록과도 닿지 않는다
+            continue;
+        }
+        if (piv.num > 0) { ++out.pos; return out; }
+        ++out.neg;
+        for (int i = 0; i < m; ++i) {
+            if (!alive[i] || at(i, x).num == 0) continue;
+            const Q f = a.div(at(i, x), piv);
+            for (int j = 0; j < m; ++j) {
+                if (!alive[j] || at(x, j).num == 0) continue;
+                at(i, j) = a.sub(at(i, j), a.mul(f, at(x, j)));
+            }
+        }
+        if (!a.ok) return ChainFactor{};
+    }
+
+    if (keepL == keepR) {
+        out.ends = 1;
+        out.s[0] = at(keepL, keepL);
+    } else {
+        out.ends = 2;
+        out.s[0] = at(keepL, keepL);
+        out.s[1] = at(keepL, keepR);
+        out.s[2] = at(keepR, keepR);
+    }
+    return out;
+}
+}
+
+// ===== ChainFactor =====
+bool ChainFactor::inertia(int& p, int& z, int& n) const noexcept {
+    p = pos; z = zero; n = neg;
+    if (pos > 0) return true;   // 소거 중에 멈췄다 (끝은 보지 않아도 dead)
+    auto add = [&](int sg){ (sg > 0 ? p : sg < 0 ? n : z) += 1; };
+    if (ends == 1) { add(sign(s[0])); return true; }
+    if (ends != 2) return false;
+
+    // [[a, b], [b, c]]: det < 0 -> (+, -), det > 0 -> a의 부호 둘, det == 0 -> 0 하나 + 대각합의 부호
+    Arith ar;
+    const Q det = ar.sub(ar.mul(s[0], s[2]), ar.mul(s[1], s[1]));
+    if (!ar.ok) return false;
+    if (sign(det) < 0)      { add(1); add(-1); }
+    else if (sign(det) > 0) { add(sign(s[0])); add(sign(s[0])); }
+    else {
+        add(0);
+        add(sign(s[0]) != 0 ? sign(s[0]) : sign(s[2]));
+    }
+    return true;
+}
+
+bool ChainFactor::dead() const noexcept {
+    int p, z, n;
+    return known && inertia(p, z, n) && (p >= 1 || z >= 2);
+}
+
+int ChainFactor::yield() const noexcept {
+    int p, z, n;
+    if (!known || !inertia(p, z, n)) return -1;
+    if (p == 0 && z == 0) return kYieldSCFT;
+    if (p == 0 && z == 1) return kYieldLST;
+    return kYieldNonPhysical;
+}
+
+ChainFactor factor_chain(const Topology& T) {
+    if (T.block.empty() || !T.isChain() || !T.side_links.empty() || !T.instantons.empty()
+        || !T.s_connection.empty() || !T.i_connection.empty()) return ChainFactor{};
+    ChainFactor f = eliminate_block(nullptr, T.block[0].kind, T.block[0].param);
+    for (std::size_t k = 1; k < T.block.size() && f.known && !f.dead(); ++k)
+        f = eliminate_block(&f, T.block[k].kind, T.block[k].param);
+    return f;
+}
+
+ChainFactor extend_factor(const ChainFactor& f, LKind kind, int param) {
+    if (!f.known || f.dead()) return f;
+    return eliminate_block(&f, kind, param);
+}
@@ -0,0 +1,39 @@
+// ChainFactor.hpp
+#pragma once
+#include "Topology.h"
+#include <cstdint>
+
+// 체인 IF의 정확한 소거 상태 (topology_generator의 접두어 가지치기 + 판정용).
+// 체인은 양 끝 곡선(첫 블록 Left 포트, 마지막 블록 Right 포트)으로만 더 자란다. 그래서 나머지 곡선은
+// 유리수로 정확히 소거해서 피벗 부호(= 관성, Sylvester)만 세고, 두 끝의 Schur complement(2x2)만 들고 다닌다.
+// 블록 하나를 붙이는 갱신은 (끝 2개 + 블록 곡선 수) 크기의 소거라 체인 길이와 무관하다.
+//
+// 접두어 IF는 늘린 체인 IF의 주 부분행렬이라 (interlacing) 0 이상 고윳값 수는 줄지 않는다:
+//   - 양의 고윳값이 있거나 0이 둘 이상이면 어떻게 늘려도 LST/SCFT가 아니다 (dead)
+//   - 아니면 0이 없으면 SCFT, 하나면 LST
+// 소거가 음의 피벗만 거쳤는데 다음 피벗이 0이면서 행이 0이 아니면 그 자리에서 양의 고윳값이 있다.
+// 장식이 있거나, 곡선 없는 블록이 있거나, 분수가 int64를 넘으면 known = false (기존 고윳값 판정으로).
+struct ChainFactor {
+    struct Q { std::int64_t num = 0, den = 1; };   // 기약 분수, den > 0
+
+    bool known = false;
+    int  pos = 0, zero = 0, neg = 0;   // 소거한 곡선의 관성
+    int  ends = 0;                     // 남긴 곡선 수: 1 (체인이 곡선 하나) / 2 (왼쪽 끝, 오른쪽 끝)
+    Q    s[3];                         // 끝의 Schur complement: LL, LR, RR (ends == 1이면 s[0]만)
+
+    // 전체 관성 (소거한 곡선 + 남긴 끝). known일 때만 의미가 있다. 끝 계산이 넘치면 false
+    bool inertia(int& p, int& z, int& n) const noexcept;
+    // known이고 p >= 1 또는 z >= 2: 이 체인을 접두어로 가진 체인은 모두 LST/SCFT가 아니다
+    bool dead() const noexcept;
+    // kYieldLST / kYieldSCFT / kYieldNonPhysical. 모르면 -1
+    int  yield() const noexcept;
+    // 반사한 체인의 상태 (왼쪽 <-> 오른쪽)
+    void reflect() noexcept { if (ends == 2) std::swap(s[0], s[2]); }
+};
+
+// 처음부터: 블록을 왼쪽부터 extend_factor로 접는다. 체인이 아니거나 장식이 있으면 known = false
+ChainFactor factor_chain(const Topology& T);
+
+// 오른쪽 끝에 블록 하나 (마지막 블록 Right 포트 -- 새 블록 Left 포트, 가중치 1; TheoryGraph::connect와 같다).
+// f가 dead면 그대로 dead
+ChainFactor extend_factor(const ChainFactor& f, LKind kind, int param);
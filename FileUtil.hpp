@@ -0,0 +1,55 @@
+// FileUtil.hpp
+#pragma once
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+
+// 임시 파일(<path>.tmp)에 쓰고 commit()에서 rename으로 교체한다.
+// commit 전에 소멸하면 (실패/예외) 임시 파일을 지우고 원본은 그대로 둔다.
+//
+//   AtomicOutFile f(path);
+//   f.stream() << ...;
+//   if (!f.commit()) ...
+class AtomicOutFile {
+public:
+    explicit AtomicOutFile(std::string path, std::ios::openmode mode = std::ios::binary)
+        : path_(std::move(path)), tmp_(path_ + ".tmp")
+    {
+        const auto p = std::filesystem::path(path_);
+        std::error_code ec;
+        if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path(), ec);
+        out_.open(tmp_, mode | std::ios::out | std::ios::trunc);
+    }
+    ~AtomicOutFile() { if (!done_) discard(); }
+
+    AtomicOutFile(const AtomicOutFile&) = delete;
+    AtomicOutFile& operator=(const AtomicOutFile&) = delete;
+
+    std::ofstream&     stream() noexcept { return out_; }
+    bool               ok() const noexcept { return (bool)out_; }
+    const std::string& path() const noexcept { return path_; }
+
+    bool commit() {
+        if (done_) return false;
+        done_ = true;
+        out_.close();
+        std::error_code ec;
+        if (!out_) { std::filesystem::remove(tmp_, ec); return false; }
+        std::filesystem::rename(tmp_, path_, ec);
+        if (ec) { std::filesystem::remove(tmp_, ec); return false; }
+        return true;
+    }
+
+    void discard() {
+        done_ = true;
+        out_.close();
+        std::error_code ec;
+        std::filesystem::remove(tmp_, ec);
+    }
+
+private:
+    std::string   path_, tmp_;
+    std::ofstream out_;
+    bool          done_ = false;
+};
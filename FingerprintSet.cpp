@@ -0,0 +1,242 @@
+// FingerprintSet.cpp
+#include "FingerprintSet.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+// ===== 지문 (MurmurHash3 x64-128) =====
+namespace {
+inline std::uint64_t rotl64(std::uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+
+inline std::uint64_t fmix64(std::uint64_t k) noexcept {
+    k ^= k >> 33; k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline void put_i32(std::string& out, int v){
+    const std::int32_t x = v;
+    out.append(reinterpret_cast<const char*>(&x), sizeof x);
+}
+}
+
+Fingerprint fingerprint_bytes(const void* data, std::size_t n) noexcept {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const std::size_t nblocks = n / 16;
+    std::uint64_t h1 = 0x9e3779b97f4a7c15ULL, h2 = 0x9e3779b97f4a7c15ULL;
+    const std::uint64_t c1 = 0x87c37b91114253d5ULL, c2 = 0x4cf5ad432745937fULL;
+
+    for (std::size_t i = 0; i < nblocks; ++i) {
+        std::uint64_t k1, k2;
+        std::memcpy(&k1, p + i * 16, 8);
+        std::memcpy(&k2, p + i * 16 + 8, 8);
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    // 꼬리 (0..15바이트)
+    const unsigned char* tail = p + nblocks * 16;
+    std::uint64_t k1 = 0, k2 = 0;
+    const std::size_t rem = n & 15;
+    for (std::size_t i = rem; i > 8; --i) k2 ^= std::uint64_t(tail[i - 1]) << ((i - 9) * 8);
+    if (rem > 8) { k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2; }
+    for (std::size_t i = std::min<std::size_t>(rem, 8); i > 0; --i) k1 ^= std::uint64_t(tail[i - 1]) << ((i - 1) * 8);
+    if (rem > 0) { k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1; }
+
+    h1 ^= n; h2 ^= n;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+
+    Fingerprint f{h1, h2};
+    if (f.hi == 0 && f.lo == 0) f.lo = 1;   // {0, 0}은 빈 칸
+    return f;
+}
+
+void pack_topology_key(std::string& out, const Topology& T){
+    out.clear();
+    put_i32(out, (int)T.block.size());
+    for (const auto& b : T.block) { put_i32(out, (int)b.kind); put_i32(out, b.param); }
+    put_i32(out, (int)T.s_connection.size());
+    for (const auto& e : T.s_connection) { put_i32(out, e.u); put_i32(out, e.v); }
+    put_i32(out, (int)T.i_connection.size());
+    for (const auto& e : T.i_connection) { put_i32(out, e.u); put_i32(out, e.v); }
+    put_i32(out, (int)T.side_links.size());
+    for (const auto& s : T.side_links) put_i32(out, s.param);
+    put_i32(out, (int)T.instantons.size());
+    for (const auto& i : T.instantons) put_i32(out, i.param);
+}
+
+Fingerprint topology_fingerprint(const Topology& T, std::string& key){
+    pack_topology_key(key, T);
+    return fingerprint_bytes(key.data(), key.size());
+}
+
+// ===== 집합 =====
+FingerprintSet::FingerprintSet(std::size_t memBytes, std::string spillDir, int stripes)
+    : dir_(std::move(spillDir))
+{
+    // 조각마다 kMinSlots칸은 되도록 조각 수를 줄인다 (작은 예산도 지킨다)
+    memBytes = std::max(memBytes, kMinBytes);
+    stripes  = (int)std::clamp<std::size_t>(memBytes / kMinBytes, 1, (std::size_t)std::max(stripes, 1));
+    // 조각 표 칸 수: 예산 안에서 가장 큰 2의 거듭제곱
+    const std::size_t perStripe = memBytes / (std::size_t)stripes / sizeof(Fingerprint);
+    maxSlots_ = kMinSlots;
+    while (maxSlots_ * 2 <= perStripe) maxSlots_ *= 2;
+    for (int i = 0; i < stripes; ++i) {
+        stripes_.push_back(std::make_unique<Stripe>());
+        stripes_.back()->slots.assign(kMinSlots, Fingerprint{});
+    }
+}
+
+FingerprintSet::~FingerprintSet() {
+    std::error_code ec;
+    for (auto& s : stripes_)
+        for (auto& r : s->runs) { r->map.close(); std::filesystem::remove(r->path, ec); }
+    if (!dir_.empty()) std::filesystem::remove(dir_, ec);   // 비었을 때만 지워진다
+}
+
+std::string FingerprintSet::run_path(int id, std::size_t serial) const {
+    return dir_ + "/fp-" + std::to_string(id) + "-" + std::to_string(serial) + ".run";
+}
+
+// 선형 탐사. 있으면 true, 없으면 (insert면 넣고) false
+bool FingerprintSet::probe(Stripe& s, const Fingerprint& f, bool insert) {
+    const std::size_t mask = s.slots.size() - 1;
+    for (std::size_t i = (std::size_t)f.lo & mask;; i = (i + 1) & mask) {
+        Fingerprint& e = s.slots[i];
+        if (e == f) return true;
+        if (e.hi == 0 && e.lo == 0) {
+            if (insert) { e = f; ++s.used; }
+            return false;
+        }
+    }
+}
+
+void FingerprintSet::grow(Stripe& s, std::size_t cap) {
+    std::vector<Fingerprint> old(cap, Fingerprint{});
+    old.swap(s.slots);
+    s.used = 0;
+    for (const auto& e : old)
+        if (e.hi != 0 || e.lo != 0) probe(s, e, true);
+}
+
+// 표를 정렬해서 run 하나로 쓰고 비운다
+bool FingerprintSet::spill(Stripe& s, int id) {
+    std::vector<Fingerprint> v;
+    v.reserve(s.used);
+    for (const auto& e : s.slots)
+        if (e.hi != 0 || e.lo != 0) v.push_back(e);
+    std::sort(v.begin(), v.end());
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    auto run = std::make_unique<Run>();
+    run->path = run_path(id, s.serial++);
+    {
+        std::ofstream out(run->path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(Fingerprint)));
+        if (!out) { out.close(); std::filesystem::remove(run->path, ec); return false; }
+    }
+    if (!run->map.open(run->path)) { std::filesystem::remove(run->path, ec); return false; }
+
+    s.runs.push_back(std::move(run));
+    std::fill(s.slots.begin(), s.slots.end(), Fingerprint{});
+    s.used = 0;
+    ++s.spills;
+
+    // 크기 단계별 병합: 끝의 kFanIn개가 비슷한 크기면 (가장 오래된 것이 가장 새것의 2배 이내) 하나로.
+    // 합친 run은 한 단계 위라 앞의 run들과 다시 비교한다
+    while (s.runs.size() >= kFanIn) {
+        const std::size_t first = s.runs.size() - kFanIn;
+        if (s.runs[first]->size() > 2 * s.runs.back()->size()) break;
+        if (!merge_runs(s, id, first)) return false;
+    }
+    return true;
+}
+
+// runs[first..]를 하나로 (정렬된 배열의 k-way 병합, 겹치는 지문은 없다)
+bool FingerprintSet::merge_runs(Stripe& s, int id, std::size_t first) {
+    std::error_code ec;
+    auto merged = std::make_unique<Run>();
+    merged->path = run_path(id, s.serial++);
+    {
+        std::ofstream out(merged->path, std::ios::binary | std::ios::trunc);
+        std::vector<std::size_t> pos(s.runs.size(), 0);
+        std::vector<Fingerprint> buf;
+        buf.reserve(1u << 16);
+        for (;;) {
+            std::size_t best = s.runs.size();
+            for (std::size_t r = first; r < s.runs.size(); ++r) {
+                if (pos[r] >= s.runs[r]->size()) continue;
+                if (best == s.runs.size() || s.runs[r]->data()[pos[r]] < s.runs[best]->data()[pos[best]]) best = r;
+            }
+            if (best == s.runs.size()) break;
+            buf.push_back(s.runs[best]->data()[pos[best]++]);
+            if (buf.size() == buf.capacity()) {
+                out.write(reinterpret_cast<const char*>(buf.data()), (std::streamsize)(buf.size() * sizeof(Fingerprint)));
+                buf.clear();
+            }
+        }
+        out.write(reinterpret_cast<const char*>(buf.data()), (std::streamsize)(buf.size() * sizeof(Fingerprint)));
+        if (!out) { out.close(); std::filesystem::remove(merged->path, ec); return false; }
+    }
+    if (!merged->map.open(merged->path)) { std::filesystem::remove(merged->path, ec); return false; }
+
+    for (std::size_t r = first; r < s.runs.size(); ++r) { s.runs[r]->map.close(); std::filesystem::remove(s.runs[r]->path, ec); }
+    s.runs.resize(first);
+    s.runs.push_back(std::move(merged));
+    return true;
+}
+
+// 지문은 고르게 퍼져 있다: hi로 자리를 짐작하고 양쪽으로 넓혀 구간을 잡은 뒤 그 안만 이분 탐색
+// (run이 커도 건드리는 페이지가 몇 개뿐이다)
+bool FingerprintSet::run_contains(const Run& r, const Fingerprint& f) {
+    const Fingerprint* d = r.data();
+    const std::size_t n = r.size();
+    if (n == 0) return false;
+    std::size_t lo = (std::size_t)(((unsigned __int128)f.hi * n) >> 64), hi = lo + 1;
+    for (std::size_t step = 16; lo > 0 && f < d[lo]; step *= 2) lo = lo > step ? lo - step : 0;
+    for (std::size_t step = 16; hi < n && !(f < d[hi - 1]); step *= 2) hi = std::min(n, hi + step);
+    return std::binary_search(d + lo, d + hi, f);
+}
+
+bool FingerprintSet::insert(const Fingerprint& f) {
+    const int id = (int)(f.hi % stripes_.size());
+    Stripe& s = *stripes_[id];
+    std::lock_guard<std::mutex> lock(s.mtx);
+
+    if (probe(s, f, false)) return false;
+    for (const auto& r : s.runs)
+        if (run_contains(*r, f)) return false;
+
+    // 채움률 1/2을 넘으면 키우고, 예산 끝이면 흘린다 (못 흘리면 예산을 넘겨서라도 키운다)
+    if ((s.used + 1) * 2 > s.slots.size()) {
+        if (s.slots.size() < maxSlots_ || !spill(s, id)) grow(s, s.slots.size() * 2);
+    }
+    probe(s, f, true);
+    ++s.total;
+    return true;
+}
+
+std::uint64_t FingerprintSet::size() const {
+    std::uint64_t n = 0;
+    for (const auto& s : stripes_) { std::lock_guard<std::mutex> lock(s->mtx); n += s->total; }
+    return n;
+}
+
+std::size_t FingerprintSet::runs() const {
+    std::size_t n = 0;
+    for (const auto& s : stripes_) { std::lock_guard<std::mutex> lock(s->mtx); n += s->runs.size(); }
+    return n;
+}
+
+std::size_t FingerprintSet::spills() const {
+    std::size_t n = 0;
+    for (const auto& s : stripes_) { std::lock_guard<std::mutex> lock(s->mtx); n += s->spills; }
+    return n;
+}
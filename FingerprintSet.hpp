@@ -0,0 +1,82 @@
+// FingerprintSet.hpp
+#pragma once
+#include "Topology.h"
+#include "MappedFile.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// 중복 제거용 128비트 지문 집합 (topology_generator의 "이미 본 출력" 표).
+// 줄 문자열 대신 지문(16B)만 들고, 메모리 예산을 넘으면 정렬된 run으로 디스크에 흘린다.
+//   - 지문: 위상의 바이너리 키(블록, 장식 연결, 장식 param; line-compact 줄과 같은 정보)의 MurmurHash3 x64-128
+//   - 메모리: 조각(stripe)마다 열린 주소 표 (선형 탐사, 빈 칸 = 0). 조각마다 잠금 하나라 스레드끼리 나눠 쓴다
+//   - spill: 조각 표가 예산/조각 수를 넘으면 정렬해서 <dir>/fp-<stripe>-<n>.run 으로 쓰고 비운다.
+//     조회는 표 다음 run마다 이분 탐색 (mmap). 크기가 비슷한 (2배 이내) 최근 run이 kFanIn개 모이면 그것만
+//     하나로 병합한다 (크기 단계별: 지문 하나는 log_kFanIn(spill 수)번만 다시 쓰이고, run 수도 로그로 묶인다)
+//   - 예산: 조각 표 하나는 최소 kMinSlots칸이라, 예산이 작으면 조각 수를 줄인다. 최소 예산 kMinBytes (16 KiB)
+// run 파일은 소멸할 때 지운다 (한 실행 안에서만 유효).
+struct Fingerprint {
+    std::uint64_t hi = 0, lo = 0;
+    bool operator==(const Fingerprint& o) const noexcept { return hi == o.hi && lo == o.lo; }
+    bool operator<(const Fingerprint& o) const noexcept { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+};
+
+Fingerprint fingerprint_bytes(const void* data, std::size_t n) noexcept;
+
+// 바이너리 키 (int32 열): 블록 (kind, param), S/I 연결 (u, v), 장식 param. l_connection은 넣지 않는다 (체인)
+void        pack_topology_key(std::string& out, const Topology& T);
+// key는 재사용 버퍼
+Fingerprint topology_fingerprint(const Topology& T, std::string& key);
+
+class FingerprintSet {
+public:
+    static constexpr std::size_t kMinSlots = 1024;
+    static constexpr std::size_t kMinBytes = kMinSlots * sizeof(Fingerprint);
+
+    // memBytes: 메모리 표 전체 예산 (kMinBytes 미만이면 kMinBytes). spillDir: run 파일 디렉터리 (필요할 때 만든다).
+    // stripes: 최대 조각 수 (조각마다 kMinSlots칸 이상 되도록 줄인다)
+    FingerprintSet(std::size_t memBytes, std::string spillDir, int stripes = 64);
+    ~FingerprintSet();
+
+    FingerprintSet(const FingerprintSet&) = delete;
+    FingerprintSet& operator=(const FingerprintSet&) = delete;
+
+    // 새 지문이면 넣고 true. 이미 있으면 false. run을 못 쓰면 (디스크) 표를 그냥 키운다
+    bool insert(const Fingerprint& f);
+
+    std::uint64_t size() const;
+    std::size_t   runs() const;      // 지금 디스크에 있는 run 수
+    std::size_t   spills() const;    // 지금까지 흘린 횟수
+
+private:
+    static constexpr std::size_t kFanIn = 4;
+
+    struct Run {
+        std::string path;
+        MappedFile  map;
+        const Fingerprint* data() const noexcept { return reinterpret_cast<const Fingerprint*>(map.data()); }
+        std::size_t size() const noexcept { return map.size() / sizeof(Fingerprint); }
+    };
+
+    struct Stripe {
+        std::mutex               mtx;
+        std::vector<Fingerprint> slots;     // 2의 거듭제곱, 빈 칸 = {0, 0}
+        std::size_t              used = 0;
+        std::uint64_t            total = 0; // 표 + run
+        std::vector<std::unique_ptr<Run>> runs;   // 오래된 (큰) 것부터
+        std::size_t              spills = 0, serial = 0;
+    };
+
+    static bool run_contains(const Run& r, const Fingerprint& f);
+    bool probe(Stripe& s, const Fingerprint& f, bool insert);
+    void grow(Stripe& s, std::size_t cap);
+    bool spill(Stripe& s, int id);
+    bool merge_runs(Stripe& s, int id, std::size_t first);   // runs[first..]를 하나로
+    std::string run_path(int id, std::size_t serial) const;
+
+    std::string                          dir_;
+    std::size_t                          maxSlots_;   // 조각 표의 최대 칸 수
+    std::vector<std::unique_ptr<Stripe>> stripes_;
+};
@@ -0,0 +1,239 @@
+// IFCodec.cpp
+#include "IFCodec.hpp"
+#include "FileUtil.hpp"
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+// ===== 쓰기 =====
+void append_if_text(std::string& out, const Eigen::MatrixXi& M){
+    const int R = (int)M.rows(), C = (int)M.cols();
+    char buf[12];
+    for (int i=0;i<R;++i){
+        for (int j=0;j<C;++j){
+            if (j) out.push_back(' ');
+            const auto r = std::to_chars(buf, buf + sizeof buf, M(i,j));
+            out.append(buf, r.ptr);
+        }
+        out.push_back('\n');
+    }
+    out.push_back('\n');
+}
+
+// ===== 읽기 =====
+static inline bool is_blank(char c){ return c==' ' || c=='\t' || c=='\r'; }
+
+// 다음 줄 (개행 제외, \r 제거)
+static inline std::string_view take_line(std::string_view& in){
+    const size_t k = in.find('\n');
+    std::string_view line = in.substr(0, k);
+    in.remove_prefix(k == std::string_view::npos ? in.size() : k + 1);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+static inline bool is_empty_line(std::string_view s){
+    for (char c : s) if (!is_blank(c)) return false;
+    return true;
+}
+
+IFStatus parse_if_text(std::string_view& in, Eigen::MatrixXi& out){
+    thread_local std::vector<int> vals;
+    vals.clear();
+
+    std::string_view line;
+    do {
+        if (in.empty()) return IFStatus::End;
+        line = take_line(in);
+    } while (is_empty_line(line));
+
+    int cols = -1, rows = 0;
+    for (;;) {
+        int n = 0;
+        const char* p = line.data();
+        const char* e = p + line.size();
+        for (;;) {
+            while (p < e && is_blank(*p)) ++p;
+            if (p == e) break;
+            int v;
+            const auto r = std::from_chars(p, e, v);
+            if (r.ec != std::errc() || (r.ptr < e && !is_blank(*r.ptr))) return IFStatus::BadInt;
+            vals.push_back(v);
+            p = r.ptr;
+            ++n;
+        }
+        if (cols < 0) cols = n;
+        else if (n != cols) return IFStatus::Ragged;
+        ++rows;
+
+        if (in.empty()) break;
+        line = take_line(in);
+        if (is_empty_line(line)) break;
+    }
+
+    out.resize(rows, cols);
+    for (int i=0;i<rows;++i)
+        for (int j=0;j<cols;++j) out(i,j) = vals[(size_t)i * cols + j];
+    return IFStatus::Ok;
+}
+
+// ===== 바이너리 =====
+namespace {
+inline void put_varint(std::string& out, std::uint64_t v){
+    while (v >= 0x80) { out.push_back((char)(v | 0x80)); v >>= 7; }
+    out.push_back((char)v);
+}
+inline void put_zigzag(std::string& out, std::int64_t v){
+    put_varint(out, ((std::uint64_t)v << 1) ^ (std::uint64_t)(v >> 63));
+}
+
+inline bool get_varint(std::string_view& in, std::uint64_t& v){
+    v = 0;
+    for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+        const unsigned char c = (unsigned char)in.front();
+        in.remove_prefix(1);
+        v |= (std::uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+inline bool get_zigzag(std::string_view& in, int& v){
+    std::uint64_t u;
+    if (!get_varint(in, u)) return false;
+    const std::int64_t x = (std::int64_t)(u >> 1) ^ -(std::int64_t)(u & 1);
+    if (x < INT32_MIN || x > INT32_MAX) return false;
+    v = (int)x;
+    return true;
+}
+
+constexpr int kMaxDim = 1 << 16;   // 깨진 입력으로 거대한 행렬을 만들지 않게
+}
+
+std::string ifb_index_path(const std::string& ifbPath){
+    return std::filesystem::path(ifbPath).replace_extension(".ifx").string();
+}
+
+void append_if_binary(std::string& out, const Eigen::MatrixXi& M){
+    thread_local std::string body;
+    body.clear();
+    const int T = (int)M.rows();
+    const bool sym = M.rows() == M.cols() && M == M.transpose();
+
+    put_varint(body, (std::uint64_t)T);
+    put_varint(body, sym ? 1u : 0u);
+    for (int i = 0; i < T; ++i) put_zigzag(body, M(i, i));
+
+    // 0이 아닌 비대각 항목 (대칭이면 위 삼각만)
+    std::uint64_t nnz = 0;
+    for (int i = 0; i < T; ++i)
+        for (int j = sym ? i + 1 : 0; j < T; ++j) if (j != i && M(i, j)) ++nnz;
+    put_varint(body, nnz);
+    std::uint64_t prev = 0;
+    for (int i = 0; i < T; ++i)
+        for (int j = sym ? i + 1 : 0; j < T; ++j) {
+            if (j == i || !M(i, j)) continue;
+            const std::uint64_t pos = (std::uint64_t)i * T + j;
+            put_varint(body, pos - prev);
+            put_zigzag(body, M(i, j));
+            prev = pos;
+        }
+
+    put_varint(out, body.size());
+    out += body;
+}
+
+IFStatus parse_if_binary(std::string_view& in, Eigen::MatrixXi& out){
+    if (in.empty()) return IFStatus::End;
+    std::uint64_t len;
+    if (!get_varint(in, len) || len > in.size()) return IFStatus::Truncated;
+    std::string_view body = in.substr(0, (std::size_t)len);
+    in.remove_prefix((std::size_t)len);
+
+    std::uint64_t T, flags, nnz;
+    if (!get_varint(body, T) || T > (std::uint64_t)kMaxDim || !get_varint(body, flags)) return IFStatus::Truncated;
+    const int n = (int)T;
+    const bool sym = flags & 1;
+    out.setZero(n, n);
+    for (int i = 0; i < n; ++i) if (!get_zigzag(body, out(i, i))) return IFStatus::Truncated;
+
+    if (!get_varint(body, nnz)) return IFStatus::Truncated;
+    const std::uint64_t cells = T * T;
+    std::uint64_t pos = 0;
+    for (std::uint64_t k = 0; k < nnz; ++k) {
+        std::uint64_t d;
+        int w;
+        if (!get_varint(body, d) || !get_zigzag(body, w)) return IFStatus::Truncated;
+        pos += d;
+        if (pos >= cells) return IFStatus::Truncated;
+        const int i = (int)(pos / T), j = (int)(pos % T);
+        out(i, j) = w;
+        if (sym) out(j, i) = w;
+    }
+    return body.empty() ? IFStatus::Ok : IFStatus::Truncated;
+}
+
+// ===== IFBinFile =====
+bool IFBinFile::isBinary(const std::string& path){
+    std::ifstream in(path, std::ios::binary);
+    char m[ifbin::kHeaderSize] = {};
+    return in.read(m, sizeof m) && std::memcmp(m, ifbin::kMagic, sizeof m) == 0;
+}
+
+bool IFBinFile::open(const std::string& path){
+    path_ = path;
+    offs_.clear();
+    ok_ = indexed_ = false;
+    if (!file_.open(path) || file_.size() < ifbin::kHeaderSize
+        || std::memcmp(file_.data(), ifbin::kMagic, ifbin::kHeaderSize) != 0) return false;
+    const std::uint64_t n = file_.size();
+
+    // 레코드 끝 = 시작 + 길이 varint + 본문
+    auto record_end = [&](std::uint64_t off, std::uint64_t& end) -> bool {
+        std::string_view in(file_.data() + off, (std::size_t)(n - off));
+        std::uint64_t len;
+        if (!get_varint(in, len) || len > in.size()) return false;
+        end = n - in.size() + len;
+        return true;
+    };
+
+    // 인덱스가 파일과 맞는지 (데이터 쪽은 마지막 레코드만 본다):
+    // 첫 오프셋은 헤더 바로 뒤, 오프셋은 증가, 마지막 레코드는 파일 끝에서 끝난다
+    MappedFile idx(ifb_index_path(path));
+    if (idx.is_open() && idx.size() % sizeof(std::uint64_t) == 0) {
+        offs_.resize(idx.size() / sizeof(std::uint64_t));
+        if (!offs_.empty()) std::memcpy(offs_.data(), idx.data(), idx.size());
+        std::uint64_t end = ifbin::kHeaderSize;
+        bool good = offs_.empty() || offs_[0] == ifbin::kHeaderSize;
+        for (std::size_t k = 1; good && k < offs_.size(); ++k) good = offs_[k] > offs_[k - 1] && offs_[k] < n;
+        if (good && !offs_.empty()) good = record_end(offs_.back(), end);
+        indexed_ = good && end == n;
+    }
+    end_ = n;
+    if (!indexed_) {
+        offs_.clear();
+        std::uint64_t at = ifbin::kHeaderSize, end;
+        while (at < n && record_end(at, end)) { offs_.push_back(at); at = end; }
+        end_ = at;
+    }
+    ok_ = true;
+    return true;
+}
+
+bool IFBinFile::read(std::size_t k, Eigen::MatrixXi& out) const {
+    if (!ok_ || k >= offs_.size()) return false;
+    std::string_view in = record(k);
+    return parse_if_binary(in, out) == IFStatus::Ok;
+}
+
+std::string_view IFBinFile::record(std::size_t k) const {
+    if (!ok_ || k >= offs_.size()) return {};
+    const std::uint64_t end = k + 1 < offs_.size() ? offs_[k + 1] : end_;
+    return {file_.data() + offs_[k], (std::size_t)(end - offs_[k])};
+}
+
+bool IFBinFile::writeIndex() const {
+    if (!ok_) return false;
+    AtomicOutFile f(ifb_index_path(path_));
+    f.stream().write(reinterpret_cast<const char*>(offs_.data()), (std::streamsize)(offs_.size() * sizeof(std::uint64_t)));
+    return f.commit();
+}
@@ -0,0 +1,74 @@
+// IFCodec.hpp
+#pragma once
+#include "MappedFile.hpp"
+#include <Eigen/Dense>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// IF 텍스트 형식 (classify 출력 *_IF_*.txt):
+//   행마다 공백 구분 정수, 행렬 하나가 끝나면 빈 줄.
+// to_chars/from_chars, 예외 없음. 쓰기는 호출 쪽 버퍼에 덧붙인다.
+
+enum class IFStatus {
+    Ok,
+    End,       // 더 읽을 행렬 없음
+    BadInt,    // 정수가 아님
+    Ragged,    // 행 길이가 다름
+    Truncated  // 바이너리 레코드가 잘렸거나 깨짐
+};
+
+void     append_if_text(std::string& out, const Eigen::MatrixXi& M);
+// in 앞의 행렬 하나를 읽고 in을 그 뒤로 옮긴다 (앞쪽 빈 줄은 건너뜀)
+IFStatus parse_if_text(std::string_view& in, Eigen::MatrixXi& out);
+
+// ===== 바이너리 IF (*.ifb) =====
+// 교차 행렬은 대부분 0이라 대각(자기 교차수)과 0이 아닌 비대각 항목만 varint로 쓴다.
+//   파일:   "TOPOIFB1" 뒤에 레코드가 이어진다 (덧붙이기 가능)
+//   레코드: varint bodyLen | body
+//   body:   varint T | varint flags | zigzag 대각 x T | varint nnz | (varint Δpos, zigzag w) x nnz
+//     flags bit0 = 대칭 (위 삼각 j>i만 저장). pos = i*T + j (행 우선), Δ는 앞 항목과의 차
+// 인덱스 (*.ifx, 같은 이름): 레코드 시작 오프셋 u64 (리틀 엔디언), 레코드마다 하나. 임의 접근용
+namespace ifbin {
+inline constexpr char        kMagic[8]   = {'T','O','P','O','I','F','B','1'};
+inline constexpr std::size_t kHeaderSize = 8;
+}
+
+// <x>.ifb -> <x>.ifx
+std::string ifb_index_path(const std::string& ifbPath);
+
+// 레코드 하나를 out 뒤에 붙인다 (헤더는 호출 쪽에서, 파일이 비어 있을 때만)
+void     append_if_binary(std::string& out, const Eigen::MatrixXi& M);
+// in 앞의 레코드 하나를 읽고 in을 그 뒤로 옮긴다
+IFStatus parse_if_binary(std::string_view& in, Eigen::MatrixXi& out);
+
+// mmap으로 연 .ifb. 인덱스가 없거나 파일과 안 맞으면 레코드 길이를 따라 훑어 다시 만든다 (메모리에만)
+class IFBinFile {
+public:
+    IFBinFile() = default;
+    explicit IFBinFile(const std::string& path) { open(path); }
+
+    static bool isBinary(const std::string& path);
+
+    bool open(const std::string& path);
+    bool ok() const noexcept { return ok_; }
+
+    std::size_t size() const noexcept { return offs_.size(); }
+    bool        read(std::size_t k, Eigen::MatrixXi& out) const;
+    // 레코드 k의 원래 바이트 (길이 varint 포함; 다른 .ifb에 그대로 붙일 수 있다)
+    std::string_view record(std::size_t k) const;
+    // 인덱스를 파일에서 읽었는지 (false면 훑어서 만듦)
+    bool        indexed() const noexcept { return indexed_; }
+    // 오프셋 표를 .ifx로 다시 쓴다
+    bool        writeIndex() const;
+
+    void adviseSequential() const noexcept { file_.adviseSequential(); }
+
+private:
+    std::string                path_;
+    MappedFile                 file_;
+    std::vector<std::uint64_t> offs_;
+    std::uint64_t              end_ = 0;   // 마지막 온전한 레코드 끝
+    bool                       ok_ = false, indexed_ = false;
+};
@@ -0,0 +1,126 @@
+// IFCorpus.cpp
+#include "IFCorpus.hpp"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+// ===== 텍스트 레코드 나누기 =====
+namespace {
+inline bool is_blank(char c){ return c==' ' || c=='\t' || c=='\r'; }
+
+// [p, e) 한 줄이 비었는지 (공백만)
+inline bool blank_line(const char* p, const char* e){
+    for (; p < e; ++p) if (!is_blank(*p)) return false;
+    return true;
+}
+
+// [lo, hi)에서 시작하는 레코드들의 시작 오프셋. 레코드 = 빈 줄(또는 파일 처음) 다음의 비지 않은 줄
+void split_records(const char* d, std::size_t n, std::size_t lo, std::size_t hi, std::vector<std::uint64_t>& out){
+    // lo 이후 첫 줄 시작
+    std::size_t p = lo;
+    if (p > 0 && d[p - 1] != '\n') {
+        const void* nl = std::memchr(d + p, '\n', n - p);
+        if (!nl) return;
+        p = (std::size_t)((const char*)nl - d) + 1;
+    }
+    // 바로 앞 줄이 비었는지
+    bool prevBlank = true;
+    if (p > 0) {
+        std::size_t s = p - 1;
+        while (s > 0 && d[s - 1] != '\n') --s;
+        prevBlank = blank_line(d + s, d + p - 1);
+    }
+    while (p < hi && p < n) {
+        const void* nl = std::memchr(d + p, '\n', n - p);
+        const std::size_t e = nl ? (std::size_t)((const char*)nl - d) : n;
+        const bool blank = blank_line(d + p, d + e);
+        if (!blank && prevBlank) out.push_back(p);
+        prevBlank = blank;
+        p = e + 1;
+    }
+}
+}
+
+bool IFCorpus::open(const std::string& path, int threads){
+    path_ = path;
+    ok_ = false;
+    offs_.clear();
+    text_.close();
+    bytes_ = 0;
+
+    if (IFBinFile::isBinary(path)) {
+        fmt_ = Format::Binary;
+        ok_ = bin_.open(path);
+        if (ok_) {
+            bin_.adviseSequential();
+            std::error_code ec;
+            const auto sz = std::filesystem::file_size(path, ec);
+            bytes_ = ec ? 0 : (std::uint64_t)sz;
+        }
+        return ok_;
+    }
+
+    fmt_ = Format::Text;
+    if (!text_.open(path)) return false;
+    text_.adviseSequential();
+    const char* d = text_.data();
+    const std::size_t n = text_.size();
+    bytes_ = n;
+
+    // 조각마다 (스레드 수의 4배, 조각은 1 MiB 이상) 레코드 시작을 찾고 순서대로 잇는다
+    if (threads <= 0) threads = defaultThreads();
+    const std::size_t minChunk = 1u << 20;
+    const std::size_t nChunks = std::max<std::size_t>(1, std::min<std::size_t>((std::size_t)threads * 4, n / minChunk));
+    std::vector<std::vector<std::uint64_t>> parts(nChunks);
+    std::atomic<std::size_t> next{0};
+    auto work = [&]{
+        for (std::size_t c; (c = next.fetch_add(1)) < nChunks; )
+            split_records(d, n, n * c / nChunks, n * (c + 1) / nChunks, parts[c]);
+    };
+    if (nChunks == 1) {
+        work();
+    } else {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads && (std::size_t)t < nChunks; ++t) pool.emplace_back(work);
+        for (auto& t : pool) t.join();
+    }
+
+    std::size_t total = 0;
+    for (const auto& p : parts) total += p.size();
+    offs_.reserve(total);
+    for (const auto& p : parts) offs_.insert(offs_.end(), p.begin(), p.end());
+    ok_ = true;
+    return true;
+}
+
+IFStatus IFCorpus::read(std::size_t k, Eigen::MatrixXi& out) const {
+    if (!ok_ || k >= size()) return IFStatus::End;
+    if (fmt_ == Format::Binary) return bin_.read(k, out) ? IFStatus::Ok : IFStatus::Truncated;
+    const std::uint64_t end = k + 1 < offs_.size() ? offs_[k + 1] : text_.size();
+    std::string_view in(text_.data() + offs_[k], (std::size_t)(end - offs_[k]));
+    return parse_if_text(in, out);
+}
+
+// ===== 불변량 =====
+bool if_signature(const Eigen::MatrixXi& IF, IFSignature& out, double tol){
+    thread_local Eigen::MatrixXd A;
+    thread_local Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver;
+    A = (-IF).cast<double>();
+    A = 0.5 * (A + A.transpose()).eval();
+    solver.compute(A, Eigen::EigenvaluesOnly);
+    if (solver.info() != Eigen::Success) return false;
+
+    out = IFSignature{};
+    const auto& ev = solver.eigenvalues();
+    for (int i = 0; i < ev.size(); ++i) {
+        if (std::abs(ev(i)) < tol) ++out.zero;
+        else if (ev(i) > tol)      ++out.pos;
+        else                       ++out.neg;
+    }
+    return true;
+}
+
+double if_determinant(const Eigen::MatrixXi& IF){
+    if (IF.rows() == 0) return 1.0;
+    return IF.cast<double>().partialPivLu().determinant();
+}
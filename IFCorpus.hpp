@@ -0,0 +1,103 @@
+// IFCorpus.hpp
+#pragma once
+#include "IFCodec.hpp"
+#include "MappedFile.hpp"
+#include <Eigen/Dense>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+// 기존 IF 덤프(*_IF_*.txt 텍스트 / *.ifb 바이너리)를 mmap으로 열어 레코드(행렬) 단위로 읽는다.
+// 텍스트는 파일을 조각으로 나눠 스레드마다 빈 줄 경계를 찾아 레코드 시작 오프셋 표를 만든다.
+// 레코드는 스레드별로 재사용하는 행렬에 풀린다 (from_chars, 같은 크기가 이어지면 할당 없음).
+//
+//   IFCorpus c;
+//   if (!c.open(path)) ...
+//   c.forEach(threads, [&](int tid, std::size_t k, const Eigen::MatrixXi& M){ ... });
+class IFCorpus {
+public:
+    enum class Format { Text, Binary };
+
+    // threads: 텍스트 레코드 나누기에 쓸 스레드 수 (0 = 코어 수)
+    bool open(const std::string& path, int threads = 0);
+    bool ok() const noexcept { return ok_; }
+    Format format() const noexcept { return fmt_; }
+    const std::string& path() const noexcept { return path_; }
+
+    std::size_t   size() const noexcept { return fmt_ == Format::Binary ? bin_.size() : offs_.size(); }
+    std::uint64_t bytes() const noexcept { return bytes_; }
+
+    IFStatus read(std::size_t k, Eigen::MatrixXi& out) const;
+
+    // 레코드를 threads개 스레드에 나눠 f(tid, k, M). 깨진 레코드는 건너뛰고 bad에 센다.
+    // 한 스레드 안에서는 k가 증가하는 순서
+    template<class F>
+    std::size_t forEach(int threads, F&& f, std::size_t* bad = nullptr) const;
+
+    static int defaultThreads() {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n ? (int)n : 4;
+    }
+
+private:
+    std::string                path_;
+    Format                     fmt_ = Format::Text;
+    bool                       ok_ = false;
+    std::uint64_t              bytes_ = 0;
+    MappedFile                 text_;
+    std::vector<std::uint64_t> offs_;   // 텍스트 레코드 시작
+    IFBinFile                  bin_;
+};
+
+template<class F>
+std::size_t IFCorpus::forEach(int threads, F&& f, std::size_t* bad) const {
+    if (!ok_) return 0;
+    const std::size_t n = size();
+    if (threads <= 0) threads = defaultThreads();
+    threads = (int)std::min<std::size_t>((std::size_t)threads, std::max<std::size_t>(1, n));
+
+    constexpr std::size_t kBlock = 256;   // 스레드가 한 번에 가져가는 레코드 수
+    std::atomic<std::size_t> next{0}, nbad{0}, done{0};
+    auto work = [&](int tid){
+        Eigen::MatrixXi M;
+        std::size_t b = 0, d = 0;
+        for (;;) {
+            const std::size_t lo = next.fetch_add(kBlock);
+            if (lo >= n) break;
+            const std::size_t hi = std::min(n, lo + kBlock);
+            for (std::size_t k = lo; k < hi; ++k) {
+                if (read(k, M) != IFStatus::Ok) { ++b; continue; }
+                f(tid, k, (const Eigen::MatrixXi&)M);
+                ++d;
+            }
+        }
+        nbad += b;
+        done += d;
+    };
+
+    if (threads == 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (int t = 0; t < threads; ++t) pool.emplace_back(work, t);
+        for (auto& t : pool) t.join();
+    }
+    if (bad) *bad = nbad.load();
+    return done.load();
+}
+
+// ===== 불변량 (재처리 단계) =====
+// -IF(대칭화)의 고유값 부호 개수. classify_topology와 같은 판정: SCFT = 전부 양수, LST = 0이 정확히 하나
+struct IFSignature {
+    int pos = 0, zero = 0, neg = 0;
+    bool scft() const noexcept { return neg == 0 && zero == 0; }
+    bool lst()  const noexcept { return neg == 0 && zero == 1; }
+};
+bool   if_signature(const Eigen::MatrixXi& IF, IFSignature& out, double tol = 1e-8);
+// det(IF) (부분 피벗 LU, double)
+double if_determinant(const Eigen::MatrixXi& IF);
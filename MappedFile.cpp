@@ -0,0 +1,46 @@
+// MappedFile.cpp
+#include "MappedFile.hpp"
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+    if (this != &o) {
+        close();
+        data_ = std::exchange(o.data_, nullptr);
+        size_ = std::exchange(o.size_, 0);
+        open_ = std::exchange(o.open_, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) { ::close(fd); return false; }
+    size_ = (std::size_t)st.st_size;
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) { ::close(fd); size_ = 0; return false; }
+        data_ = static_cast<const char*>(p);
+    }
+    ::close(fd);   // 매핑은 fd가 닫혀도 유지된다
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() noexcept {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+void MappedFile::adviseSequential() const noexcept {
+    if (data_) ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
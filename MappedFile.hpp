@@ -0,0 +1,33 @@
+// MappedFile.hpp
+#pragma once
+#include <string>
+#include <cstddef>
+#include <utility>
+
+// 읽기 전용 mmap (RAII). 빈 파일도 열리며 이때 data()==nullptr, size()==0
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept;
+
+    bool open(const std::string& path);
+    void close() noexcept;
+
+    bool        is_open() const noexcept { return open_; }
+    const char* data()    const noexcept { return data_; }
+    std::size_t size()    const noexcept { return size_; }
+
+    // 앞에서부터 한 번 훑는 용도라고 커널에 알림 (readahead)
+    void adviseSequential() const noexcept;
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool        open_ = false;
+};
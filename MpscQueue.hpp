@@ -0,0 +1,49 @@
+// MpscQueue.hpp
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// 생산자 여럿 / 소비자 하나, 잠금 없는 큐.
+// push는 머리에 CAS 한 번 (Treiber 스택), 소비자는 머리를 통째로 떼어 뒤집어서 넣은 순서대로 꺼낸다.
+// 같은 생산자가 넣은 것끼리는 순서가 유지된다 (생산자 사이 순서는 없다).
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    ~MpscQueue() { drain([](T&&){}); }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T v) {
+        Node* n = new Node{std::move(v), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    // 소비자 전용: 지금까지 쌓인 것을 넣은 순서대로 f(T&&). 반환: 꺼낸 수
+    template <class F>
+    std::size_t drain(F&& f) {
+        Node* h = head_.exchange(nullptr, std::memory_order_acquire);
+        Node* fifo = nullptr;
+        while (h) { Node* nx = h->next; h->next = fifo; fifo = h; h = nx; }
+        std::size_t n = 0;
+        while (fifo) {
+            Node* nx = fifo->next;
+            f(std::move(fifo->value));
+            delete fifo;
+            fifo = nx;
+            ++n;
+        }
+        return n;
+    }
+
+    bool empty() const noexcept { return head_.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node {
+        T     value;
+        Node* next;
+    };
+    std::atomic<Node*> head_{nullptr};
+};
@@ -0,0 +1,220 @@
+// PackFile.cpp
+#include "PackFile.hpp"
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+// ===== 내부 유틸 =====
+namespace {
+constexpr char          kPackMagic[8] = {'T','O','P','O','P','A','K','1'};
+constexpr char          kEndMagic[8]  = {'P','A','K','E','N','D','0','1'};
+constexpr std::uint32_t kChunkTag = 0x4b4e4843u;   // "CHNK"
+constexpr std::uint32_t kDirTag   = 0x53524944u;   // "DIRS"
+constexpr std::size_t   kChunkHeader = 16;
+constexpr std::size_t   kTrailer     = 16;
+
+template<class T>
+inline T load(const char* p){ T v; std::memcpy(&v, p, sizeof v); return v; }
+
+template<class T>
+inline void put(std::string& out, T v){ out.append(reinterpret_cast<const char*>(&v), sizeof v); }
+
+bool write_all(int fd, const char* p, std::size_t n){
+    while (n > 0) {
+        const ssize_t w = ::write(fd, p, n);
+        if (w < 0) { if (errno == EINTR) continue; return false; }
+        p += w; n -= (std::size_t)w;
+    }
+    return true;
+}
+
+// 꼬리의 디렉터리를 읽는다. 깨졌으면 false (그러면 청크를 훑는다)
+bool read_directory(const char* p, std::size_t n, PackDirectory& dir, std::uint64_t& end){
+    if (n < sizeof kPackMagic + kTrailer || std::memcmp(p + n - 8, kEndMagic, 8) != 0) return false;
+    const std::uint64_t pos = load<std::uint64_t>(p + n - kTrailer);
+    if (pos < sizeof kPackMagic || pos + 8 > n - kTrailer) return false;
+
+    const char* c = p + pos;
+    const char* e = p + n - kTrailer;
+    if (load<std::uint32_t>(c) != kDirTag) return false;
+    const std::uint32_t nKeys = load<std::uint32_t>(c + 4);
+    c += 8;
+    PackDirectory d;
+    for (std::uint32_t k = 0; k < nKeys; ++k) {
+        if (e - c < 8) return false;
+        const std::uint32_t keyLen = load<std::uint32_t>(c), nExt = load<std::uint32_t>(c + 4);
+        c += 8;
+        if ((std::uint64_t)(e - c) < keyLen + (std::uint64_t)nExt * sizeof(PackExtent)) return false;
+        auto& ext = d[std::string(c, keyLen)];
+        c += keyLen;
+        for (std::uint32_t i = 0; i < nExt; ++i, c += sizeof(PackExtent)) {
+            const PackExtent x{load<std::uint64_t>(c), load<std::uint64_t>(c + 8)};
+            if (x.offset > pos || x.size > pos - x.offset) return false;
+            ext.push_back(x);
+        }
+    }
+    dir = std::move(d);
+    end = pos;
+    return true;
+}
+
+// 꼬리가 없을 때: 온전한 청크까지 훑는다
+void scan_chunks(const char* p, std::size_t n, PackDirectory& dir, std::uint64_t& end){
+    dir.clear();
+    std::uint64_t pos = sizeof kPackMagic;
+    while (n - pos >= kChunkHeader && load<std::uint32_t>(p + pos) == kChunkTag) {
+        const std::uint32_t keyLen = load<std::uint32_t>(p + pos + 4);
+        const std::uint64_t len    = load<std::uint64_t>(p + pos + 8);
+        const std::uint64_t data   = pos + kChunkHeader + keyLen;
+        if (data > n || len > n - data) break;
+        dir[std::string(p + pos + kChunkHeader, keyLen)].push_back(PackExtent{data, len});
+        pos = data + len;
+    }
+    end = pos;
+}
+
+bool load_pack(const char* p, std::size_t n, PackDirectory& dir, std::uint64_t& end){
+    if (n < sizeof kPackMagic || std::memcmp(p, kPackMagic, sizeof kPackMagic) != 0) return false;
+    if (!read_directory(p, n, dir, end)) scan_chunks(p, n, dir, end);
+    return true;
+}
+}
+
+// ===== 읽기 =====
+bool PackReader::isPack(const std::string& path){
+    std::ifstream in(path, std::ios::binary);
+    char m[8] = {};
+    return in.read(m, sizeof m) && std::memcmp(m, kPackMagic, sizeof m) == 0;
+}
+
+bool PackReader::open(const std::string& path){
+    dir_.clear();
+    ok_ = false;
+    if (!file_.open(path)) return false;
+    std::uint64_t end = 0;
+    ok_ = load_pack(file_.data(), file_.size(), dir_, end);
+    return ok_;
+}
+
+std::vector<std::string> PackReader::keys() const {
+    std::vector<std::string> out;
+    out.reserve(dir_.size());
+    for (const auto& kv : dir_) out.push_back(kv.first);
+    return out;
+}
+
+std::vector<std::string_view> PackReader::spans(const std::string& key) const {
+    std::vector<std::string_view> out;
+    const auto it = dir_.find(key);
+    if (it == dir_.end()) return out;
+    out.reserve(it->second.size());
+    for (const auto& x : it->second) out.emplace_back(file_.data() + x.offset, (std::size_t)x.size);
+    return out;
+}
+
+bool PackReader::read(const std::string& key, std::string& out) const {
+    const auto it = dir_.find(key);
+    if (it == dir_.end()) return false;
+    for (const auto& x : it->second) out.append(file_.data() + x.offset, (std::size_t)x.size);
+    return true;
+}
+
+// ===== 쓰기 =====
+bool PackWriter::open(const std::string& path, std::size_t bufBytes){
+    close();
+    path_ = path;
+    limit_ = bufBytes;
+    failed_ = false;
+    dir_.clear();
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) return false;
+    struct stat st;
+    if (::flock(fd_, LOCK_EX) != 0 || ::fstat(fd_, &st) != 0) { ::close(fd_); fd_ = -1; return false; }
+
+    if (st.st_size == 0) {
+        end_ = sizeof kPackMagic;
+        if (!write_all(fd_, kPackMagic, sizeof kPackMagic)) { ::close(fd_); fd_ = -1; return false; }
+    } else {
+        // 기존 디렉터리를 올리고 그 자리(또는 마지막 온전한 청크 끝)부터 덮어 쓴다
+        MappedFile m(path);
+        if (!m.is_open() || !load_pack(m.data(), m.size(), dir_, end_)
+            || ::ftruncate(fd_, (off_t)end_) != 0 || ::lseek(fd_, (off_t)end_, SEEK_SET) < 0) {
+            ::close(fd_); fd_ = -1; dir_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PackWriter::append(const std::string& key, std::string_view data){
+    if (fd_ < 0) return false;
+    if (data.empty()) return true;
+    buf_[key].append(data.data(), data.size());
+    buffered_ += data.size();
+    return buffered_ < limit_ || flush();
+}
+
+std::uint64_t PackWriter::size(const std::string& key) const {
+    std::uint64_t n = 0;
+    if (const auto it = dir_.find(key); it != dir_.end())
+        for (const auto& x : it->second) n += x.size;
+    if (const auto it = buf_.find(key); it != buf_.end()) n += it->second.size();
+    return n;
+}
+
+bool PackWriter::flush(){
+    if (fd_ < 0 || failed_) return false;
+    for (auto& [key, data] : buf_) {
+        if (data.empty()) continue;
+        scratch_.clear();
+        put(scratch_, kChunkTag);
+        put(scratch_, (std::uint32_t)key.size());
+        put(scratch_, (std::uint64_t)data.size());
+        scratch_ += key;
+        const std::uint64_t off = end_ + scratch_.size();
+        if (!write_all(fd_, scratch_.data(), scratch_.size()) || !write_all(fd_, data.data(), data.size())) {
+            failed_ = true;
+            return false;
+        }
+        dir_[key].push_back(PackExtent{off, data.size()});
+        end_ = off + data.size();
+        data.clear();
+    }
+    buffered_ = 0;
+    return !failed_;
+}
+
+bool PackWriter::close(){
+    if (fd_ < 0) return false;
+    bool ok = flush();
+    if (failed_) {
+        // 반쯤 쓴 청크는 버리고 마지막 온전한 청크 뒤에 디렉터리를 쓴다
+        if (::ftruncate(fd_, (off_t)end_) != 0 || ::lseek(fd_, (off_t)end_, SEEK_SET) < 0) ok = false;
+    }
+
+    scratch_.clear();
+    put(scratch_, kDirTag);
+    put(scratch_, (std::uint32_t)dir_.size());
+    for (const auto& [key, ext] : dir_) {
+        put(scratch_, (std::uint32_t)key.size());
+        put(scratch_, (std::uint32_t)ext.size());
+        scratch_ += key;
+        for (const auto& x : ext) { put(scratch_, x.offset); put(scratch_, x.size); }
+    }
+    put(scratch_, end_);
+    scratch_.append(kEndMagic, sizeof kEndMagic);
+    if (!write_all(fd_, scratch_.data(), scratch_.size())) ok = false;
+
+    ::flock(fd_, LOCK_UN);
+    ::close(fd_);
+    fd_ = -1;
+    buf_.clear();
+    dir_.clear();
+    buffered_ = 0;
+    return ok;
+}
@@ -0,0 +1,87 @@
+// PackFile.hpp
+#pragma once
+#include "MappedFile.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+// 샤드 팩: <out>/<LST|SCFT>/len-N/<prefix>.txt 같은 작은 파일 수천 개 대신 파일 하나에 논리 샤드를 담는다.
+// 키는 예전 상대 경로 그대로 ("LST/len-5/gLgL.txt"), 내용도 같은 텍스트 줄이라 풀면 기존 트리와 같다.
+// 레이아웃 (리틀 엔디언):
+//   [헤더 8B]  "TOPOPAK1"
+//   [청크]*    u32 "CHNK" | u32 keyLen | u64 dataLen | key | data      (data는 줄 단위로 끝난다)
+//   [디렉터리] u32 "DIRS" | u32 nKeys | (u32 keyLen | u32 nExt | key | (u64 off, u64 len) x nExt) x nKeys
+//   [꼬리 16B] u64 dirPos | "PAKEND01"
+// 한 샤드는 여러 청크(extent)에 흩어져 있고, 순서대로 이으면 샤드 내용이다.
+// 덧붙이기: writer는 디렉터리를 읽고 그 자리부터 청크를 이어 쓴 뒤 닫을 때 새 디렉터리+꼬리를 쓴다.
+// 꼬리가 없으면 (쓰다가 죽음) 청크 헤더를 처음부터 훑어 온전한 청크까지 디렉터리를 다시 만든다.
+struct PackExtent {
+    std::uint64_t offset;   // data 시작 (파일 기준)
+    std::uint64_t size;
+};
+
+using PackDirectory = std::map<std::string, std::vector<PackExtent>>;
+
+// mmap으로 연다 (읽기 전용)
+class PackReader {
+public:
+    PackReader() = default;
+    explicit PackReader(const std::string& path) { open(path); }
+
+    // 앞 8바이트가 "TOPOPAK1"인지
+    static bool isPack(const std::string& path);
+
+    bool open(const std::string& path);
+    bool ok() const noexcept { return ok_; }
+
+    const PackDirectory& directory() const noexcept { return dir_; }
+    std::vector<std::string> keys() const;
+    // 키의 조각들 (순서대로). 없으면 빈 벡터. PackReader보다 오래 쓰지 말 것
+    std::vector<std::string_view> spans(const std::string& key) const;
+    // 키 내용을 out에 덧붙인다
+    bool read(const std::string& key, std::string& out) const;
+
+    void adviseSequential() const noexcept { file_.adviseSequential(); }
+
+private:
+    MappedFile    file_;
+    PackDirectory dir_;
+    bool          ok_ = false;
+};
+
+// 한 팩에는 writer 하나 (파일에 flock). 키별로 모았다가 bufBytes를 넘거나 flush()하면 키마다 청크 하나로 쓴다.
+// 텍스트 키의 append()에는 줄 단위(끝이 '\n')로 넘길 것: 청크 경계가 줄 경계여야 커서가 조각별로 읽는다.
+// 바이너리 키(.ifb/.ifx)는 조각을 이으면 원래 바이트 그대로다
+class PackWriter {
+public:
+    PackWriter() = default;
+    PackWriter(const PackWriter&) = delete;
+    PackWriter& operator=(const PackWriter&) = delete;
+    ~PackWriter() { close(); }
+
+    // 없으면 만들고, 있으면 이어 쓴다 (팩이 아닌 파일이면 false)
+    bool open(const std::string& path, std::size_t bufBytes = 4u << 20);
+    bool ok() const noexcept { return fd_ >= 0; }
+
+    bool append(const std::string& key, std::string_view data);
+    // 키의 지금 크기 (쓴 청크 + 버퍼). 없는 키는 0
+    std::uint64_t size(const std::string& key) const;
+    bool flush();
+    // 마지막 flush + 디렉터리/꼬리
+    bool close();
+
+    const std::string& path() const noexcept { return path_; }
+
+private:
+    std::string   path_;
+    int           fd_ = -1;
+    bool          failed_ = false;
+    std::size_t   limit_ = 0, buffered_ = 0;
+    std::uint64_t end_ = 0;   // 마지막 청크 끝 (디렉터리는 여기에)
+    PackDirectory dir_;
+    std::unordered_map<std::string, std::string> buf_;
+    std::string   scratch_;
+};
@@ -0,0 +1,106 @@
+// RuleBanks.hpp
+#pragma once
+#include "Topology.h"
+#include <vector>
+#include <iterator>
+
+// 세 바이너리가 공유하는 builtin 후보 bank.
+// - G_BANK/L_BANK, allowed(): topology_generator 체인 확장 (g -> L, L -> g)
+// - allowed_S_params/allowed_I_params: decorate_generator 장식 후보 (g 값별)
+// 규칙 변형 실험은 여기를 고치지 말고 RuleSet 파일로 덮어쓴다.
+
+// ========== Chain banks (same as original) ==========
+inline constexpr int G_BANK[] = {4,6,7,8,12};
+inline constexpr int L_BANK[] = {
+  11,22,33,44,55,331,32,23,42,24,43,34,53,35,54,45
+};
+
+inline constexpr int numG = (int)(sizeof(G_BANK)/sizeof(G_BANK[0]));
+inline constexpr int numL = (int)(sizeof(L_BANK)/sizeof(L_BANK[0]));
+
+// ========== Chain gluing banks ==========
+struct IntView {
+  const int* data = nullptr;
+  std::size_t size = 0;
+  bool empty() const { return size==0; }
+};
+
+#define RET_ARR(...) do { \
+  static constexpr int A__[] = { __VA_ARGS__ }; \
+  return IntView{A__, std::size(A__)}; \
+} while(0)
+
+[[nodiscard]] inline IntView allowed(LKind k, int param)
+{
+  if (k==LKind::g){
+    switch(param){
+      case 4:  RET_ARR(11,22,32,23,33,24,331,34,35);
+      case 6:  RET_ARR(22,32,33,42,331,43,34,44,53,35,45,54,55);
+      case 7:  RET_ARR(32,33,42,43,44,53,54,45,55);
+      case 8:  RET_ARR(32,33,42,43,44,53,54,45,55);
+      case 12: RET_ARR(42,53,54,55);
+      default: return {};
+    }
+  }
+
+  if (k==LKind::L){
+    switch(param){
+      case 11:  RET_ARR(4);
+      case 22:  RET_ARR(4,6);
+      case 32:  RET_ARR(4);
+      case 23:  RET_ARR(4,6,7,8);
+      case 33:  RET_ARR(4,6,7,8);
+      case 42:  RET_ARR(4);
+      case 24:  RET_ARR(6,7,8,12);
+      case 331: RET_ARR(4,6);
+      case 43:  RET_ARR(4,6);
+      case 34:  RET_ARR(6,7,8);
+      case 44:  RET_ARR(6,7,8);
+      case 53:  RET_ARR(4,6);
+      case 35:  RET_ARR(6,7,8,12);
+      case 54:  RET_ARR(6,7,8);
+      case 45:  RET_ARR(6,7,8,12);
+      case 55:  RET_ARR(6,7,8,12);
+      default: return {};
+    }
+  }
+
+  return {};
+}
+
+// ========== Decoration banks (original) ==========
+inline const std::vector<int>& allowed_S_params(int gval){
+    static std::vector<int> dummy;
+    static const std::vector<int> S_g4 = {1,882,883,22,32,23,33,42,991,9920,9902,92,93,97,98,912,915,916,917,331,43,53,99910,9913,924,925,927,928,929,934,936,937,938,940,941,942,943,956};
+    static const std::vector<int> S_g6 = {1,882,883,884,885,22,23,33,24,993,93,96,97,98,99,911,912,913,914,915,331,43,34,44,53,35,54,45,55,99910,99920,99930,994,995,9910,9912,9913,9914,918,920,921,922,924,925,926,927,928,929,933,934,935,936,937,938,939,943,944,945,9916,9917,947,951,952,955,956,957};
+    static const std::vector<int> S_g7 = {1,882,883,884,885,886,23,33,24,993,91,93,94,95,96,97,98,99,910,911,34,44,35,45,54,55,99920,99930,995,996,997,998,9911,9912,9913,9914,918,919,920,921,922,923,924,925,926,927,928,929,930,931,932,933,944,945,9915,9916,946,947,950,951,952,953,954};
+    static const std::vector<int> S_g8 = {1,882,883,884,885,886,887,23,33,24,993,91,93,94,95,96,97,98,99,910,911,34,44,35,45,54,55,99920,99930,995,996,997,998,9911,9912,9913,9914,918,919,920,921,922,923,924,925,926,927,928,929,930,931,932,933,944,945,9915,9916,946,947,950,951,952,953,954};
+    static const std::vector<int> S_g12 = {1,882,883,884,885,886,887,8881,889,8810,8811,24,93,94,95,96,35,45,55,99930,996,998,999,9912,918,919,920,921,922,923,945,9915,946,947,948,949,950};
+
+    switch (gval){
+        case 4: return S_g4;
+        case 6: return S_g6;
+        case 7: return S_g7;
+        case 8: return S_g8;
+        case 12: return S_g12;
+        default: return dummy;
+    }
+}
+
+inline const std::vector<int>& allowed_I_params(int gval){
+    static std::vector<int> dummy;
+    static const std::vector<int> I_g4 = {1,882,883};
+    static const std::vector<int> I_g6 = {1,882,883,884,885};
+    static const std::vector<int> I_g7 = {1,882,883,884,885,886};
+    static const std::vector<int> I_g8 = {1,882,883,884,885,886,887};
+    static const std::vector<int> I_g12 = {1,882,883,884,885,886,887,8881,889,8810,8811};
+
+    switch (gval){
+        case 4: return I_g4;
+        case 6: return I_g6;
+        case 7: return I_g7;
+        case 8: return I_g8;
+        case 12: return I_g12;
+        default: return dummy;
+    }
+}
@@ -0,0 +1,249 @@
+// RuleSet.cpp
+#include "RuleSet.hpp"
+#include "RuleBanks.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+
+// ===== 내부 유틸 =====
+static const std::vector<int>& empty_bank(){
+    static const std::vector<int> none;
+    return none;
+}
+
+// allowed()는 IntView라서 vector로 한 번만 펼쳐 둔다
+static const std::vector<int>& builtin_chain_bank(LKind k, int param){
+    static const std::map<long long, std::vector<int>> banks = []{
+        std::map<long long, std::vector<int>> m;
+        auto put = [&](LKind kk, int p){
+            const IntView v = allowed(kk, p);
+            m[((long long)kk << 32) | (unsigned)p] = std::vector<int>(v.data, v.data + v.size);
+        };
+        for (int g : G_BANK) put(LKind::g, g);
+        for (int l : L_BANK) put(LKind::L, l);
+        return m;
+    }();
+    auto it = banks.find(((long long)k << 32) | (unsigned)param);
+    return it == banks.end() ? empty_bank() : it->second;
+}
+
+static bool contains(const std::vector<int>& v, int x){
+    return std::find(v.begin(), v.end(), x) != v.end();
+}
+
+static bool parse_port(const std::string& s, Port& out){
+    if (s == "left")     { out = Port::Left;     return true; }
+    if (s == "right")    { out = Port::Right;    return true; }
+    if (s == "custom")   { out = Port::Custom;   return true; }
+    if (s == "external") { out = Port::External; return true; }
+    return false;
+}
+
+static bool parse_int(const std::string& s, int& out){
+    try { size_t pos = 0; out = std::stoi(s, &pos); return pos == s.size(); }
+    catch (...) { return false; }
+}
+
+// 정수, a..b, *
+static bool parse_range(const std::string& s, int& lo, int& hi){
+    if (s == "*") { lo = INT32_MIN; hi = INT32_MAX; return true; }
+    const auto dd = s.find("..");
+    if (dd == std::string::npos) { if (!parse_int(s, lo)) return false; hi = lo; return true; }
+    return parse_int(s.substr(0, dd), lo) && parse_int(s.substr(dd + 2), hi) && lo <= hi;
+}
+
+// +p / -p 편집을 builtin bank 위에 적용 (추가는 끝에, 제거는 순서 유지)
+static bool apply_edits(std::vector<int>& bank, std::istringstream& ss){
+    std::string tok;
+    bool any = false;
+    while (ss >> tok){
+        if (tok.size() < 2 || (tok[0] != '+' && tok[0] != '-')) return false;
+        int p;
+        if (!parse_int(tok.substr(1), p)) return false;
+        if (tok[0] == '+') { if (!contains(bank, p)) bank.push_back(p); }
+        else bank.erase(std::remove(bank.begin(), bank.end(), p), bank.end());
+        any = true;
+    }
+    return any;
+}
+
+// ===== RuleSet =====
+RuleSet RuleSet::load(const std::string& path){
+    std::ifstream fin(path);
+    if (!fin) throw std::runtime_error("cannot open rule set " + path);
+
+    RuleSet R;
+    R.name_ = std::filesystem::path(path).stem().string();
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(fin, line)){
+        ++lineNo;
+        const auto hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+
+        std::istringstream ss(line);
+        std::string cmd;
+        if (!(ss >> cmd)) continue;
+        auto fail = [&](const char* what){
+            return std::runtime_error(path + ":" + std::to_string(lineNo) + ": " + what);
+        };
+
+        if (cmd == "name"){
+            if (!(ss >> R.name_)) throw fail("missing name");
+        } else if (cmd == "ban" || cmd == "allow"){
+            std::string which, link, node, lp, np;
+            if (!(ss >> which >> link >> node)) throw fail("expected: ban|allow side|interior <link> <node> [ports]");
+            Override o{};
+            o.ban = (cmd == "ban");
+            if      (which == "side")     o.link = Kind::SideLink;
+            else if (which == "interior") o.link = Kind::InteriorLink;
+            else throw fail("expected side|interior");
+            if (!parse_int(link, o.linkParam)) throw fail("bad link param");
+            if (!parse_range(node, o.nodeLo, o.nodeHi)) throw fail("bad node param/range");
+            o.anyPort = true;
+            if (ss >> lp){
+                if (!(ss >> np) || !parse_port(lp, o.linkPort) || !parse_port(np, o.nodePort))
+                    throw fail("bad ports (left|right|custom|external)");
+                o.anyPort = false;
+            }
+            R.glue_.push_back(o);
+        } else if (cmd == "bank"){
+            std::string which; int key;
+            if (!(ss >> which >> key)) throw fail("expected: bank S|I|g|L <param> +p -p ...");
+            std::vector<int>* bank = nullptr;
+            if (which == "S"){
+                bank = &R.sBank_.try_emplace(key, allowed_S_params(key)).first->second;
+            } else if (which == "I"){
+                bank = &R.iBank_.try_emplace(key, allowed_I_params(key)).first->second;
+            } else if (which == "g" || which == "L"){
+                const LKind k = (which == "g") ? LKind::g : LKind::L;
+                bank = &R.chain_.try_emplace(chainKey(k, key), builtin_chain_bank(k, key)).first->second;
+            } else throw fail("expected S|I|g|L");
+            if (!apply_edits(*bank, ss)) throw fail("expected +p/-p edits");
+        } else {
+            throw fail("unknown directive");
+        }
+    }
+    return R;
+}
+
+GlueStatus RuleSet::checkGlue(Kind ka, int paramA, Port pa,
+                              Kind kb, int paramB, Port pb, int weight) const noexcept {
+    const GlueStatus st = TheoryGraph::checkGlue(ka, paramA, pa, kb, paramB, pb, weight);
+    if (glue_.empty() || st == GlueStatus::ForbiddenSI || st == GlueStatus::BadWeight) return st;
+
+    // 링크-노드 쌍만 덮어쓸 수 있다
+    Kind lk; int lpar, npar; Port lp, np;
+    if ((ka == Kind::SideLink || ka == Kind::InteriorLink) && kb == Kind::Node){
+        lk = ka; lpar = paramA; lp = pa; npar = paramB; np = pb;
+    } else if ((kb == Kind::SideLink || kb == Kind::InteriorLink) && ka == Kind::Node){
+        lk = kb; lpar = paramB; lp = pb; npar = paramA; np = pa;
+    } else {
+        return st;
+    }
+
+    for (auto it = glue_.rbegin(); it != glue_.rend(); ++it){
+        const Override& o = *it;
+        if (o.link != lk || o.linkParam != lpar || npar < o.nodeLo || npar > o.nodeHi) continue;
+        if (!o.anyPort && (o.linkPort != lp || o.nodePort != np)) continue;
+        if (!o.ban) return GlueStatus::Ok;
+        if (lk == Kind::SideLink) return o.anyPort ? GlueStatus::BannedSidePair : GlueStatus::BannedSidePort;
+        return o.anyPort ? GlueStatus::BannedInteriorPair : GlueStatus::BannedInteriorPort;
+    }
+    return st;
+}
+
+const std::vector<int>& RuleSet::sBank(int g) const {
+    auto it = sBank_.find(g);
+    return it == sBank_.end() ? allowed_S_params(g) : it->second;
+}
+
+const std::vector<int>& RuleSet::iBank(int g) const {
+    auto it = iBank_.find(g);
+    return it == iBank_.end() ? allowed_I_params(g) : it->second;
+}
+
+const std::vector<int>& RuleSet::chainBank(LKind k, int param) const {
+    auto it = chain_.find(chainKey(k, param));
+    return it == chain_.end() ? builtin_chain_bank(k, param) : it->second;
+}
+
+bool RuleSet::bankAdmits(const Topology& T) const {
+    const int nb = (int)T.block.size();
+
+    if (!chain_.empty()){
+        auto step = [&](int u, int v){
+            if (u < 0 || u >= nb || v < 0 || v >= nb) return true;  // 인덱스 오류는 validate_topology 몫
+            const Block& a = T.block[u];
+            return !editsChain(a.kind, a.param) || contains(chainBank(a.kind, a.param), T.block[v].param);
+        };
+        for (int k = 0; k < T.interiorEdgeCount(); ++k){
+            const auto e = T.interiorEdge(k);
+            if (!step(e.u, e.v)) return false;
+        }
+    }
+
+    auto deco = [&](int u, int param, bool side){
+        if (u < 0 || u >= nb || T.block[u].kind != LKind::g) return true;
+        const int g = T.block[u].param;
+        if (side) return !editsS(g) || contains(sBank(g), param);
+        return !editsI(g) || contains(iBank(g), param);
+    };
+    if (!sBank_.empty()){
+        for (const auto& e : T.s_connection)
+            if (e.v >= 0 && e.v < (int)T.side_links.size() && !deco(e.u, T.side_links[e.v].param, true)) return false;
+    }
+    if (!iBank_.empty()){
+        for (const auto& e : T.i_connection)
+            if (e.v >= 0 && e.v < (int)T.instantons.size() && !deco(e.u, T.instantons[e.v].param, false)) return false;
+    }
+    return true;
+}
+
+// ===== RuleSetList =====
+RuleSetList::RuleSetList(){
+    sets_.emplace_back();
+}
+
+void RuleSetList::add(RuleSet r){
+    if ((int)sets_.size() >= kMaxRuleSets) throw std::runtime_error("too many rule sets (max 64)");
+    for (const auto& s : sets_)
+        if (s.name() == r.name()) throw std::runtime_error("duplicate rule set name: " + r.name());
+
+    // 합집합 갱신: 편집된 g만 별도 보관, 나머지는 builtin과 같다
+    auto merge = [](std::map<int, std::vector<int>>& uni, int g,
+                    const std::vector<int>& builtin, const std::vector<int>& bank){
+        auto& u = uni.try_emplace(g, builtin).first->second;
+        for (int p : bank) if (!contains(u, p)) u.push_back(p);
+    };
+    for (const auto& [g, bank] : r.sBank_) merge(sUnion_, g, allowed_S_params(g), bank);
+    for (const auto& [g, bank] : r.iBank_) merge(iUnion_, g, allowed_I_params(g), bank);
+    sets_.push_back(std::move(r));
+}
+
+const std::vector<int>& RuleSetList::unionSBank(int g) const {
+    auto it = sUnion_.find(g);
+    return it == sUnion_.end() ? allowed_S_params(g) : it->second;
+}
+
+const std::vector<int>& RuleSetList::unionIBank(int g) const {
+    auto it = iUnion_.find(g);
+    return it == iUnion_.end() ? allowed_I_params(g) : it->second;
+}
+
+bool write_rule_report(const std::string& path, const RuleSetList& rules,
+                       const std::vector<RuleTally>& tally){
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    out << "# rule set report (added/removed vs builtin)\n";
+    out << "name\tLST\tSCFT\tadded\tremoved\n";
+    for (size_t r = 0; r < rules.size() && r < tally.size(); ++r){
+        const RuleTally& t = tally[r];
+        out << rules[r].name() << '\t' << t.lst << '\t' << t.scft << '\t'
+            << t.added << '\t' << t.removed << '\n';
+    }
+    return (bool)out;
+}
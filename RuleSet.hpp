@@ -0,0 +1,102 @@
+// RuleSet.hpp
+#pragma once
+#include "Topology.h"
+#include "Theory.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// 글루잉 규칙(Theory.h isBanned*_)과 후보 bank(RuleBanks.hpp)에 대한 변형 하나.
+// builtin은 편집이 없는 룰셋이고, 파일 룰셋은 builtin 위에 덮어쓴다.
+//
+// 파일 포맷 (한 줄에 하나, '#' 뒤는 주석):
+//   name <이름>                                   (없으면 파일 stem)
+//   ban   side|interior <link> <node> [<linkPort> <nodePort>]
+//   allow side|interior <link> <node> [<linkPort> <nodePort>]
+//   bank  S|I <g> +p -p ...                       (장식 bank, g 값별)
+//   bank  g|L <param> +p -p ...                   (체인 bank, allowed())
+// - <node>: 정수, a..b 범위, 또는 * (모든 노드)
+// - 포트: left|right|custom|external. 생략하면 포트 무관
+// - ban/allow는 뒤에 나온 줄이 우선. 맞는 줄이 없으면 builtin 판정
+// - +p는 bank 끝에 추가, -p는 제거 (builtin 순서는 유지)
+
+using RuleMask = std::uint64_t;
+constexpr int kMaxRuleSets = 64;
+
+class RuleSet {
+public:
+    RuleSet() : name_("builtin") {}
+
+    // 파싱 실패 시 std::runtime_error (파일:줄 포함)
+    static RuleSet load(const std::string& path);
+
+    const std::string& name() const noexcept { return name_; }
+
+    // TheoryGraph::checkGlue와 같은 계약 (덮어쓴 쌍만 결과가 달라진다)
+    GlueStatus checkGlue(Kind ka, int paramA, Port pa,
+                         Kind kb, int paramB, Port pb, int weight=1) const noexcept;
+
+    // 후보 bank (편집이 없으면 builtin 그대로)
+    const std::vector<int>& sBank(int g) const;
+    const std::vector<int>& iBank(int g) const;
+    const std::vector<int>& chainBank(LKind k, int param) const;
+
+    // 이 룰셋이 편집한 bank에 한해, 레코드가 쓰는 코드가 bank 안에 있는지.
+    // 편집하지 않은 bank는 검사하지 않는다 (builtin은 항상 true)
+    bool bankAdmits(const Topology& T) const;
+
+    bool editsS(int g) const { return sBank_.count(g) != 0; }
+    bool editsI(int g) const { return iBank_.count(g) != 0; }
+    bool editsChain(LKind k, int param) const { return chain_.count(chainKey(k, param)) != 0; }
+
+private:
+    friend class RuleSetList;
+
+    struct Override {
+        Kind link;              // SideLink | InteriorLink
+        int  linkParam;
+        int  nodeLo, nodeHi;
+        bool anyPort;
+        Port linkPort, nodePort;
+        bool ban;
+    };
+
+    static long long chainKey(LKind k, int param) { return ((long long)k << 32) | (unsigned)param; }
+
+    std::string                          name_;
+    std::vector<Override>                glue_;
+    std::map<int, std::vector<int>>      sBank_, iBank_;
+    std::map<long long, std::vector<int>> chain_;
+};
+
+// builtin(비트 0) + 파일 룰셋들. 구성 후에는 읽기 전용이라 스레드 간 공유 가능
+class RuleSetList {
+public:
+    RuleSetList();
+
+    // 이름 중복 / 64개 초과 시 std::runtime_error
+    void add(RuleSet r);
+
+    size_t size() const noexcept { return sets_.size(); }
+    bool   multi() const noexcept { return sets_.size() > 1; }
+    const RuleSet& operator[](size_t k) const { return sets_[k]; }
+    RuleMask all() const noexcept { return sets_.size() >= 64 ? ~RuleMask(0) : ((RuleMask(1) << sets_.size()) - 1); }
+
+    // 모든 룰셋 bank의 합집합: builtin 순서 뒤에 추가분을 룰셋 순서대로
+    const std::vector<int>& unionSBank(int g) const;
+    const std::vector<int>& unionIBank(int g) const;
+
+private:
+    std::vector<RuleSet>            sets_;
+    std::map<int, std::vector<int>> sUnion_, iUnion_;
+};
+
+// 룰셋별 집계 (added/removed: builtin 대비 이 룰셋에만 있는 / 빠진 레코드 수)
+struct RuleTally {
+    long long lst = 0, scft = 0, added = 0, removed = 0;
+};
+
+// 탭 구분 표: name LST SCFT added removed. 실패 시 false
+bool write_rule_report(const std::string& path, const RuleSetList& rules,
+                       const std::vector<RuleTally>& tally);
@@ -0,0 +1,202 @@
+// RuleStamp.cpp
+#include "RuleStamp.hpp"
+#include "RuleBanks.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+// ===== 내부 유틸 =====
+namespace {
+// 64-bit FNV-1a
+struct Fnv {
+    std::uint64_t h = 1469598103934665603ULL;
+    void bytes(const void* p, size_t n){
+        const unsigned char* c = static_cast<const unsigned char*>(p);
+        for (size_t k = 0; k < n; ++k){ h ^= c[k]; h *= 1099511628211ULL; }
+    }
+    void add(int v){ bytes(&v, sizeof v); }
+    void add(std::uint64_t v){ bytes(&v, sizeof v); }
+    void add(const std::vector<int>& v){ add((int)v.size()); for (int x : v) add(x); }
+};
+
+constexpr int  kNodeMin = 1, kNodeMax = 16;
+constexpr Port kPorts[] = {Port::Left, Port::Right, Port::Custom, Port::External};
+}
+
+// 곡선 IF + 자동 포트 (알 수 없는 파라미터면 표시만)
+static void add_curve(Fnv& f, const Spec& sp){
+    try {
+        const CurveEntry& ce = curve_entry(sp);
+        const auto& M = ce.tensor.GetIntersectionFormRef();
+        f.add((int)M.rows());
+        for (int i = 0; i < M.rows(); ++i)
+            for (int j = 0; j < M.cols(); ++j) f.add(M(i,j));
+        f.add(ce.ports.left); f.add(ce.ports.right);
+    } catch (...) {
+        f.add(-1);
+    }
+}
+
+// 링크 코드 하나와 모든 노드 사이의 규칙 행
+static void add_rule_rows(Fnv& f, const RuleSet& R, Kind link, int param){
+    for (int g = kNodeMin; g <= kNodeMax; ++g)
+        for (Port lp : kPorts)
+            for (Port np : kPorts)
+                f.add((int)R.checkGlue(link, param, lp, Kind::Node, g, np));
+}
+
+// ===== 의존 코드 =====
+std::string dep_name(DepCode c){
+    return std::string(1, (char)(c >> 32)) + std::to_string((int)(std::uint32_t)c);
+}
+
+bool parse_dep(const std::string& s, DepCode& out){
+    if (s.size() < 2 || (s[0] != 'g' && s[0] != 'L' && s[0] != 's' && s[0] != 'I')) return false;
+    try {
+        size_t pos = 0;
+        const int p = std::stoi(s.substr(1), &pos);
+        if (pos != s.size() - 1) return false;
+        out = dep_code(s[0], p);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+void record_deps(const Topology& T, std::vector<DepCode>& out){
+    out.clear();
+    for (const auto& b : T.block){
+        switch (b.kind){
+            case LKind::g: out.push_back(dep_code('g', b.param)); break;
+            case LKind::L: out.push_back(dep_code('L', b.param)); break;
+            case LKind::S:
+            case LKind::I: out.push_back(dep_code('s', b.param)); break;
+        }
+    }
+    for (const auto& s : T.side_links) out.push_back(dep_code('s', s.param));
+    for (const auto& i : T.instantons) out.push_back(dep_code('s', i.param));
+    for (const auto& e : T.i_connection){
+        if (e.u >= 0 && e.u < (int)T.block.size() && T.block[e.u].kind == LKind::g)
+            out.push_back(dep_code('I', T.block[e.u].param));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+bool touches(const std::vector<DepCode>& deps, const DepSet& changed){
+    if (changed.empty()) return false;
+    for (DepCode c : deps) if (changed.count(c)) return true;
+    return false;
+}
+
+// ===== RuleStamp =====
+RuleStamp RuleStamp::compute(const RuleSet& R){
+    // 코드 범위: bank에서 닿을 수 있는 모든 코드
+    std::vector<int> gs(std::begin(G_BANK), std::end(G_BANK));
+    std::vector<int> ls(std::begin(L_BANK), std::end(L_BANK));
+    std::vector<int> ss;
+    for (int g = kNodeMin; g <= kNodeMax; ++g){
+        for (int p : R.chainBank(LKind::g, g)) ls.push_back(p);
+        for (int p : R.sBank(g)) ss.push_back(p);
+        for (int p : R.iBank(g)) ss.push_back(p);
+    }
+    for (int l : ls) for (int p : R.chainBank(LKind::L, l)) gs.push_back(p);
+    for (auto* v : {&gs, &ls, &ss}){
+        std::sort(v->begin(), v->end());
+        v->erase(std::unique(v->begin(), v->end()), v->end());
+    }
+
+    RuleStamp S;
+    for (int p : ss){
+        Fnv f;
+        add_curve(f, Spec{Kind::SideLink, p});
+        add_rule_rows(f, R, Kind::SideLink, p);
+        S.fp_[dep_code('s', p)] = f.h;
+    }
+    for (int p : ls){
+        Fnv f;
+        add_curve(f, Spec{Kind::InteriorLink, p});
+        add_rule_rows(f, R, Kind::InteriorLink, p);
+        f.add(R.chainBank(LKind::L, p));
+        S.fp_[dep_code('L', p)] = f.h;
+    }
+    for (int g : gs){
+        Fnv f;
+        add_curve(f, Spec{Kind::Node, g});
+        f.add(R.chainBank(LKind::g, g));
+        f.add(R.sBank(g));
+        S.fp_[dep_code('g', g)] = f.h;
+
+        // I bank: 순서와 멤버 지문까지 (앞 멤버의 판정이 뒤 멤버의 슬롯을 좌우한다)
+        Fnv fi;
+        fi.add(R.iBank(g));
+        for (int p : R.iBank(g)){
+            auto it = S.fp_.find(dep_code('s', p));
+            fi.add(it == S.fp_.end() ? std::uint64_t(0) : it->second);
+        }
+        S.fp_[dep_code('I', g)] = fi.h;
+    }
+
+    Fnv all;
+    for (const auto& [c, h] : S.fp_){ all.add(c); all.add(h); }
+    S.all_ = all.h;
+    return S;
+}
+
+bool RuleStamp::load(const std::string& path, RuleStamp& out){
+    std::ifstream fin(path);
+    if (!fin) return false;
+    RuleStamp S;
+    bool haveAll = false;
+    std::string line;
+    while (std::getline(fin, line)){
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string key, hex;
+        if (!(ss >> key >> hex)) return false;
+        std::uint64_t h;
+        try { h = std::stoull(hex, nullptr, 16); } catch (...) { return false; }
+        if (key == "all") { S.all_ = h; haveAll = true; continue; }
+        DepCode c;
+        if (!parse_dep(key, c)) return false;
+        S.fp_[c] = h;
+    }
+    if (!haveAll) return false;
+    out = std::move(S);
+    return true;
+}
+
+bool RuleStamp::save(const std::string& path) const {
+    std::ostringstream os;
+    os << "# rule stamp (64-bit FNV-1a per dependency code)\n";
+    os << "all " << std::hex << all_ << "\n";
+    for (const auto& [c, h] : fp_) os << dep_name(c) << ' ' << h << "\n";
+
+    const auto p = std::filesystem::path(path);
+    std::error_code ec;
+    std::filesystem::create_directories(p.parent_path(), ec);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+        const std::string s = os.str();
+        out.write(s.data(), (std::streamsize)s.size());
+        if (!out.good()) return false;
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) { std::filesystem::remove(tmp, ec); return false; }
+    return true;
+}
+
+DepSet RuleStamp::changedSince(const RuleStamp& old) const {
+    DepSet changed;
+    if (old.all_ == all_) return changed;
+    for (const auto& [c, h] : fp_){
+        auto it = old.fp_.find(c);
+        if (it == old.fp_.end() || it->second != h) changed.insert(c);
+    }
+    for (const auto& [c, h] : old.fp_)
+        if (!fp_.count(c)) changed.insert(c);
+    return changed;
+}
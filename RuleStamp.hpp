@@ -0,0 +1,51 @@
+// RuleStamp.hpp
+#pragma once
+#include "Topology.h"
+#include "RuleSet.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_set>
+#include <cstdint>
+
+// 의존 코드: 레코드가 쓰는 블록/장식 코드 하나. (tag << 32) | param
+//   g<p>  노드 g 값         : 곡선 IF, 체인 bank(g -> L), S bank
+//   L<p>  interior link     : 곡선 IF, 체인 bank(L -> g), 노드와의 i-n 규칙 행
+//   s<p>  side link/instanton: 곡선 IF, 노드와의 s-n 규칙 행
+//   I<g>  g 노드의 I bank    : bank 순서 + 각 멤버의 s 지문 (노드당 I 개수 제한 때문)
+using DepCode = std::uint64_t;
+
+inline DepCode dep_code(char tag, int param){
+    return ((DepCode)(unsigned char)tag << 32) | (std::uint32_t)param;
+}
+std::string dep_name(DepCode c);                         // "g4", "s882" ...
+bool        parse_dep(const std::string& s, DepCode& out);
+
+using DepSet = std::unordered_set<DepCode>;
+
+// 레코드가 의존하는 코드들 (정렬, 중복 없음)
+void record_deps(const Topology& T, std::vector<DepCode>& out);
+bool touches(const std::vector<DepCode>& deps, const DepSet& changed);
+
+// 규칙 테이블 지문: 의존 코드별 64-bit FNV-1a + 전체 지문.
+// 출력 루트마다 rules.stamp로 저장하고, 다음 실행은 바뀐 코드만 다시 계산한다.
+class RuleStamp {
+public:
+    static constexpr const char* kFileName = "rules.stamp";
+
+    // 코드 범위: bank에 나오는 모든 코드 + 노드 g 1..16에 대한 규칙 행
+    static RuleStamp compute(const RuleSet& rules);
+
+    static bool load(const std::string& path, RuleStamp& out);
+    bool save(const std::string& path) const;
+
+    std::uint64_t overall() const noexcept { return all_; }
+    size_t        size()    const noexcept { return fp_.size(); }
+
+    // 이전 stamp 대비 지문이 다른 코드 (한쪽에만 있는 코드 포함)
+    DepSet changedSince(const RuleStamp& old) const;
+
+private:
+    std::map<DepCode, std::uint64_t> fp_;
+    std::uint64_t all_ = 0;
+};
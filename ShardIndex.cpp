@@ -0,0 +1,109 @@
+// ShardIndex.cpp
+#include "ShardIndex.hpp"
+#include "TopoCanonical.hpp"
+#include "FileUtil.hpp"
+#include <cstring>
+#include <filesystem>
+
+// ===== 내부 유틸 =====
+namespace {
+constexpr char        kSidxMagic[8] = {'T','O','P','O','S','I','X','1'};
+constexpr std::size_t kSidxHeader   = 32;
+
+struct SidxHeader {
+    char          magic[8];
+    std::uint32_t stride;
+    std::uint32_t reserved;
+    std::uint64_t records;
+    std::uint64_t shardBytes;
+};
+static_assert(sizeof(SidxHeader) == kSidxHeader, "shard index header layout");
+
+inline std::uint64_t file_bytes(const std::string& path){
+    std::error_code ec;
+    const auto n = std::filesystem::file_size(path, ec);
+    return ec ? 0 : (std::uint64_t)n;
+}
+}
+
+// ===== 열기 =====
+bool ShardIndex::open(const std::string& shardPath) {
+    ok_ = false;
+    offs_ = nullptr;
+    nBlocks_ = 0;
+    stride_ = 0;
+    records_ = 0;
+    if (!map_.open(pathFor(shardPath))) return false;
+
+    auto fail = [&]{ map_.close(); return false; };
+    const std::size_t n = map_.size();
+    if (n < kSidxHeader) return fail();
+    SidxHeader h;
+    std::memcpy(&h, map_.data(), sizeof h);
+    if (std::memcmp(h.magic, kSidxMagic, sizeof kSidxMagic) != 0 || h.stride == 0) return fail();
+    if (h.shardBytes != file_bytes(shardPath)) return fail();   // 낡은 인덱스
+
+    const std::uint64_t nb = (h.records + h.stride - 1) / h.stride;
+    if (n != kSidxHeader + nb * sizeof(std::uint64_t)) return fail();
+
+    stride_  = h.stride;
+    records_ = h.records;
+    nBlocks_ = (std::size_t)nb;
+    offs_    = reinterpret_cast<const std::uint64_t*>(map_.data() + kSidxHeader);
+    ok_ = true;
+    return true;
+}
+
+// ===== 조회 =====
+// 첫 레코드가 key 이하인 마지막 블록 (없으면 0번). 블록 첫 레코드를 풀어 이분 탐색
+bool ShardIndex::seek(TopologyCursor& cur, const Topology& key) const {
+    if (!ok_ || nBlocks_ == 0) return false;
+    Topology T;
+    std::size_t lo = 0, hi = nBlocks_;   // [lo, hi): 답의 후보
+    while (hi - lo > 1) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (!cur.seek(offs_[mid]) || !cur.next(T)) return false;
+        if (compare_topology(T, key) <= 0) lo = mid;
+        else                               hi = mid;
+    }
+    return cur.seek(offs_[lo]);
+}
+
+// ===== 샤드 트리 조회 =====
+bool ShardLookup::contains(const std::string& shardPath, const Topology& key) {
+    auto it = shards_.find(shardPath);
+    if (it == shards_.end()) {
+        auto s = std::make_unique<Shard>();
+        std::error_code ec;
+        if (std::filesystem::exists(shardPath, ec)) {
+            s->ok = s->idx.open(shardPath) && s->cur.open(shardPath, TopologyCursor::Format::Line);
+            if (!s->ok) ++unindexed_;
+        }
+        it = shards_.emplace(shardPath, std::move(s)).first;
+    }
+    Shard& s = *it->second;
+    if (!s.ok || !s.idx.seek(s.cur, key)) return false;
+    // 블록 안에서 key 이상이 나올 때까지 (정렬되어 있으니 넘으면 없다)
+    for (std::uint32_t k = 0; k <= s.idx.stride() && s.cur.next(rec_); ++k) {
+        const int c = compare_topology(rec_, key);
+        if (c == 0) return true;
+        if (c > 0) return false;
+    }
+    return false;
+}
+
+// ===== 쓰기 =====
+bool ShardIndex::write(const std::string& shardPath, std::uint32_t stride, std::uint64_t records,
+                       std::uint64_t shardBytes, const std::vector<std::uint64_t>& offsets) {
+    SidxHeader h{};
+    std::memcpy(h.magic, kSidxMagic, sizeof kSidxMagic);
+    h.stride     = stride;
+    h.records    = records;
+    h.shardBytes = shardBytes;
+
+    AtomicOutFile f(pathFor(shardPath));
+    f.stream().write(reinterpret_cast<const char*>(&h), sizeof h);
+    f.stream().write(reinterpret_cast<const char*>(offsets.data()),
+                     (std::streamsize)(offsets.size() * sizeof(std::uint64_t)));
+    return f.commit();
+}
@@ -0,0 +1,71 @@
+// ShardIndex.hpp
+#pragma once
+#include "Topology.h"
+#include "TopologyCursor.hpp"
+#include "MappedFile.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+// 정렬된 line 샤드의 성긴 오프셋 인덱스 (<shard>.sidx). shard_compact가 쓴다.
+// 샤드는 compare_topology 순(장식 정렬 후)이고 중복이 없으며, stride개 레코드마다 블록 하나:
+// 블록 첫 레코드의 바이트 오프셋을 적어 두고, 정규화(B/D) 샤드면 블록마다 base 표를 새로 시작해
+// 그 오프셋부터 읽어도 혼자 풀린다.
+// 레이아웃 (리틀 엔디언):
+//   [헤더 32B] magic "TOPOSIX1" | u32 stride | u32 reserved | u64 records | u64 shardBytes
+//   [표]       u64 offset x ceil(records / stride)
+// shardBytes가 샤드 크기와 다르면 (그 뒤에 덧붙였으면) 낡은 인덱스로 보고 열지 않는다.
+class ShardIndex {
+public:
+    static std::string pathFor(const std::string& shardPath) { return shardPath + ".sidx"; }
+
+    // 인덱스 열기. 없거나 샤드 크기와 안 맞으면 false
+    bool open(const std::string& shardPath);
+    bool ok() const noexcept { return ok_; }
+
+    std::uint32_t stride()  const noexcept { return stride_; }
+    std::uint64_t records() const noexcept { return records_; }
+    std::size_t   blocks()  const noexcept { return nBlocks_; }
+    std::uint64_t offset(std::size_t b) const noexcept { return offs_[b]; }
+
+    // key 이상인 첫 레코드가 들어 있을 블록으로 cur(같은 샤드, Format::Line)를 옮긴다.
+    // 이후 next()는 그 블록부터 읽으므로 호출 쪽은 compare_topology(T, key) < 0인 동안 건너뛴다.
+    // key는 sort_decorations를 거친 것이어야 한다
+    bool seek(TopologyCursor& cur, const Topology& key) const;
+
+    // 샤드를 다 쓴 뒤 호출 (원자적 교체)
+    static bool write(const std::string& shardPath, std::uint32_t stride, std::uint64_t records,
+                      std::uint64_t shardBytes, const std::vector<std::uint64_t>& offsets);
+
+private:
+    MappedFile           map_;
+    bool                 ok_ = false;
+    const std::uint64_t* offs_ = nullptr;
+    std::size_t          nBlocks_ = 0;
+    std::uint32_t        stride_ = 0;
+    std::uint64_t        records_ = 0;
+};
+
+// 정렬된 샤드들에서 레코드 찾기 (topology_generator --known-shards).
+// 샤드마다 인덱스 + 커서를 처음 볼 때 열어 두고, seek한 블록부터 key에 닿을 때까지만 읽는다 (stride개 이하).
+// .sidx가 없거나 낡은 샤드(shard_compact를 안 거쳤거나 그 뒤에 덧붙인 것)는 없는 셈 친다.
+// 커서를 옮기므로 스레드마다 하나
+class ShardLookup {
+public:
+    // key는 sort_decorations를 거친 것
+    bool contains(const std::string& shardPath, const Topology& key);
+    // 인덱스가 없어서 건너뛴 샤드 수
+    std::size_t unindexed() const noexcept { return unindexed_; }
+
+private:
+    struct Shard {
+        ShardIndex     idx;
+        TopologyCursor cur;
+        bool           ok = false;
+    };
+    std::unordered_map<std::string, std::unique_ptr<Shard>> shards_;
+    Topology    rec_;
+    std::size_t unindexed_ = 0;
+};
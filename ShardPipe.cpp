@@ -0,0 +1,116 @@
+// ShardPipe.cpp
+#include "ShardPipe.hpp"
+#include <charconv>
+#include <chrono>
+#include <limits>
+
+namespace {
+constexpr ShardWriter::Id kNone = std::numeric_limits<ShardWriter::Id>::max();
+}
+
+ShardPipe::ShardPipe(ShardWriter& out, std::size_t chunk, std::size_t maxInFlight)
+    : out_(out), chunk_(chunk), maxInFlight_(maxInFlight)
+{
+    writer_ = std::thread([this]{ run(); });
+}
+
+// ===== 등록표 =====
+ShardPipe::Id ShardPipe::register_rel(std::string rel) {
+    std::lock_guard<std::mutex> lock(regMtx_);
+    auto it = byRel_.find(rel);
+    if (it != byRel_.end()) return it->second;
+    const Id id = (Id)rels_.size();
+    rels_.push_back(rel);
+    byRel_.emplace(std::move(rel), id);
+    return id;
+}
+
+ShardPipe::Id ShardPipe::id(std::string_view rel) { return register_rel(std::string(rel)); }
+
+// ===== 쓰기 스레드 =====
+// 큐를 비우고, 비었으면 잠깐 쉰다 (생산자는 알리지 않는다: 잠금 없이 push만)
+void ShardPipe::run() {
+    auto write = [&](Chunk&& c) {
+        if (c.id >= wid_.size()) wid_.resize((std::size_t)c.id + 1, kNone);
+        if (wid_[c.id] == kNone) {
+            std::string rel;
+            {
+                std::lock_guard<std::mutex> lock(regMtx_);
+                rel = rels_[c.id];
+            }
+            wid_[c.id] = out_.id(rel);
+        }
+        out_.append(wid_[c.id], c.data);
+        inFlight_.fetch_sub(c.data.size(), std::memory_order_relaxed);
+    };
+    int idle = 0;
+    for (;;) {
+        const bool last = closing_.load(std::memory_order_acquire);
+        if (q_.drain(write) > 0) { idle = 0; continue; }
+        if (last) break;   // closing_을 본 뒤에 비었다: 남은 push 없음
+        if (++idle < 64) std::this_thread::yield();
+        else             std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool ShardPipe::close() {
+    if (closed_) return ok_;
+    closed_ = true;
+    closing_.store(true, std::memory_order_release);
+    if (writer_.joinable()) writer_.join();
+    ok_ = out_.close();
+    return ok_;
+}
+
+// ===== 워커 쪽 =====
+ShardPipe::Id ShardPipe::Local::shard(std::string_view dir, std::string_view category, int len, std::string_view prefix) {
+    char num[16];
+    const auto r = std::to_chars(num, num + sizeof num, len);
+    const std::string_view lenStr(num, (std::size_t)(r.ptr - num));
+
+    key_.clear();
+    key_ += dir;      key_ += '\x1';
+    key_ += category; key_ += '\x1';
+    key_ += lenStr;   key_ += '\x1';
+    key_ += prefix;
+    auto it = ids_.find(key_);
+    if (it != ids_.end()) return it->second;
+
+    const Id id = pipe_.register_rel(ShardWriter::shard_path(dir, category, len, prefix));
+    ids_.emplace(key_, id);
+    return id;
+}
+
+ShardPipe::Local::Buf& ShardPipe::Local::buf(Id id) {
+    if (id >= bufs_.size()) bufs_.resize((std::size_t)id + 1);
+    return bufs_[id];
+}
+
+void ShardPipe::Local::append_line(Id id, std::string_view line) {
+    Buf& b = buf(id);
+    b.data.append(line.data(), line.size());
+    b.data += '\n';
+    if (b.data.size() >= pipe_.chunk_) handoff(id, b);
+}
+
+void ShardPipe::Local::append_norm(Id id, const Topology& T) {
+    Buf& b = buf(id);
+    if (!b.norm) b.norm = std::make_unique<LineNormEncoder>();
+    b.norm->append(b.data, T);
+    if (b.data.size() >= pipe_.chunk_) handoff(id, b);
+}
+
+// 버퍼를 통째로 큐에. 쓰기 스레드가 maxInFlight 넘게 밀렸으면 따라올 때까지만 기다린다
+void ShardPipe::Local::handoff(Id id, Buf& b) {
+    if (b.data.empty()) return;
+    while (pipe_.inFlight_.load(std::memory_order_relaxed) > pipe_.maxInFlight_)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    pipe_.inFlight_.fetch_add(b.data.size(), std::memory_order_relaxed);
+    pipe_.q_.push(Chunk{id, std::move(b.data)});
+    b.data.clear();
+    if (b.norm) b.norm->reset();   // 다음 chunk는 base 표를 새로
+}
+
+void ShardPipe::Local::flush() {
+    for (Id id = 0; id < (Id)bufs_.size(); ++id) handoff(id, bufs_[id]);
+}
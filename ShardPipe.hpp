@@ -0,0 +1,97 @@
+// ShardPipe.hpp
+#pragma once
+#include "ShardWriter.hpp"
+#include "MpscQueue.hpp"
+#include "TopoLineCompact.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+
+// 워커 -> 쓰기 스레드 샤드 출력 (decorate_generator, topology_generator).
+// 워커마다 Local 하나: 샤드 번호로 찾는 버퍼 배열에 모으고, 버퍼가 chunk를 넘으면 통째로 MPSC 큐에 넘긴다.
+// 쓰기 스레드 하나가 큐를 비우며 ShardWriter에 쓴다 (fd/디렉터리/팩은 ShardWriter 몫).
+//   - 워커 경로에는 잠금도 디스크도 없다. 예외: 처음 보는 샤드의 번호 등록 (Local마다 샤드당 한 번,
+//     I/O를 잡지 않는 등록표 잠금), 쓰기 스레드가 maxInFlight 넘게 밀렸을 때의 대기 (메모리 상한)
+//   - 정규화(B/D) 출력은 Local의 샤드마다 인코더. 넘길 때 reset하므로 chunk마다 base 표가 새로 시작한다
+//     (파일 안에서 같은 id를 다시 정의하면 덮어쓴다 — TopoLineCompact.hpp)
+//
+//   ShardPipe pipe(out);                 // 쓰기 스레드 시작
+//   ShardPipe::Local L(pipe);            // 워커마다
+//   L.append_line(L.shard("", "LST", 5, "gLgL"), line);
+//   L.flush();                           // 배치 끝
+//   if (!pipe.close()) ...               // 모든 Local이 flush한 뒤
+class ShardPipe {
+public:
+    using Id = std::uint32_t;   // 파이프 안 샤드 번호 (ShardWriter::Id와 별개)
+
+    explicit ShardPipe(ShardWriter& out, std::size_t chunk = 64u << 10, std::size_t maxInFlight = 256u << 20);
+    ~ShardPipe() { close(); }
+
+    ShardPipe(const ShardPipe&) = delete;
+    ShardPipe& operator=(const ShardPipe&) = delete;
+
+    // 출력 루트 기준 상대 경로 -> 번호 (고정 파일용; 워커 밖에서 미리 받아 둔다)
+    Id id(std::string_view rel);
+
+    // 큐를 끝까지 비우고 쓰기 스레드를 멈춘 뒤 ShardWriter::close. 두 번 불러도 된다
+    bool close();
+
+    class Local {
+    public:
+        explicit Local(ShardPipe& pipe) : pipe_(pipe) {}
+        ~Local() { flush(); }
+
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+
+        // <dir><category>/len-<len>/<prefix>.txt. 이 Local에서 처음 볼 때만 등록표에 간다
+        Id   shard(std::string_view dir, std::string_view category, int len, std::string_view prefix);
+        void append_line(Id id, std::string_view line);   // line + '\n'
+        void append_norm(Id id, const Topology& T);
+        // 남은 버퍼를 전부 넘긴다
+        void flush();
+
+    private:
+        struct Buf {
+            std::string data;
+            std::unique_ptr<LineNormEncoder> norm;
+        };
+        Buf& buf(Id id);
+        void handoff(Id id, Buf& b);
+
+        ShardPipe& pipe_;
+        std::vector<Buf> bufs_;                     // 파이프 번호로
+        std::unordered_map<std::string, Id> ids_;   // dir \x1 category \x1 len \x1 prefix
+        std::string key_;
+    };
+
+private:
+    struct Chunk {
+        Id          id;
+        std::string data;
+    };
+
+    Id   register_rel(std::string rel);
+    void run();
+
+    ShardWriter&      out_;
+    const std::size_t chunk_, maxInFlight_;
+
+    std::mutex              regMtx_;        // 등록표만 (I/O 중에는 잡지 않는다)
+    std::unordered_map<std::string, Id> byRel_;
+    std::deque<std::string> rels_;
+
+    MpscQueue<Chunk>          q_;
+    std::atomic<std::size_t>  inFlight_{0};  // 큐에 있는 바이트
+    std::atomic<bool>         closing_{false};
+    std::thread               writer_;
+    std::vector<ShardWriter::Id> wid_;       // 쓰기 스레드 전용: 파이프 번호 -> ShardWriter id (없으면 kNone)
+    bool                      closed_ = false, ok_ = true;
+};
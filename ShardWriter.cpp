@@ -0,0 +1,188 @@
+// ShardWriter.cpp
+#include "ShardWriter.hpp"
+#include <charconv>
+#include <filesystem>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+ShardWriter::ShardWriter(std::string root, PackWriter* pack)
+    : ShardWriter(std::move(root), pack, Options{}) {}
+
+ShardWriter::ShardWriter(std::string root, PackWriter* pack, Options opt)
+    : root_(std::move(root)), pack_(pack), opt_(opt)
+{
+    if (opt_.maxOpen == 0) opt_.maxOpen = 1;
+}
+
+// ===== 등록 =====
+ShardWriter::Id ShardWriter::register_locked(std::string rel) {
+    auto it = byPath_.find(rel);
+    if (it != byPath_.end()) return it->second;
+
+    const Id id = (Id)shards_.size();
+    shards_.emplace_back();
+    Shard& s = shards_.back();
+    s.lru = lru_.end();
+    if (pack_) {
+        s.size = pack_->size(rel);
+    } else {
+        std::error_code ec;
+        const auto n = std::filesystem::file_size(root_ + "/" + rel, ec);
+        s.size = ec ? 0 : (std::uint64_t)n;
+    }
+    s.rel = rel;
+    byPath_.emplace(std::move(rel), id);
+    return id;
+}
+
+ShardWriter::Id ShardWriter::id(std::string_view rel) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return register_locked(std::string(rel));
+}
+
+ShardWriter::Id ShardWriter::shard(std::string_view dir, std::string_view category, int len, std::string_view prefix) {
+    char num[16];
+    const auto r = std::to_chars(num, num + sizeof num, len);
+    const std::string_view lenStr(num, (std::size_t)(r.ptr - num));
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    key_.clear();
+    key_ += dir;      key_ += '\x1';
+    key_ += category; key_ += '\x1';
+    key_ += lenStr;   key_ += '\x1';
+    key_ += prefix;
+    auto it = byParts_.find(key_);
+    if (it != byParts_.end()) return it->second;
+
+    const Id id = register_locked(shard_path(dir, category, len, prefix));
+    byParts_.emplace(key_, id);
+    return id;
+}
+
+std::string ShardWriter::path(Id id) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return shards_[id].rel;
+}
+
+std::string ShardWriter::shard_path(std::string_view dir, std::string_view category, int len, std::string_view prefix) {
+    char num[16];
+    const auto r = std::to_chars(num, num + sizeof num, len);
+    std::string rel;
+    rel.reserve(dir.size() + category.size() + prefix.size() + 16);
+    rel += dir; rel += category; rel += "/len-"; rel.append(num, (std::size_t)(r.ptr - num));
+    rel += '/'; rel += prefix; rel += ".txt";
+    return rel;
+}
+
+// ===== 쓰기 =====
+void ShardWriter::append(Id id, std::string_view data) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Shard& s = shards_[id];
+    s.buf.append(data.data(), data.size());
+    buffered_ += data.size();
+    if (buffered_ > opt_.totalBuf)        flush_locked();
+    else if (s.buf.size() >= opt_.shardBuf) write_locked(id);
+}
+
+void ShardWriter::append_line(Id id, std::string_view line) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Shard& s = shards_[id];
+    s.buf.append(line.data(), line.size());
+    s.buf += '\n';
+    buffered_ += line.size() + 1;
+    if (buffered_ > opt_.totalBuf)        flush_locked();
+    else if (s.buf.size() >= opt_.shardBuf) write_locked(id);
+}
+
+std::uint64_t ShardWriter::size(Id id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return shards_[id].size + shards_[id].buf.size();
+}
+
+// fd를 LRU 맨 앞으로. 없으면 (디렉터리를 한 번 만들고) 열고, 넘치면 맨 뒤를 닫는다
+int ShardWriter::open_locked(Id id) {
+    Shard& s = shards_[id];
+    if (s.fd >= 0) {
+        lru_.splice(lru_.begin(), lru_, s.lru);
+        return s.fd;
+    }
+    const std::string full = root_ + "/" + s.rel;
+    const std::string dir = std::filesystem::path(full).parent_path().string();
+    if (!dir.empty() && dirs_.insert(dir).second) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+    }
+    while (open_ >= opt_.maxOpen && !lru_.empty()) close_fd_locked(shards_[lru_.back()]);
+
+    s.fd = ::open(full.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (s.fd < 0) return -1;
+    lru_.push_front(id);
+    s.lru = lru_.begin();
+    ++open_;
+    return s.fd;
+}
+
+void ShardWriter::close_fd_locked(Shard& s) {
+    if (s.fd < 0) return;
+    ::close(s.fd);
+    s.fd = -1;
+    lru_.erase(s.lru);
+    s.lru = lru_.end();
+    --open_;
+}
+
+bool ShardWriter::write_locked(Id id) {
+    Shard& s = shards_[id];
+    if (s.buf.empty()) return true;
+    bool ok = true;
+    if (pack_) {
+        ok = pack_->append(s.rel, s.buf);
+    } else {
+        const int fd = open_locked(id);
+        const char* p = s.buf.data();
+        std::size_t left = s.buf.size();
+        while (ok && left > 0) {
+            const ssize_t w = fd < 0 ? -1 : ::write(fd, p, left);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) { ok = false; break; }
+            p += w;
+            left -= (std::size_t)w;
+        }
+    }
+    if (!ok) failed_ = true;
+    s.size += s.buf.size();
+    buffered_ -= s.buf.size();
+    std::string().swap(s.buf);   // 샤드가 수천 개여도 버퍼 용량이 남지 않게
+    return ok;
+}
+
+bool ShardWriter::flush_locked() {
+    bool ok = true;
+    for (Id id = 0; id < (Id)shards_.size(); ++id)
+        if (!shards_[id].buf.empty()) ok = write_locked(id) && ok;
+    if (pack_ && !pack_->flush()) { failed_ = true; ok = false; }
+    return ok;
+}
+
+bool ShardWriter::flush() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return flush_locked();
+}
+
+bool ShardWriter::close() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    flush_locked();
+    for (auto& s : shards_) close_fd_locked(s);
+    return !failed_;
+}
+
+std::size_t ShardWriter::buffered() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return buffered_;
+}
+
+bool ShardWriter::failed() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return failed_;
+}
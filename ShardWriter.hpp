@@ -0,0 +1,91 @@
+// ShardWriter.hpp
+#pragma once
+#include "PackFile.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+// 샤드 출력 (topology_generator / decorate_generator / classify_topology 공용).
+// 출력 파일(출력 루트 기준 상대 경로 = 팩 키)을 처음 볼 때 한 번 정수 id로 등록하고, 이후에는 id로만 쓴다:
+//   - 디렉터리는 처음 열 때 한 번만 만든다
+//   - 샤드마다 사용자 버퍼, 버퍼가 shardBuf를 넘으면 그 샤드만 write 한 번 (전체가 totalBuf를 넘으면 전부)
+//   - fd는 O_APPEND로 열어 두고 LRU로 maxOpen개까지 (넘으면 가장 오래 안 쓴 것을 닫는다)
+//   - pack이 있으면 파일 대신 팩의 논리 샤드로 (PackWriter::append)
+// 모든 함수는 잠금 하나로 스레드 안전하다.
+//
+//   ShardWriter out(outDir, pack);
+//   const ShardWriter::Id id = out.shard("", "LST", 5, "gLgL");   // LST/len-5/gLgL.txt
+//   out.append_line(id, line);
+//   if (!out.close()) ...
+class ShardWriter {
+public:
+    using Id = std::uint32_t;
+
+    struct Options {
+        std::size_t maxOpen  = 128;         // 열어 두는 fd 수
+        std::size_t shardBuf = 256u << 10;  // 샤드 하나의 버퍼
+        std::size_t totalBuf = 64u << 20;   // 전체 버퍼
+    };
+
+    explicit ShardWriter(std::string root, PackWriter* pack = nullptr);
+    ShardWriter(std::string root, PackWriter* pack, Options opt);
+    ~ShardWriter() { close(); }
+
+    ShardWriter(const ShardWriter&) = delete;
+    ShardWriter& operator=(const ShardWriter&) = delete;
+
+    // 상대 경로 -> id (처음이면 등록)
+    Id id(std::string_view rel);
+    // <dir><category>/len-<len>/<prefix>.txt. 경로 문자열은 id를 처음 만들 때만 조립한다
+    Id shard(std::string_view dir, std::string_view category, int len, std::string_view prefix);
+    std::string path(Id id) const;
+    static std::string shard_path(std::string_view dir, std::string_view category, int len, std::string_view prefix);
+
+    void append(Id id, std::string_view data);
+    void append_line(Id id, std::string_view line);   // line + '\n'
+
+    // 샤드 크기: 등록할 때 있던 파일(또는 팩 키) + 이번에 쓴 것 + 버퍼
+    std::uint64_t size(Id id);
+
+    // 버퍼를 전부 내려쓴다 (팩이면 pack->flush까지)
+    bool flush();
+    // flush + fd 닫기. 실패가 한 번이라도 있었으면 false
+    bool close();
+
+    std::size_t buffered() const;
+    bool        failed() const;
+
+private:
+    struct Shard {
+        std::string   rel;
+        std::string   buf;
+        int           fd = -1;
+        std::uint64_t size = 0;   // 내려간 크기 (등록 때 크기 포함)
+        std::list<Id>::iterator lru;
+    };
+
+    Id   register_locked(std::string rel);
+    bool write_locked(Id id);
+    bool flush_locked();
+    int  open_locked(Id id);
+    void close_fd_locked(Shard& s);
+
+    std::string  root_;
+    PackWriter*  pack_ = nullptr;
+    Options      opt_;
+    mutable std::mutex mtx_;
+    std::deque<Shard> shards_;                      // 참조가 등록 뒤에도 유지된다
+    std::unordered_map<std::string, Id> byPath_;
+    std::unordered_map<std::string, Id> byParts_;   // dir \x1 category \x1 len \x1 prefix
+    std::unordered_set<std::string>    dirs_;      // 이미 만든 디렉터리
+    std::list<Id> lru_;                             // 앞 = 최근
+    std::size_t   open_ = 0, buffered_ = 0;
+    bool          failed_ = false;
+    std::string   key_;                             // shard() 조회 키 (재사용)
+};
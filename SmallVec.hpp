@@ -0,0 +1,122 @@
+// SmallVec.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <initializer_list>
+
+// trivially copyable 원소용 작은 벡터: N개까지는 객체 안(inline)에 두고, 넘치면 힙으로.
+// inline 상태의 복사는 memcpy 한 번이고 할당이 없다. std::vector 대신 쓰는 최소 API만 제공.
+template <class T, std::size_t N>
+class SmallVec {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVec needs a trivially copyable T");
+    static_assert(N > 0, "SmallVec needs inline capacity");
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using iterator        = T*;
+    using const_iterator  = const T*;
+    using reference       = T&;
+    using const_reference = const T&;
+
+    SmallVec() noexcept {}
+    SmallVec(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+    SmallVec(const std::vector<T>& v)     { assign(v.begin(), v.end()); }
+    SmallVec(const SmallVec& o)           { copy_from(o); }
+    SmallVec(SmallVec&& o) noexcept       { move_from(o); }
+    ~SmallVec() { std::free(heap_); }
+
+    SmallVec& operator=(const SmallVec& o){
+        if (this != &o) copy_from(o);
+        return *this;
+    }
+    SmallVec& operator=(SmallVec&& o) noexcept {
+        if (this != &o) { std::free(heap_); heap_ = nullptr; cap_ = N; move_from(o); }
+        return *this;
+    }
+    SmallVec& operator=(const std::vector<T>& v){ assign(v.begin(), v.end()); return *this; }
+
+    template <class It>
+    void assign(It first, It last){
+        clear();
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+    // ---- 접근 ----
+    T*       data()       noexcept { return heap_ ? heap_ : inline_; }
+    const T* data() const noexcept { return heap_ ? heap_ : inline_; }
+
+    size_type size()     const noexcept { return size_; }
+    size_type capacity() const noexcept { return cap_; }
+    bool      empty()    const noexcept { return size_ == 0; }
+    bool      inlined()  const noexcept { return heap_ == nullptr; }
+
+    T&       operator[](size_type i)       noexcept { return data()[i]; }
+    const T& operator[](size_type i) const noexcept { return data()[i]; }
+    T&       front()       noexcept { return data()[0]; }
+    const T& front() const noexcept { return data()[0]; }
+    T&       back()        noexcept { return data()[size_ - 1]; }
+    const T& back()  const noexcept { return data()[size_ - 1]; }
+
+    iterator       begin()       noexcept { return data(); }
+    iterator       end()         noexcept { return data() + size_; }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end()   const noexcept { return data() + size_; }
+
+    // ---- 수정 ----
+    void push_back(const T& v){
+        if (size_ == cap_) grow(cap_ * 2);
+        data()[size_++] = v;
+    }
+    template <class... A>
+    T& emplace_back(A&&... a){
+        push_back(T{std::forward<A>(a)...});
+        return back();
+    }
+    void pop_back() noexcept { --size_; }
+    void clear()    noexcept { size_ = 0; }
+    void reserve(size_type n){ if (n > cap_) grow(n); }
+    void resize(size_type n){
+        reserve(n);
+        for (size_type i = size_; i < n; ++i) data()[i] = T{};
+        size_ = (std::uint32_t)n;
+    }
+
+private:
+    void grow(size_type n){
+        T* p = static_cast<T*>(std::malloc(n * sizeof(T)));
+        if (!p) throw std::bad_alloc();
+        std::memcpy(p, data(), size_ * sizeof(T));
+        std::free(heap_);
+        heap_ = p;
+        cap_  = (std::uint32_t)n;
+    }
+    void copy_from(const SmallVec& o){
+        if (o.size_ > cap_) { size_ = 0; grow(o.size_); }
+        std::memcpy(data(), o.data(), o.size_ * sizeof(T));
+        size_ = o.size_;
+    }
+    void move_from(SmallVec& o) noexcept {
+        if (o.heap_) {
+            heap_ = o.heap_; cap_ = o.cap_; size_ = o.size_;
+            o.heap_ = nullptr; o.cap_ = N;
+        } else {
+            std::memcpy(inline_, o.inline_, o.size_ * sizeof(T));
+            size_ = o.size_;
+        }
+        o.size_ = 0;
+    }
+
+    T*            heap_ = nullptr;
+    std::uint32_t size_ = 0;
+    std::uint32_t cap_  = N;
+    T             inline_[N];
+};
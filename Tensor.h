@@ -17,6 +17,7 @@ class Tensor {
 
     		/* -------- queries -------- */
 		Eigen::MatrixXi GetIntersectionForm() const;
+		const Eigen::MatrixXi& GetIntersectionFormRef() const;	// no copy
     		//string getAnomaly()          const { return anomaly; }
    		double GetDeterminant() const;
 	   	int GetExactDet() const;	
@@ -2,6 +2,7 @@
 #pragma once
 #include "Tensor.h"
 #include <vector>
+#include <string>
 #include <utility>
 #include <stdexcept>
 #include <iostream>
@@ -9,8 +10,10 @@
 #include <map>
 #include <sstream>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
 
-// ---- 종류 & 스펙 헬퍼, side, interior, node, external... custom port 필요함.
+// ---- 종류 & 스펙 헬퍼, side, interior, node, external. 포트는 PortDesc 참고.
 
 enum class Kind { SideLink, InteriorLink, Node, External };
 struct Spec { Kind kind; int param; };
@@ -308,130 +311,250 @@ private:
 // ===================== 그래프 TheoryGraph (포트/가중치 확장) =====================
 
 // 포트 라벨
-enum class Port : int { Left=0, Right=1, Custom=2 };
+enum class Port : int { Left=0, Right=1, Custom=2, External=3 };
 
-// 가중치 간선
+// 포트 + slot (Custom/External은 여러 개 가질 수 있음, slot 0 = 기본 포트)
+struct PortRef {
+    Port port;
+    int  slot;
+    PortRef(Port p, int s = 0) : port(p), slot(s) {}
+};
+
+// 이름 붙은 추가 포트
+struct NamedPort { std::string name; int curve; };
+
+// ---- 포트 디스크립터: 노드 종류마다 미리 계산된 곡선 인덱스 ----
+// Left/Right/기본 Custom/기본 External은 정수 필드로, 추가 포트는 slot 1.. 로 보관.
+struct PortDesc {
+    int size     = 0;
+    int left     = -1;
+    int right    = -1;
+    int custom   = -1;   // Custom slot 0
+    int external = -1;   // External slot 0
+    std::vector<NamedPort> customs;    // Custom slot 1..
+    std::vector<NamedPort> externals;  // External slot 1..
+
+    // O(1) 곡선 인덱스 조회. 없으면 -1
+    int resolve(Port p, int slot = 0) const noexcept {
+        switch (p){
+            case Port::Left:   return slot == 0 ? left  : -1;
+            case Port::Right:  return slot == 0 ? right : -1;
+            case Port::Custom:
+                if (slot == 0) return custom;
+                return (slot > 0 && slot <= (int)customs.size()) ? customs[slot-1].curve : -1;
+            case Port::External:
+                if (slot == 0) return external;
+                return (slot > 0 && slot <= (int)externals.size()) ? externals[slot-1].curve : -1;
+        }
+        return -1;
+    }
+    int resolve(const PortRef& r) const noexcept { return resolve(r.port, r.slot); }
+
+    // 이름으로 slot 찾기 (slot 0 이름: "custom" / "ext"). 없으면 -1
+    int slotOf(Port p, const std::string& name) const noexcept {
+        const std::vector<NamedPort>* v = nullptr;
+        if (p == Port::Custom)   { if (name == "custom" && custom   >= 0) return 0; v = &customs; }
+        if (p == Port::External) { if (name == "ext"    && external >= 0) return 0; v = &externals; }
+        if (!v) return -1;
+        for (size_t k = 0; k < v->size(); ++k)
+            if ((*v)[k].name == name) return (int)k + 1;
+        return -1;
+    }
+
+    // 포트 추가 -> slot 반환 (Custom/External 전용)
+    int add(Port p, std::string name, int curve){
+        if (curve < 0 || curve >= size) throw std::invalid_argument("port curve index out of range");
+        if (p == Port::Custom)   { customs.push_back(NamedPort{std::move(name), curve});   return (int)customs.size(); }
+        if (p == Port::External) { externals.push_back(NamedPort{std::move(name), curve}); return (int)externals.size(); }
+        throw std::invalid_argument("only Custom/External ports can be added");
+    }
+};
+
+// 기본 포트 정책: Left=첫 곡선, Right=마지막 곡선, Custom=곡선 1 (없으면 0), External 노드는 곡선 0
+inline PortDesc default_ports(Kind k, int size){
+    PortDesc d;
+    d.size = size;
+    if (size <= 0) return d;
+    d.left   = 0;
+    d.right  = size - 1;
+    d.custom = (size >= 2 ? 1 : 0);
+    if (k == Kind::External) d.external = 0;
+    return d;
+}
+
+// ---- 곡선 라이브러리: (kind,param)마다 텐서와 포트를 한 번만 만든다 ----
+struct CurveEntry {
+    Tensor   tensor;
+    PortDesc ports;
+};
+
+// 프로세스 전체 표 (항목은 지우지 않는다: 반환한 참조/포인터는 끝까지 유효, 스레드를 넘어가도 된다).
+// 앞에 스레드별 포인터 캐시를 두어 두 번째부터는 락 없이 찾는다
+inline const CurveEntry& curve_entry(const Spec& sp){
+    const long long key = ((long long)sp.kind << 32) | (unsigned int)sp.param;
+    thread_local std::unordered_map<long long, const CurveEntry*> local;
+    auto it = local.find(key);
+    if (it != local.end()) return *it->second;
+
+    static std::mutex mtx;
+    static auto* table = new std::unordered_map<long long, std::unique_ptr<CurveEntry>>();   // 종료 때도 두는 것
+    const CurveEntry* e = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto& slot = (*table)[key];
+        if (!slot) {
+            slot = std::make_unique<CurveEntry>();
+            slot->tensor = build_tensor(sp);
+            slot->ports  = default_ports(sp.kind, slot->tensor.GetT());
+        }
+        e = slot.get();
+    }
+    local.emplace(key, e);
+    return *e;
+}
+
+// 가중치 간선 (곡선 인덱스는 connect 시점에 포트 디스크립터로 확정)
 struct EdgeW {
     int  u, v;     // 노드 id
     Port pu, pv;   // u의 포트, v의 포트
     int  w;        // 글루잉 강도(대칭 오프대각에 +w)
+    int  iu = -1;  // u 안의 곡선 인덱스
+    int  iv = -1;  // v 안의 곡선 인덱스
 };
 
-// 기본 포트 선택 정책 (필요하면 강화 가능)
-inline int pickPortIndex(Kind /*k*/, const Tensor& t, Port which){
-    const auto IF = t.GetIntersectionForm();
-    const int sz = static_cast<int>(IF.rows());
-    if (sz <= 0) return -1;
-    switch(which){
-        case Port::Left:   return 0;
-        case Port::Right:  return sz - 1;
-        case Port::Custom: return (sz >= 2 ? 1 : 0);
-    }
-    return -1;
+// 기본 포트 선택 정책 (호환용: 행렬 복사 없이 크기만 사용)
+inline int pickPortIndex(Kind k, const Tensor& t, Port which){
+    return default_ports(k, t.GetT()).resolve(which);
 }
 
 struct NodeRef { int id; };
 
+// ---- 글루잉 규칙 판정 결과 (예외 없는 검증 경로용) ----
+enum class GlueStatus : unsigned char {
+    Ok = 0,
+    ForbiddenSI,         // s-i 인접 금지
+    BadWeight,           // weight <= 0
+    BannedSidePair,      // isBannedPair_       (s-n, 포트 무관)
+    BannedSidePort,      // isBannedPortPair_   (s-n, 포트 특정)
+    BannedInteriorPair,  // isBannedPairIN_     (i-n, 포트 무관)
+    BannedInteriorPort,  // isBannedPortPairIN_ (i-n, 포트 특정)
+    UnknownPort,         // 노드에 없는 포트/slot
+    BadIndex             // 존재하지 않는 노드/장식 id
+};
+constexpr int kGlueStatusCount = 9;
+
+// 규칙 이름 (리포트/카운터 키용)
+inline const char* to_cstr(GlueStatus st){
+    switch (st){
+        case GlueStatus::Ok:                 return "ok";
+        case GlueStatus::ForbiddenSI:        return "forbidden_s_i";
+        case GlueStatus::BadWeight:          return "bad_weight";
+        case GlueStatus::BannedSidePair:     return "banned_side_pair";
+        case GlueStatus::BannedSidePort:     return "banned_side_port";
+        case GlueStatus::BannedInteriorPair: return "banned_interior_pair";
+        case GlueStatus::BannedInteriorPort: return "banned_interior_port";
+        case GlueStatus::UnknownPort:        return "unknown_port";
+        case GlueStatus::BadIndex:           return "bad_index";
+    }
+    return "?";
+}
+
+// 예외 메시지 (기존 connect가 던지던 문구 유지)
+inline const char* glue_message(GlueStatus st){
+    switch (st){
+        case GlueStatus::Ok:                 return "ok";
+        case GlueStatus::ForbiddenSI:        return "Forbidden adjacency s-i";
+        case GlueStatus::BadWeight:          return "weight must be positive";
+        case GlueStatus::BannedSidePair:
+        case GlueStatus::BannedSidePort:     return "Porting rule (hardcoded) violated";
+        case GlueStatus::BannedInteriorPair: return "Forbidden adjacency by i–n rule";
+        case GlueStatus::BannedInteriorPort: return "Forbidden adjacency by i–n port rule";
+        case GlueStatus::UnknownPort:        return "Unknown port";
+        case GlueStatus::BadIndex:           return "Node index out of range";
+    }
+    return "?";
+}
+
 class TheoryGraph {
 public:
     NodeRef add(Spec sp){
         int id = (int)nodes_.size();
-        nodes_.push_back(build_tensor(sp));
+        const CurveEntry& ce = curve_entry(sp);
+        nodes_.push_back(&ce.tensor);   // 공유 표를 가리킨다 (노드마다 텐서를 복사하지 않는다)
+        ports_.push_back(ce.ports);
         kinds_.push_back(sp.kind);
         params_.push_back(sp.param); // param 저장
         return NodeRef{id};
     }
 
-    // 자동 포트(우↔좌), weight=1
-    void connect(NodeRef a, NodeRef b){
-        if (forbidden_(kinds_[a.id], kinds_[b.id]))
-            throw std::invalid_argument("Forbidden adjacency s-i");
-
+    // ---- 포트 ----
+    const PortDesc& ports(NodeRef a) const { return ports_.at(a.id); }
 
- 	// 기본 포트
-        Port pa = Port::Right, pb = Port::Left;
+    // 노드에 이름 붙은 Custom/External 포트 추가 -> slot 반환
+    int addPort(NodeRef a, Port kind, std::string name, int curve){
+        return ports_.at(a.id).add(kind, std::move(name), curve);
+    }
+    int portSlot(NodeRef a, Port kind, const std::string& name) const {
+        return ports_.at(a.id).slotOf(kind, name);
+    }
 
-        // a/b 중 사이드와 노드 식별
-        int sideIdx=-1, nodeIdx=-1; Port sideP=pa, nodeP=pb;
-        if (kinds_[a.id]==Kind::SideLink && kinds_[b.id]==Kind::Node) {
-            sideIdx=a.id; nodeIdx=b.id; sideP=pa; nodeP=pb;
-        } else if (kinds_[b.id]==Kind::SideLink && kinds_[a.id]==Kind::Node) {
-            sideIdx=b.id; nodeIdx=a.id; sideP=pb; nodeP=pa;
+    // ---- 규칙 검사 (noexcept, 텐서 불필요) ----
+    // 종류/파라미터/포트만으로 a-b 글루잉이 규칙을 만족하는지 판정
+    static GlueStatus checkGlue(Kind ka, int paramA, Port pa,
+                                Kind kb, int paramB, Port pb, int weight=1) noexcept {
+        if (forbidden_(ka, kb)) return GlueStatus::ForbiddenSI;
+        if (weight <= 0)        return GlueStatus::BadWeight;
+
+        // a/b 중 사이드와 노드 식별 + 포트 정확히 맵핑
+        if (ka==Kind::SideLink && kb==Kind::Node) {
+            if (isBannedPair_(paramA, paramB))         return GlueStatus::BannedSidePair;
+            if (isBannedPortPair_(paramA, paramB, pa, pb)) return GlueStatus::BannedSidePort;
+        } else if (kb==Kind::SideLink && ka==Kind::Node) {
+            if (isBannedPair_(paramB, paramA))         return GlueStatus::BannedSidePair;
+            if (isBannedPortPair_(paramB, paramA, pb, pa)) return GlueStatus::BannedSidePort;
         }
 
-        if (sideIdx!=-1) {
-            int sideParam = params_[sideIdx];
-            int nodeParam = params_[nodeIdx];
-            if (isBannedPair_(sideParam,nodeParam) ||
-                isBannedPortPair_(sideParam,nodeParam, sideP, nodeP))
-                throw std::invalid_argument("Porting rule (hardcoded) violated");
+        if (ka==Kind::InteriorLink && kb==Kind::Node) {
+            if (isBannedPairIN_(paramA, paramB))           return GlueStatus::BannedInteriorPair;
+            if (isBannedPortPairIN_(paramA, paramB, pa, pb)) return GlueStatus::BannedInteriorPort;
+        } else if (kb==Kind::InteriorLink && ka==Kind::Node) {
+            if (isBannedPairIN_(paramB, paramA))           return GlueStatus::BannedInteriorPair;
+            if (isBannedPortPairIN_(paramB, paramA, pb, pa)) return GlueStatus::BannedInteriorPort;
         }
+        return GlueStatus::Ok;
+    }
 
-	int inIdx=-1, nIdx=-1; Port iP=pa, nP=pb;
-	if (kinds_[a.id]==Kind::InteriorLink && kinds_[b.id]==Kind::Node) {
-		inIdx=a.id; nIdx=b.id; iP=pa; nP=pb;
-	} else if (kinds_[b.id]==Kind::InteriorLink && kinds_[a.id]==Kind::Node) {
-		inIdx=b.id; nIdx=a.id; iP=pb; nP=pa;
-	}
-	if (inIdx!=-1) {
-		int iParam = params_[inIdx];
-		int nParam = params_[nIdx];
+    // 이미 추가된 노드 사이 연결 가능 여부 (포트 존재까지 확인)
+    GlueStatus check(NodeRef a, PortRef ra, NodeRef b, PortRef rb, int weight=1) const noexcept {
+        const int N = (int)nodes_.size();
+        if (a.id<0 || a.id>=N || b.id<0 || b.id>=N) return GlueStatus::BadIndex;
+        GlueStatus st = checkGlue(kinds_[a.id], params_[a.id], ra.port,
+                                  kinds_[b.id], params_[b.id], rb.port, weight);
+        if (st != GlueStatus::Ok) return st;
+        if ((ports_[a.id].resolve(ra)<0 && ports_[a.id].size>0) ||
+            (ports_[b.id].resolve(rb)<0 && ports_[b.id].size>0)) return GlueStatus::UnknownPort;
+        return GlueStatus::Ok;
+    }
 
-        // 포트 무시 금지 테이블 (있다면)
-        if (isBannedPairIN_(iParam, nParam)) {
-            throw std::invalid_argument("Forbidden adjacency by i–n rule");
-        }
-        // 포트 특정 금지 테이블
-        if (isBannedPortPairIN_(iParam, nParam, iP, nP)) {
-            throw std::invalid_argument("Forbidden adjacency by i–n port rule");
-        }
+    // 예외 없는 연결: 규칙 위반이면 간선을 추가하지 않고 상태 코드 반환
+    GlueStatus tryConnect(NodeRef a, NodeRef b) noexcept {
+        return tryConnect(a, Port::Right, b, Port::Left, 1);
     }
-        edgesW_.push_back( EdgeW{a.id,b.id,Port::Right,Port::Left,1} );
+    GlueStatus tryConnect(NodeRef a, PortRef ra, NodeRef b, PortRef rb, int weight=1) noexcept {
+        const GlueStatus st = check(a, ra, b, rb, weight);
+        if (st == GlueStatus::Ok) pushEdge_(a.id, ra, b.id, rb, weight);
+        return st;
     }
 
-    // 포트/가중치 명시 연결
-    void connect(NodeRef a, Port pa, NodeRef b, Port pb, int weight=1){
-        if (forbidden_(kinds_[a.id], kinds_[b.id]))
-            throw std::invalid_argument("Forbidden adjacency s-i");
-        if (weight <= 0) throw std::invalid_argument("weight must be positive");
-
-
-
- 	// a/b 중 사이드와 노드 식별 + 포트 정확히 맵핑
-        int sideIdx=-1, nodeIdx=-1; Port sideP=pa, nodeP=pb;
-        if (kinds_[a.id]==Kind::SideLink && kinds_[b.id]==Kind::Node) {
-            sideIdx=a.id; nodeIdx=b.id; sideP=pa; nodeP=pb;
-        } else if (kinds_[b.id]==Kind::SideLink && kinds_[a.id]==Kind::Node) {
-            sideIdx=b.id; nodeIdx=a.id; sideP=pb; nodeP=pa;
-        }
+    // 자동 포트(우↔좌), weight=1  — 위반 시 std::invalid_argument (대화형 사용)
+    void connect(NodeRef a, NodeRef b){
+        connect(a, Port::Right, b, Port::Left, 1);
+    }
 
-        if (sideIdx!=-1) {
-            int sideParam = params_[sideIdx];
-            int nodeParam = params_[nodeIdx];
-            if (isBannedPair_(sideParam,nodeParam) ||
-                isBannedPortPair_(sideParam,nodeParam, sideP, nodeP))
-                throw std::invalid_argument("Porting rule (hardcoded) violated");
-        }
-	int inIdx=-1, nIdx=-1; Port iP=pa, nP=pb;
-	if (kinds_[a.id]==Kind::InteriorLink && kinds_[b.id]==Kind::Node) {
-		inIdx=a.id; nIdx=b.id; iP=pa; nP=pb;
-	} else if (kinds_[b.id]==Kind::InteriorLink && kinds_[a.id]==Kind::Node) {
-		inIdx=b.id; nIdx=a.id; iP=pb; nP=pa;
-	}
-	if (inIdx!=-1) {
-		int iParam = params_[inIdx];
-		int nParam = params_[nIdx];
-
-		// 포트 무시 금지 테이블 (있다면)
-		if (isBannedPairIN_(iParam, nParam)) {
-			throw std::invalid_argument("Forbidden adjacency by i–n rule");
-		}
-		// 포트 특정 금지 테이블
-		if (isBannedPortPairIN_(iParam, nParam, iP, nP)) {
-			throw std::invalid_argument("Forbidden adjacency by i–n port rule");
-		}
-	}
-	edgesW_.push_back( EdgeW{a.id,b.id,pa,pb,weight} );
+    // 포트/가중치 명시 연결 (Custom/External은 slot까지 지정 가능)
+    void connect(NodeRef a, PortRef ra, NodeRef b, PortRef rb, int weight=1){
+        const GlueStatus st = tryConnect(a, ra, b, rb, weight);
+        if (st != GlueStatus::Ok) throw std::invalid_argument(glue_message(st));
     }
 
 
@@ -443,7 +566,7 @@ public:
         }
     }
 
-    auto IF(int node) const { return nodes_.at(node).GetIntersectionForm(); }
+    auto IF(int node) const { return nodes_.at(node)->GetIntersectionForm(); }
     void PrintIF(int node, std::ostream& os = std::cout) const {
         os << "IF[node " << node << "]:\n";
         PrintMatrixSafe(IF(node), os);
@@ -454,23 +577,23 @@ public:
         const int N = (int)nodes_.size();
         if (N==0) return Eigen::MatrixXi();
 
-        // 1) 블록 대각합
-        std::vector<Eigen::MatrixXi> blocks; blocks.reserve(N);
-        std::vector<int> sz; sz.reserve(N);
-        for (auto& t : nodes_) { auto M=t.GetIntersectionForm(); blocks.push_back(M); sz.push_back(M.rows()); }
-        Eigen::MatrixXi G = BlockDiag_(blocks);
-
-        // 2) prefix offsets
+        // 1) prefix offsets (포트 디스크립터의 size 사용)
         std::vector<int> off(N+1,0);
-        for (int i=0;i<N;++i) off[i+1]=off[i]+sz[i];
+        for (int i=0;i<N;++i) off[i+1]=off[i]+ports_[i].size;
+        if (off[N]==0) return Eigen::MatrixXi();
+
+        // 2) 블록 대각합 (노드 행렬은 참조로만 읽음)
+        Eigen::MatrixXi G = Eigen::MatrixXi::Zero(off[N], off[N]);
+        for (int i=0;i<N;++i){
+            const int sz = ports_[i].size;
+            if (sz>0) G.block(off[i], off[i], sz, sz) = nodes_[i]->GetIntersectionFormRef();
+        }
 
-        // 3) 간선마다 포트/가중치 반영
+        // 3) 간선마다 connect 때 확정한 곡선 인덱스에 가중치 반영
         for (const auto& e : edgesW_){
-            int iu = pickPortIndex(kinds_[e.u], nodes_[e.u], e.pu);
-            int iv = pickPortIndex(kinds_[e.v], nodes_[e.v], e.pv);
-            if (iu<0 || iv<0 || iu>=sz[e.u] || iv>=sz[e.v]) continue; // 방어
-            int I = off[e.u] + iu;
-            int J = off[e.v] + iv;
+            if (e.iu<0 || e.iv<0) continue; // 방어
+            const int I = off[e.u] + e.iu;
+            const int J = off[e.v] + e.iv;
             G(I,J) += e.w;
             G(J,I) += e.w;
         }
@@ -730,10 +853,18 @@ public:
     }
 
 private:
-    std::vector<Tensor> nodes_;
-    std::vector<Kind>   kinds_;
-    std::vector<int>    params_;   // 각 노드의 Spec.param 저장
-    std::vector<EdgeW>  edgesW_;
+    std::vector<const Tensor*> nodes_;   // curve_entry 표 (읽기 전용)
+    std::vector<PortDesc> ports_;    // 노드별 포트 디스크립터 (곡선 라이브러리에서 복사)
+    std::vector<Kind>     kinds_;
+    std::vector<int>      params_;   // 각 노드의 Spec.param 저장
+    std::vector<EdgeW>    edgesW_;
+
+    // check() 통과 후에만 호출. 곡선이 없는 노드(빈 텐서)는 iu/iv=-1로 남아 합성 때 건너뜀
+    void pushEdge_(int u, const PortRef& ru, int v, const PortRef& rv, int w){
+        const int iu = ports_[u].resolve(ru);
+        const int iv = ports_[v].resolve(rv);
+        edgesW_.push_back( EdgeW{u,v,ru.port,rv.port,w,iu,iv} );
+    }
 
     static bool forbidden_(Kind a, Kind b){
         return ( (a==Kind::SideLink && b==Kind::InteriorLink) ||
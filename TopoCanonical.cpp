@@ -0,0 +1,125 @@
+// TopoCanonical.cpp
+#include "TopoCanonical.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// ===== 반사 =====
+int mirror_link(int param) noexcept {
+    auto digit = [](int d){ return d >= 1 && d <= 9; };
+    if (param >= 10 && param <= 99) {
+        const int a = param / 10, b = param % 10;
+        return digit(a) && digit(b) ? b * 10 + a : -1;
+    }
+    if (param >= 100 && param <= 999) {
+        const int a = param / 100, b = (param / 10) % 10, f = param % 10;
+        return digit(a) && digit(b) ? b * 100 + a * 10 + f : -1;
+    }
+    return -1;
+}
+
+bool reflect_topology(const Topology& T, Topology& out) {
+    if (!T.isChain()) return false;
+    const int nb = (int)T.block.size();
+
+    out.Initialize();
+    out.name = T.name;
+    out.block.reserve(nb);
+    for (int k = nb - 1; k >= 0; --k) {
+        const Block& b = T.block[k];
+        if (b.kind == LKind::g) { out.block.push_back(b); continue; }
+        if (b.kind != LKind::L) return false;
+        const int m = mirror_link(b.param);
+        if (m < 0) return false;
+        out.block.push_back(Block{LKind::L, m});
+    }
+
+    // 장식은 노드(곡선 하나)에만: 반사해도 붙는 곡선이 같다
+    auto onNode = [&](int u){ return u >= 0 && u < nb && T.block[u].kind == LKind::g; };
+    out.side_links = T.side_links;
+    out.instantons = T.instantons;
+    for (const auto& e : T.s_connection) {
+        if (!onNode(e.u)) return false;
+        out.s_connection.push_back({nb - 1 - e.u, e.v});
+    }
+    for (const auto& e : T.i_connection) {
+        if (!onNode(e.u)) return false;
+        out.i_connection.push_back({nb - 1 - e.u, e.v});
+    }
+    sort_decorations(out);
+    return true;
+}
+
+// ===== 장식 정렬 =====
+// (노드, param) 순으로 params/conns를 다시 쓴다. id는 0..k-1
+template <class Params, class Conns>
+static bool sort_deco_(Params& params, Conns& conns) {
+    const int k = (int)params.size();
+    if ((int)conns.size() != k) return false;
+    if (k <= 1) return k == 0 || conns[0].v == 0;
+
+    std::vector<std::pair<int,int>> tmp;   // (node, param)
+    std::vector<char> used(k, 0);
+    tmp.reserve(k);
+    for (const auto& e : conns) {
+        if (e.v < 0 || e.v >= k || used[e.v]) return false;
+        used[e.v] = 1;
+        tmp.push_back({e.u, params[e.v].param});
+    }
+    std::sort(tmp.begin(), tmp.end());
+    for (int j = 0; j < k; ++j) {
+        params[j].param = tmp[j].second;
+        conns[j] = {tmp[j].first, j};
+    }
+    return true;
+}
+
+bool sort_decorations(Topology& T) {
+    const bool s = sort_deco_(T.side_links, T.s_connection);
+    const bool i = sort_deco_(T.instantons, T.i_connection);
+    return s && i;
+}
+
+// ===== 비교 =====
+template <class Params, class Conns>
+static int compare_deco_(const Params& pa, const Conns& ca, const Params& pb, const Conns& cb) noexcept {
+    const size_t n = std::min(ca.size(), cb.size());
+    for (size_t k = 0; k < n; ++k) {
+        if (ca[k].u != cb[k].u) return ca[k].u < cb[k].u ? -1 : 1;
+        const int a = (ca[k].v >= 0 && ca[k].v < (int)pa.size()) ? pa[ca[k].v].param : 0;
+        const int b = (cb[k].v >= 0 && cb[k].v < (int)pb.size()) ? pb[cb[k].v].param : 0;
+        if (a != b) return a < b ? -1 : 1;
+    }
+    if (ca.size() != cb.size()) return ca.size() < cb.size() ? -1 : 1;
+    return 0;
+}
+
+int compare_topology(const Topology& a, const Topology& b) noexcept {
+    const size_t n = std::min(a.block.size(), b.block.size());
+    for (size_t k = 0; k < n; ++k) {
+        const Block& x = a.block[k];
+        const Block& y = b.block[k];
+        if (x.kind != y.kind)   return x.kind < y.kind ? -1 : 1;
+        if (x.param != y.param) return x.param < y.param ? -1 : 1;
+    }
+    if (a.block.size() != b.block.size()) return a.block.size() < b.block.size() ? -1 : 1;
+
+    if (int c = compare_deco_(a.side_links, a.s_connection, b.side_links, b.s_connection)) return c;
+    return compare_deco_(a.instantons, a.i_connection, b.instantons, b.i_connection);
+}
+
+// ===== 정규형 =====
+bool canonicalize(Topology& T) {
+    sort_decorations(T);
+    Topology m;
+    if (!reflect_topology(T, m)) return false;
+    if (compare_topology(m, T) >= 0) return false;
+    T = std::move(m);
+    return true;
+}
+
+bool is_mirror_symmetric(const Topology& T) {
+    Topology a = T, m;
+    sort_decorations(a);
+    return reflect_topology(a, m) && compare_topology(a, m) == 0;
+}
@@ -0,0 +1,28 @@
+// TopoCanonical.hpp
+#pragma once
+#include "Topology.h"
+
+// 선형(체인) 토폴로지의 정규형: 반사 + 장식 순서.
+// - 반사: 블록 역순, interior link 코드의 두 끝 교환 (ab -> ba, abf -> baf), 장식 노드 u -> n-1-u.
+//   링크 곡선열이 그대로 뒤집히므로 IF는 곡선 순열만큼만 달라진다 (LST/SCFT 판정 불변).
+// - 장식: (노드, param) 순으로 정렬하고 id를 다시 매긴다.
+// 정규형 = 두 방향 중 (블록, S 장식, I 장식) 사전순으로 작은 쪽. g < L 이므로 한쪽 끝이 g면 g로 시작한다.
+// 모두 O(길이) (장식 정렬만 장식 수에 대해 k log k).
+
+// 반사 짝 링크 코드. 뒤집을 수 없는 코드면 -1
+int  mirror_link(int param) noexcept;
+
+// 반사본을 out에. 체인이 아니거나, g/L 외 블록이 있거나, g가 아닌 블록에 장식이 붙어 있으면 false
+bool reflect_topology(const Topology& T, Topology& out);
+
+// 장식 정렬. 장식 id가 공유되는 등 1:1 연결이 아니면 false (그대로 둔다)
+bool sort_decorations(Topology& T);
+
+// 사전순 비교 (<0, 0, >0). 장식은 연결 순서 그대로 비교하므로 정렬된 것끼리 비교할 것
+int  compare_topology(const Topology& a, const Topology& b) noexcept;
+
+// T를 정규형으로. 반환: 반사했으면 true
+bool canonicalize(Topology& T);
+
+// 반사해도 (장식 포함) 자기 자신인지
+bool is_mirror_symmetric(const Topology& T);
@@ -1,8 +1,5 @@
 #include "TopoLineCompact.hpp"
-#include <sstream>
-#include <vector>
-#include <cctype>
-#include <stdexcept>
+#include <charconv>
 
 static inline int kindToInt(LKind k){
     switch (k){ case LKind::g: return 0; case LKind::L: return 1; case LKind::S: return 2; case LKind::I: return 3; }
@@ -12,126 +9,230 @@ static inline LKind intToKind(int x){
     switch (x){ case 0: return LKind::g; case 1: return LKind::L; case 2: return LKind::S; case 3: return LKind::I; }
     return LKind::g;
 }
-static inline void trim(std::string& s){
-    size_t a=0,b=s.size();
-    while (a<b && std::isspace((unsigned char)s[a])) ++a;
-    while (b>a && std::isspace((unsigned char)s[b-1])) --b;
-    s = s.substr(a,b-a);
-}
-static std::vector<std::string> split(const std::string& s, char sep){
-    std::vector<std::string> out; std::string cur;
-    for(char c: s){ if(c==sep){ out.push_back(cur); cur.clear(); } else cur.push_back(c); }
-    out.push_back(cur); return out;
-}
-static std::vector<int> parse_csv_ints(const std::string& s){
-    std::vector<int> v;
-    if (s.empty()) return v;
-    for (auto& t : split(s, ',')){
-        std::string u=t; trim(u);
-        if (!u.empty()) v.push_back(std::stoi(u));
-    }
-    return v;
-}
-static std::vector<std::pair<int,int>> parse_pairs(const std::string& s){
-    // "(u,v);(u,v)" 형태
-    std::vector<std::pair<int,int>> v;
-    if (s.empty()) return v;
-    for (auto& t : split(s, ';')){
-        std::string u=t; trim(u);
-        if (u.empty()) continue;
-        // 제거
-        if (u.front()=='(' && u.back()==')') u = u.substr(1, u.size()-2);
-        auto xy = split(u, ',');
-        if (xy.size()!=2) throw std::runtime_error("bad pair: "+t);
-        v.emplace_back(std::stoi(xy[0]), std::stoi(xy[1]));
-    }
-    return v;
+
+// ===== 쓰기 =====
+static inline void put_int(std::string& out, int v){
+    char buf[12];
+    const auto r = std::to_chars(buf, buf + sizeof buf, v);
+    out.append(buf, r.ptr);
 }
 
-std::string serialize_line_compact(const Topology& T){
-    // kinds, bparams
-    std::ostringstream kinds, bparams;
-    for (size_t i=0;i<T.block.size();++i){
-        if (i){ kinds<<","; bparams<<","; }
-        kinds   << kindToInt(T.block[i].kind);
-        bparams << T.block[i].param;
-    }
-    // S/I 연결
-    std::ostringstream Sc, Ic, Sp, Ip;
+// "kinds | bparams" (블록 체인만; 정규화 출력의 base 키)
+static inline void append_base(std::string& out, const Topology& T){
+    for (size_t i=0;i<T.block.size();++i){ if (i) out += ','; put_int(out, kindToInt(T.block[i].kind)); }
+    out += " | ";
+    for (size_t i=0;i<T.block.size();++i){ if (i) out += ','; put_int(out, T.block[i].param); }
+}
+
+void append_line_compact(std::string& out, const Topology& T){
+    append_base(out, T);
+    out += " | S=";
     for (size_t i=0;i<T.s_connection.size();++i){
-        if (i) Sc<<";";
-        Sc<<"("<<T.s_connection[i].u<<","<<T.s_connection[i].v<<")";
+        if (i) out += ';';
+        out += '('; put_int(out, T.s_connection[i].u); out += ','; put_int(out, T.s_connection[i].v); out += ')';
     }
+    out += " | I=";
     for (size_t i=0;i<T.i_connection.size();++i){
-        if (i) Ic<<";";
-        Ic<<"("<<T.i_connection[i].u<<","<<T.i_connection[i].v<<")";
+        if (i) out += ';';
+        out += '('; put_int(out, T.i_connection[i].u); out += ','; put_int(out, T.i_connection[i].v); out += ')';
     }
-    for (size_t i=0;i<T.side_links.size();++i){
-        if (i) Sp<<",";
-        Sp<<T.side_links[i].param;
+    out += " | sp=";
+    for (size_t i=0;i<T.side_links.size();++i){ if (i) out += ','; put_int(out, T.side_links[i].param); }
+    out += " | ip=";
+    for (size_t i=0;i<T.instantons.size();++i){ if (i) out += ','; put_int(out, T.instantons[i].param); }
+}
+
+std::string serialize_line_compact(const Topology& T){
+    std::string s;
+    s.reserve(16 + 8 * T.block.size());
+    append_line_compact(s, T);
+    return s;
+}
+
+// ===== 읽기 =====
+static inline bool is_space(char c){ return c==' ' || c=='\t' || c=='\r' || c=='\n' || c=='\v' || c=='\f'; }
+
+static inline std::string_view trim(std::string_view s){
+    while (!s.empty() && is_space(s.front())) s.remove_prefix(1);
+    while (!s.empty() && is_space(s.back()))  s.remove_suffix(1);
+    return s;
+}
+
+// s에서 sep까지 잘라 낸다 (sep는 버림). sep가 없으면 전부
+static inline std::string_view next_token(std::string_view& s, char sep){
+    const size_t k = s.find(sep);
+    const std::string_view t = s.substr(0, k);
+    s.remove_prefix(k == std::string_view::npos ? s.size() : k + 1);
+    return t;
+}
+
+static inline bool to_int(std::string_view s, int& v){
+    s = trim(s);
+    if (!s.empty() && s.front() == '+') s.remove_prefix(1);   // stoi와 같게
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+    return r.ec == std::errc() && r.ptr == s.data() + s.size();
+}
+
+// "a,b,c" -> f(int). 빈 토큰은 건너뛴다
+template<class F>
+static inline bool each_csv_int(std::string_view s, F&& f){
+    while (!s.empty()) {
+        const std::string_view t = trim(next_token(s, ','));
+        if (t.empty()) continue;
+        int v;
+        if (!to_int(t, v)) return false;
+        f(v);
     }
-    for (size_t i=0;i<T.instantons.size();++i){
-        if (i) Ip<<",";
-        Ip<<T.instantons[i].param;
+    return true;
+}
+
+// "(u,v);(u,v)" -> f(u,v)
+template<class F>
+static inline LineStatus each_pair(std::string_view s, F&& f){
+    while (!s.empty()) {
+        std::string_view t = trim(next_token(s, ';'));
+        if (t.empty()) continue;
+        if (t.size() >= 2 && t.front()=='(' && t.back()==')') t = t.substr(1, t.size()-2);
+        const size_t c = t.find(',');
+        if (c == std::string_view::npos || t.find(',', c+1) != std::string_view::npos) return LineStatus::BadPair;
+        int u, v;
+        if (!to_int(t.substr(0, c), u) || !to_int(t.substr(c+1), v)) return LineStatus::BadInt;
+        f(u, v);
     }
-    std::ostringstream out;
-    out << kinds.str() << " | "
-        << bparams.str() << " | "
-        << "S=" << Sc.str() << " | "
-        << "I=" << Ic.str() << " | "
-        << "sp=" << Sp.str() << " | "
-        << "ip=" << Ip.str();
-    return out.str();
-}
-
-bool deserialize_line_compact(const std::string& line, Topology& out){
-    // 6 필드 파이프 구분
-    auto parts = split(line, '|');
-    if (parts.size()<2) return false;
-    for (auto& p: parts) trim(p);
-
-    // kinds
-    auto kinds_csv   = parts[0];
-    auto bparams_csv = parts[1];
-    auto kinds_vec   = parse_csv_ints(kinds_csv);
-    auto bparams_vec = parse_csv_ints(bparams_csv);
-    if (kinds_vec.size()!=bparams_vec.size()) return false;
-
-    // 초기화
-    out = Topology();
-    for (size_t i=0;i<kinds_vec.size();++i){
-        const LKind k = intToKind(kinds_vec[i]);
-        // 체인 암시: 오른쪽으로만 붙인다
-        if (i==0) out.addBlock(k, bparams_vec[i]);
-        else      out.addBlockRight(k, bparams_vec[i]);
+    return LineStatus::Ok;
+}
+
+LineStatus parse_line_compact(std::string_view line, Topology& out){
+    // 6 필드 파이프 구분 (앞 둘은 위치로, 나머지는 태그로)
+    std::string_view parts[8];
+    size_t np = 0;
+    for (std::string_view rest = line; np < 8; ) {
+        const size_t k = rest.find('|');
+        parts[np++] = trim(rest.substr(0, k));
+        if (k == std::string_view::npos) break;
+        rest.remove_prefix(k + 1);
     }
+    if (np < 2) return LineStatus::MissingField;
+
+    out.Initialize();
+    // kinds 먼저 블록으로, bparams로 파라미터 채우기 (체인 암시: l_connection 없음)
+    bool ok = each_csv_int(parts[0], [&](int k){ out.block.push_back(Block{intToKind(k), 0}); });
+    if (!ok) return LineStatus::BadInt;
+    size_t nb = 0;
+    ok = each_csv_int(parts[1], [&](int p){ if (nb < out.block.size()) out.block[nb].param = p; ++nb; });
+    if (!ok) return LineStatus::BadInt;
+    if (nb != out.block.size()) return LineStatus::CountMismatch;
 
     // 나머지 필드는 선택적
-    auto rd = [&](const std::string& tag)->std::string{
-        for (size_t i=2;i<parts.size();++i){
-            auto s = parts[i];
-            if (s.rfind(tag,0)==0){ auto t = s.substr(tag.size()); trim(t); return t; }
-        }
-        return std::string();
+    auto rd = [&](std::string_view tag) -> std::string_view {
+        for (size_t i=2;i<np;++i)
+            if (parts[i].substr(0, tag.size()) == tag) return trim(parts[i].substr(tag.size()));
+        return std::string_view();
     };
-    const std::string Sraw = rd("S=");
-    const std::string Iraw = rd("I=");
-    const std::string SPar = rd("sp=");
-    const std::string IPar = rd("ip=");
 
     // 파라미터 컨테이너 먼저 채우기
-    auto sp = parse_csv_ints(SPar);
-    auto ip = parse_csv_ints(IPar);
-    for (int v: sp) out.side_links.push_back(SideLinks{v});
-    for (int v: ip) out.instantons.push_back(Instantons{v});
+    if (!each_csv_int(rd("sp="), [&](int v){ out.side_links.push_back(SideLinks{v}); })) return LineStatus::BadInt;
+    if (!each_csv_int(rd("ip="), [&](int v){ out.instantons.push_back(Instantons{v}); })) return LineStatus::BadInt;
 
     // 연결
-    for (auto [u,sid] : parse_pairs(Sraw)){
-        out.s_connection.push_back({u, sid});
-    }
-    for (auto [u,iid] : parse_pairs(Iraw)){
-        out.i_connection.push_back({u, iid});
+    LineStatus st = each_pair(rd("S="), [&](int u, int v){ out.s_connection.push_back({u, v}); });
+    if (st != LineStatus::Ok) return st;
+    st = each_pair(rd("I="), [&](int u, int v){ out.i_connection.push_back({u, v}); });
+    return st;
+}
+
+bool deserialize_line_compact(std::string_view line, Topology& out){
+    return parse_line_compact(line, out) == LineStatus::Ok;
+}
+
+const char* line_status_name(LineStatus s) noexcept {
+    switch (s) {
+        case LineStatus::Ok:            return "ok";
+        case LineStatus::MissingField:  return "missing field";
+        case LineStatus::BadInt:        return "bad int";
+        case LineStatus::BadPair:       return "bad pair";
+        case LineStatus::CountMismatch: return "count mismatch";
+        case LineStatus::UnknownBase:   return "unknown base";
     }
+    return "?";
+}
+
+// ===== 정규화 (base + 장식) =====
+namespace {
+constexpr std::size_t kMaxBaseId = 1u << 24;   // 깨진 입력으로 표가 터지지 않게
+
+// addDecoration 순서로 다시 만들 수 있는 모양인가 (연결 k번 = 장식 id k)
+bool sequential_decorations(const Topology& T){
+    if (T.s_connection.size() != T.side_links.size() || T.i_connection.size() != T.instantons.size()) return false;
+    for (size_t k = 0; k < T.s_connection.size(); ++k) if (T.s_connection[k].v != (int)k) return false;
+    for (size_t k = 0; k < T.i_connection.size(); ++k) if (T.i_connection[k].v != (int)k) return false;
     return true;
 }
 
+// "<id> " 뒤를 돌려준다
+bool take_id(std::string_view& s, int& id){
+    s = trim(s.substr(1));
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), id);
+    if (r.ec != std::errc() || id < 0 || (std::size_t)id >= kMaxBaseId) return false;
+    s.remove_prefix((std::size_t)(r.ptr - s.data()));
+    return true;
+}
+}
+
+void LineNormEncoder::append(std::string& out, const Topology& T){
+    if (!sequential_decorations(T)) { append_line_compact(out, T); out += '\n'; return; }
+
+    key_.clear();
+    append_base(key_, T);
+    auto it = ids_.find(key_);
+    if (it == ids_.end()) {
+        it = ids_.emplace(key_, (int)ids_.size()).first;
+        out += "B "; put_int(out, it->second); out += ' '; out += key_; out += '\n';
+    }
+
+    out += "D "; put_int(out, it->second);
+    for (const auto& c : T.s_connection) {
+        out += ' '; put_int(out, c.u); out += ":S"; put_int(out, T.side_links[c.v].param);
+    }
+    for (const auto& c : T.i_connection) {
+        out += ' '; put_int(out, c.u); out += ":I"; put_int(out, T.instantons[c.v].param);
+    }
+    out += '\n';
+}
+
+LineStatus LineNormDecoder::define(std::string_view line){
+    int id;
+    if (!take_id(line, id)) return LineStatus::BadInt;
+
+    // 나머지는 line-compact의 앞 두 필드
+    thread_local Topology tmp;
+    const LineStatus st = parse_line_compact(line, tmp);
+    if (st != LineStatus::Ok) return st;
+    if (bases_.size() <= (std::size_t)id) bases_.resize((std::size_t)id + 1);
+    bases_[id] = tmp.block;
+    return LineStatus::Ok;
+}
+
+LineStatus LineNormDecoder::decode(std::string_view line, Topology& out) const{
+    if (line.empty() || line[0] != 'D') return parse_line_compact(line, out);
+
+    int id;
+    if (!take_id(line, id)) return LineStatus::BadInt;
+    if ((std::size_t)id >= bases_.size() || bases_[id].empty()) return LineStatus::UnknownBase;
+
+    out.Initialize();
+    out.block = bases_[id];
+    // "<u>:S<p>" / "<u>:I<p>"
+    while (!line.empty()) {
+        const std::string_view t = trim(next_token(line, ' '));
+        if (t.empty()) continue;
+        const size_t c = t.find(':');
+        if (c == std::string_view::npos || c + 1 >= t.size()) return LineStatus::BadPair;
+        const char k = t[c + 1];
+        if (k != 'S' && k != 'I') return LineStatus::BadPair;
+        int u, p;
+        if (!to_int(t.substr(0, c), u) || !to_int(t.substr(c + 2), p)) return LineStatus::BadInt;
+        out.addDecoration(k == 'S' ? LKind::S : LKind::I, p, u);
+    }
+    return LineStatus::Ok;
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "Topology.h"
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 // 포맷(한 줄):
 // kinds | bparams | S=(u,v);... | I=(u,v);... | sp=... | ip=...
@@ -11,7 +14,54 @@
 // - l_connection은 저장하지 않음(체인 암시).
 //
 // 예) "0,1,0,1 | -2,-3,-2,-1 | S=(0,0);(1,1) | I= | sp=22,33 | ip="
+//
+// string_view + from_chars/to_chars, 예외 없음. 쓰기는 호출 쪽 버퍼에 덧붙인다 (재사용).
+
+enum class LineStatus {
+    Ok,
+    MissingField,    // 필드가 2개 미만
+    BadInt,          // 정수가 아님
+    BadPair,         // (u,v)가 아님
+    CountMismatch,   // kinds와 bparams 길이가 다름
+    UnknownBase      // 정의되지 않은 base id (정규화 줄)
+};
+
+const char* line_status_name(LineStatus s) noexcept;
+
+void        append_line_compact(std::string& out, const Topology& T);
+LineStatus  parse_line_compact(std::string_view line, Topology& out);
 
+// 기존 API (위의 얇은 래퍼)
 std::string serialize_line_compact(const Topology& T);
-bool        deserialize_line_compact(const std::string& line, Topology& out);
+bool        deserialize_line_compact(std::string_view line, Topology& out);
+
+// ===== 정규화 출력 (base + 장식) =====
+// 한 파일의 장식 레코드들은 같은 블록 체인(base)을 되풀이한다: base는 한 번만 쓰고 레코드에는 장식만 쓴다.
+//   "B <id> <kinds> | <bparams>"    base 정의. id는 파일 안에서만 유효하고, 같은 id가 다시 나오면 덮어쓴다
+//   "D <id> <u>:S<p> ... <u>:I<p>"  레코드 = base + 장식 (S 연결 순서, 그다음 I 연결 순서)
+// 장식 id가 연결 순서와 다르면 (addDecoration으로 만들 수 없는 모양) 그 레코드만 평범한 line-compact로 쓴다.
+// 읽는 쪽은 줄 첫 글자로 구분하므로 한 파일에 섞여 있어도 된다 (숫자: line-compact, B/D: 정규화).
+class LineNormEncoder {
+public:
+    // 레코드 하나 (필요하면 B 줄 먼저), 줄바꿈까지 out 뒤에 붙인다
+    void append(std::string& out, const Topology& T);
+    void reset() { ids_.clear(); }
+
+private:
+    std::unordered_map<std::string, int> ids_;
+    std::string key_;
+};
+
+class LineNormDecoder {
+public:
+    static bool isBaseLine(std::string_view line) noexcept { return !line.empty() && line[0] == 'B'; }
+
+    // "B ..." 줄: 표에 등록
+    LineStatus define(std::string_view line);
+    // 레코드 줄: "D ..." 또는 line-compact
+    LineStatus decode(std::string_view line, Topology& out) const;
+    void reset() { bases_.clear(); }
 
+private:
+    std::vector<BlockList> bases_;
+};
@@ -3,6 +3,23 @@
 #include <iomanip>   // std::quoted
 #include <sstream>
 #include <stdexcept>
+#include <functional>
+
+// ========== 이름 ==========
+
+// 스레드별 최근 이름 표 (해시 자리 하나에 하나, 덮어쓰면 예전 것은 레코드들이 들고 있는 동안만 산다)
+std::shared_ptr<const std::string> TopoName::intern(const std::string& s) {
+    if (s.empty()) return nullptr;
+    thread_local std::shared_ptr<const std::string> recent[64];
+    auto& slot = recent[std::hash<std::string>{}(s) & 63];
+    if (!slot || *slot != s) slot = std::make_shared<const std::string>(s);
+    return slot;
+}
+
+const std::string& TopoName::empty_str() noexcept {
+    static const std::string e;
+    return e;
+}
 
 // ========== 기본 유틸 ==========
 
@@ -11,15 +28,25 @@ int Topology::addBlock(LKind kind, int param) {
     return static_cast<int>(block.size()) - 1;
 }
 
-// 새 블록을 "오른쪽"에 붙인 뒤, (last, new) 내부 링크 추가
+// 새 블록을 "오른쪽"에 붙임. (last, new) 간선은 암시적 체인이므로 저장하지 않는다.
+// 이미 명시 간선이 있으면 (체인이 아닌 경우) 거기에 이어 붙인다.
 int Topology::addBlockRight(LKind kind, int param) {
     const int newId = addBlock(kind, param);
-    if (newId > 0) {
+    if (newId > 0 && !l_connection.empty()) {
         l_connection.push_back(InteriorStructure{newId - 1, newId});
     }
     return newId;
 }
 
+void Topology::normalizeChain() {
+    if (l_connection.empty()) return;
+    if (l_connection.size() + 1 != block.size()) return;
+    for (size_t k = 0; k < l_connection.size(); ++k) {
+        if (l_connection[k].u != (int)k || l_connection[k].v != (int)k + 1) return;
+    }
+    l_connection.clear();
+}
+
 
 // === Topology.cpp — patch ===
 // ... 기존 include/코드 유지 ...
@@ -52,17 +79,17 @@ void Topology::GetBlock(int /*j*/) {
 
 // 연결 정보 일괄 설정(기존 것을 덮어씀)
 int Topology::LinkingBlocks(std::vector<InteriorStructure> lcon) {
-    l_connection = std::move(lcon);
+    l_connection = lcon;
     return static_cast<int>(l_connection.size());
 }
 
 int Topology::LinkingSideLinks(std::vector<SideLinkStructure> scon) {
-    s_connection = std::move(scon);
+    s_connection = scon;
     return static_cast<int>(s_connection.size());
 }
 
 int Topology::LinkingInstantonStructure(std::vector<InstantonStructure> icon) {
-    i_connection = std::move(icon);
+    i_connection = icon;
     return static_cast<int>(i_connection.size());
 }
 
@@ -120,7 +147,7 @@ bool Topology::saveToFile(const std::string& path) const {
     std::ofstream out(path);
     if (!out) return false;
 
-    out << "name " << std::quoted(name) << "\n";
+    out << "name " << std::quoted(name.str()) << "\n";
 
     // Blocks
     out << "blocks " << block.size() << "\n";
@@ -142,8 +169,9 @@ bool Topology::saveToFile(const std::string& path) const {
     }
 
     // Connections
-    out << "l_connection " << l_connection.size() << "\n";
-    for (const auto& e : l_connection) {
+    out << "l_connection " << interiorEdgeCount() << "\n";
+    for (int k = 0; k < interiorEdgeCount(); ++k) {
+        const auto e = interiorEdge(k);
         out << "  (" << e.u << ", " << e.v << ")\n";
     }
 
@@ -163,7 +191,7 @@ bool Topology::saveToFile(const std::string& path) const {
 // ========== 디버그 출력 연산자 ==========
 
 std::ostream& operator<<(std::ostream& os, const Topology& T) {
-    os << "Topology " << std::quoted(T.name) << "\n";
+    os << "Topology " << std::quoted(T.name.str()) << "\n";
 
     os << "  Blocks (" << T.block.size() << ")\n";
     for (size_t i = 0; i < T.block.size(); ++i) {
@@ -182,8 +210,9 @@ std::ostream& operator<<(std::ostream& os, const Topology& T) {
         os << "    [" << i << "] param=" << T.instantons[i].param << "\n";
     }
 
-    os << "  L-Connections (" << T.l_connection.size() << ")\n";
-    for (const auto& e : T.l_connection) {
+    os << "  L-Connections (" << T.interiorEdgeCount() << ")\n";
+    for (int k = 0; k < T.interiorEdgeCount(); ++k) {
+        const auto e = T.interiorEdge(k);
         os << "    " << e.u << " - " << e.v << "\n";
     }
 
@@ -4,6 +4,8 @@
 #include <utility>
 #include <cstdint>
 #include <ostream>
+#include <memory>
+#include "SmallVec.hpp"
 
 // 블록 종류: g, L, S, I
 enum class LKind : uint8_t { g, L, S, I };
@@ -42,18 +44,70 @@ struct InstantonStructure {
 	int v; //instanton id
 };
 
+// ========== 작은 버퍼 크기 ==========
+// 생성기가 다루는 레코드 대부분이 inline 버퍼 안에 들어가도록 (넘치면 힙으로)
+constexpr std::size_t kInlineBlocks = 33;   // 블록 수 (노드 + interior link)
+constexpr std::size_t kInlineDecos  = 4;    // side link / instanton 수
+constexpr std::size_t kInlineLinks  = 2;    // 명시적 l_connection (체인이 아닐 때만)
+
+using BlockList = SmallVec<Block,              kInlineBlocks>;
+using SideList  = SmallVec<SideLinks,          kInlineDecos>;
+using InstList  = SmallVec<Instantons,         kInlineDecos>;
+using LConnList = SmallVec<InteriorStructure,  kInlineLinks>;
+using SConnList = SmallVec<SideLinkStructure,  kInlineDecos>;
+using IConnList = SmallVec<InstantonStructure, kInlineDecos>;
+
+// 토폴로지 이름: 공유 문자열을 가리킨다 (복사 = 참조 카운트 하나). 마지막 레코드가 사라지면 풀린다.
+// 같은 이름이 이어지면 스레드별 작은 표(최근 64개)에서 같은 문자열을 다시 쓴다 (전역 잠금/무한히 자라는 풀 없음).
+// 빈 이름은 표를 거치지 않는다.
+class TopoName {
+public:
+    TopoName() noexcept = default;
+    TopoName(const std::string& s) : p_(intern(s)) {}
+    TopoName(const char* s) : p_(intern(s)) {}
+    TopoName& operator=(const std::string& s){ p_ = intern(s); return *this; }
+    TopoName& operator=(const char* s){ p_ = intern(s); return *this; }
+
+    const std::string& str() const noexcept { return p_ ? *p_ : empty_str(); }
+    operator const std::string&() const noexcept { return str(); }
+    bool empty() const noexcept { return p_ == nullptr; }
+    void clear() noexcept { p_.reset(); }
+
+    friend bool operator==(const TopoName& a, const TopoName& b) noexcept { return a.p_ == b.p_ || a.str() == b.str(); }
+    friend bool operator!=(const TopoName& a, const TopoName& b) noexcept { return !(a == b); }
+    friend std::ostream& operator<<(std::ostream& os, const TopoName& n){ return os << n.str(); }
+
+private:
+    static std::shared_ptr<const std::string> intern(const std::string& s);
+    static const std::string& empty_str() noexcept;
+    std::shared_ptr<const std::string> p_;
+};
+
 // 토폴로지 데이터 세트
+// l_connection이 비어 있으면 블록 체인 0-1-2-...-(n-1)을 뜻한다 (addBlockRight는 간선을 저장하지 않음).
+// 간선을 읽을 때는 interiorEdgeCount()/interiorEdge(k)를 쓴다.
 struct Topology {
-    std::string name; // SgS, SgLgS.. like..
+    TopoName name; // SgS, SgLgS.. like..
 
-    std::vector<Block>     block;       // Set of Blocks(nodes, interior links
-    std::vector<SideLinks>      side_links;  // Set of side links
-    std::vector<Instantons>     instantons;  // Set of instantons
+    BlockList     block;       // Set of Blocks(nodes, interior links
+    SideList      side_links;  // Set of side links
+    InstList      instantons;  // Set of instantons
 
     // Linking structure
-    std::vector<InteriorStructure> l_connection; // connected structures between nodes and interior links (e.g. (0,1) = g at 0 and L at 1 are connected)
-    std::vector<SideLinkStructure> s_connection; // connected structures between nodes and sidelinks (e.g. (0,0), (0,1) = side link at 0 and 1 are connected to 0 th block(generally node g)
-    std::vector<InstantonStructure> i_connection;  // connected structures between nodes and instantons (e.g. (0,0) = instanton at 0 is connected to 0 th block(generally node g)
+    LConnList l_connection; // connected structures between nodes and interior links (e.g. (0,1) = g at 0 and L at 1 are connected); empty = implicit chain
+    SConnList s_connection; // connected structures between nodes and sidelinks (e.g. (0,0), (0,1) = side link at 0 and 1 are connected to 0 th block(generally node g)
+    IConnList i_connection;  // connected structures between nodes and instantons (e.g. (0,0) = instanton at 0 is connected to 0 th block(generally node g)
+
+    // === interior 간선 (암시적 체인 포함) ===
+    bool isChain() const noexcept { return l_connection.empty(); }
+    int  interiorEdgeCount() const noexcept {
+        return isChain() ? (block.size() > 1 ? (int)block.size() - 1 : 0) : (int)l_connection.size();
+    }
+    InteriorStructure interiorEdge(int k) const noexcept {
+        return isChain() ? InteriorStructure{k, k + 1} : l_connection[k];
+    }
+    // 명시 간선이 정확히 (0,1),(1,2),... 이면 비워서 암시적 체인으로
+    void normalizeChain();
 
     // === 유틸 함수들 (구현은 .cpp) ===
     int  addBlock(LKind kind, int param);
@@ -0,0 +1,206 @@
+// TopologyCursor.cpp
+#include "TopologyCursor.hpp"
+#include "TopoLineCompact.hpp"
+#include <charconv>
+#include <iostream>
+
+// ===== 내부 유틸 =====
+static inline std::string_view trim_sv(std::string_view s){
+    while (!s.empty() && (s.front()==' ' || s.front()=='\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back()==' ' || s.back()=='\t' || s.back()=='\r' || s.back()=='\n')) s.remove_suffix(1);
+    return s;
+}
+
+// "a,b" 또는 "a" 읽기
+static inline bool parse_int(std::string_view s, int& v){
+    s = trim_sv(s);
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+    return r.ec == std::errc() && r.ptr == s.data() + s.size();
+}
+static inline bool parse_pair(std::string_view s, int& a, int& b){
+    const size_t c = s.find(',');
+    return c != std::string_view::npos && parse_int(s.substr(0, c), a) && parse_int(s.substr(c + 1), b);
+}
+// "key:N" 읽기
+static inline bool parse_count(std::string_view s, std::string_view key, int& n){
+    s = trim_sv(s);
+    return s.substr(0, key.size()) == key && parse_int(s.substr(key.size()), n) && n >= 0;
+}
+
+static inline LKind intToKind(int k){
+    switch (k){ case 0: return LKind::g; case 1: return LKind::L; case 2: return LKind::S; case 3: return LKind::I; }
+    return LKind::g;
+}
+
+// ===== 열기 =====
+TopologyCursor::Format TopologyCursor::detectDB(const std::string& path){
+    return TopologyDBFile::isBinary(path) ? Format::BinaryDB : Format::TextDB;
+}
+
+bool TopologyCursor::open(const std::string& path, Format fmt){
+    fmt_ = fmt;
+    count_ = 0;
+    nLines_ = 0;
+    pos_ = next_ = 0;
+    norm_.reset();
+    mem_ = false;
+    spans_.clear();
+    in_.close();
+    in_.clear();
+    if (fmt == Format::BinaryDB) {
+        ok_ = bin_.open(path);
+        if (ok_) bin_.adviseSequential();
+        else if (bin_.error()) std::cerr << "[Error] binary DB " << path << ": " << bin_.error() << "\n";
+    } else {
+        in_.open(path);
+        ok_ = (bool)in_;
+    }
+    return ok_;
+}
+
+bool TopologyCursor::openSpans(std::vector<std::string_view> spans){
+    fmt_ = Format::Line;
+    count_ = 0;
+    nLines_ = 0;
+    pos_ = next_ = 0;
+    norm_.reset();
+    in_.close();
+    mem_ = true;
+    spans_ = std::move(spans);
+    span_ = 0;
+    ok_ = true;
+    return ok_;
+}
+
+bool TopologyCursor::readLine(std::string& s){
+    if (mem_) {
+        while (span_ < spans_.size() && spans_[span_].empty()) ++span_;
+        if (span_ >= spans_.size()) return false;
+        std::string_view& sp = spans_[span_];
+        const size_t k = sp.find('\n');
+        s.assign(sp.data(), k == std::string_view::npos ? sp.size() : k);
+        sp.remove_prefix(k == std::string_view::npos ? sp.size() : k + 1);
+        next_ += s.size() + 1;
+        if (!s.empty() && s.back() == '\r') s.pop_back();
+        return true;
+    }
+    if (!std::getline(in_, s)) return false;
+    next_ += s.size() + 1;
+    if (!s.empty() && s.back() == '\r') s.pop_back();
+    return true;
+}
+
+// ===== 진행 =====
+bool TopologyCursor::advance(){
+    if (!ok_) return false;
+
+    if (fmt_ == Format::BinaryDB) {
+        if (count_ >= bin_.size()) return false;
+        binOk_ = bin_.valid(count_);   // 깨진 레코드는 decode가 false (텍스트 DB와 같이 건너뛴다)
+        ++count_;
+        return true;
+    }
+
+    // 빈 줄은 건너뛴다. line 형식의 base 정의 줄(B ...)은 표에만 올리고 레코드로 세지 않는다
+    for (;;) {
+        pos_ = next_;
+        if (!readLine(header_)) return false;
+        if (header_.empty()) continue;
+        if (fmt_ == Format::Line && LineNormDecoder::isBaseLine(header_)) { norm_.define(header_); continue; }
+        break;
+    }
+
+    if (fmt_ == Format::TextDB) {
+        // "name\tN" 뒤 N줄
+        const size_t tab = header_.find('\t');
+        int n = 0;
+        if (tab == std::string::npos || !parse_int(std::string_view(header_).substr(tab + 1), n) || n < 0) n = 0;
+        if (lines_.size() < (size_t)n) lines_.resize(n);
+        nLines_ = 0;
+        while (nLines_ < (size_t)n && readLine(lines_[nLines_])) ++nLines_;
+    }
+    ++count_;
+    return true;
+}
+
+std::uint64_t TopologyCursor::position() const noexcept {
+    if (fmt_ == Format::BinaryDB) return count_ ? bin_.offsetOf(count_ - 1) : 0;
+    return pos_;
+}
+
+bool TopologyCursor::seek(std::uint64_t offset){
+    if (!ok_) return false;
+    if (fmt_ == Format::BinaryDB) {
+        const std::size_t i = bin_.indexOf(offset);
+        if (i >= bin_.size()) return false;
+        count_ = i;   // 다음 advance()가 i번을 가리킨다
+        return true;
+    }
+    if (mem_) return false;
+    in_.clear();
+    in_.seekg((std::streamoff)offset);
+    if (!in_) return false;
+    next_ = offset;
+    nLines_ = 0;
+    return true;
+}
+
+std::string_view TopologyCursor::name() const noexcept {
+    switch (fmt_) {
+        case Format::BinaryDB:
+            return count_ && binOk_ ? bin_[count_ - 1].name() : std::string_view();
+        case Format::TextDB: {
+            if (nLines_ > 0 && lines_[0].rfind("name:", 0) == 0 && lines_[0].size() > 5)
+                return std::string_view(lines_[0]).substr(5);
+            const size_t tab = header_.find('\t');
+            return std::string_view(header_).substr(0, tab == std::string::npos ? header_.size() : tab);
+        }
+        case Format::Line:
+            break;
+    }
+    return {};
+}
+
+// ===== 풀기 =====
+bool TopologyCursor::decode(Topology& T) const {
+    if (!ok_ || count_ == 0) return false;
+
+    if (fmt_ == Format::BinaryDB) {
+        if (!binOk_) return false;
+        bin_[count_ - 1].decode(T);
+        return true;
+    }
+    if (fmt_ == Format::Line)     return norm_.decode(header_, T) == LineStatus::Ok;
+
+    // 텍스트 DB payload: TopologyDB::serializeCanonical 형식
+    T.Initialize();
+    size_t k = 0;
+    auto line = [&]() -> std::string_view { return k < nLines_ ? std::string_view(lines_[k++]) : std::string_view(); };
+    if (k >= nLines_ || lines_[0].rfind("name:", 0) != 0) return false;
+    const std::string_view nm = name();
+    if (!nm.empty()) T.name = std::string(nm);
+    ++k;
+
+    int n = 0, a = 0, b = 0;
+    if (!parse_count(line(), "blocks:", n)) return false;
+    T.block.reserve(n);
+    for (int i = 0; i < n; ++i) { if (!parse_pair(line(), a, b)) return false; T.block.push_back(Block{intToKind(a), b}); }
+
+    if (!parse_count(line(), "side_links:", n)) return false;
+    for (int i = 0; i < n; ++i) { if (!parse_int(line(), a)) return false; T.side_links.push_back(SideLinks{a}); }
+
+    if (!parse_count(line(), "instantons:", n)) return false;
+    for (int i = 0; i < n; ++i) { if (!parse_int(line(), a)) return false; T.instantons.push_back(Instantons{a}); }
+
+    // 연결: 깨진 줄은 건너뛴다 (기존 리더와 같음)
+    if (!parse_count(line(), "l_conn:", n)) return false;
+    for (int i = 0; i < n; ++i) if (parse_pair(line(), a, b)) T.l_connection.push_back({a, b});
+    T.normalizeChain();
+
+    if (!parse_count(line(), "s_conn:", n)) return false;
+    for (int i = 0; i < n; ++i) if (parse_pair(line(), a, b)) T.s_connection.push_back({a, b});
+
+    if (!parse_count(line(), "i_conn:", n)) return false;
+    for (int i = 0; i < n; ++i) if (parse_pair(line(), a, b)) T.i_connection.push_back({a, b});
+    return true;
+}
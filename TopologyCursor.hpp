@@ -0,0 +1,81 @@
+// TopologyCursor.hpp
+#pragma once
+#include "Topology.h"
+#include "TopologyDBBin.hpp"
+#include "TopoLineCompact.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+
+// 입력 하나(텍스트 DB / 바이너리 DB / line-compact 파일, 정규화 B/D 줄 포함)를 앞으로만 읽는 커서.
+// 레코드를 전부 올리지 않고, next()마다 재사용하는 Topology 하나에 푼다.
+// 텍스트는 줄 버퍼를 재사용하고 숫자는 from_chars로 읽는다 (레코드마다 스트림을 만들지 않음).
+//
+//   TopologyCursor cur(path, TopologyCursor::Format::Line);
+//   Topology T;
+//   while (cur.next(T)) { ... }
+class TopologyCursor {
+public:
+    enum class Format { TextDB, BinaryDB, Line };
+
+    TopologyCursor() = default;
+    TopologyCursor(const std::string& path, Format fmt) { open(path, fmt); }
+
+    // DB 파일: magic을 보고 TextDB / BinaryDB
+    static Format detectDB(const std::string& path);
+    static TopologyCursor openDB(const std::string& path) { return TopologyCursor(path, detectDB(path)); }
+
+    bool open(const std::string& path, Format fmt);
+    // 이미 메모리에 있는 line 텍스트 (팩 샤드: PackReader::spans). 조각은 줄 경계에서 끊겨 있어야 하고
+    // 커서보다 오래 살아야 한다. seek은 안 됨
+    bool openSpans(std::vector<std::string_view> spans);
+    bool ok() const noexcept { return ok_; }
+    Format format() const noexcept { return fmt_; }
+
+    // 다음 레코드로 (풀지 않음). 끝이면 false
+    bool advance();
+    // 현재 레코드 이름 (DB만; payload의 name: 우선, 없으면 헤더 이름). 다음 advance()까지 유효
+    std::string_view name() const noexcept;
+    // 현재 레코드를 out에 풀기. 형식이 깨졌으면 false
+    bool decode(Topology& out) const;
+
+    // advance + decode, 깨진 레코드는 건너뛴다
+    bool next(Topology& out) {
+        while (advance()) if (decode(out)) return true;
+        return false;
+    }
+
+    // 지금까지 advance()한 레코드 수
+    std::size_t index() const noexcept { return count_; }
+
+    // 현재 레코드의 시작 바이트 오프셋 (advance() 이후 유효)
+    std::uint64_t position() const noexcept;
+    // 오프셋의 레코드로 이동: 다음 advance()가 그 레코드를 읽는다 (TopologyDBIndex 조회용)
+    bool seek(std::uint64_t offset);
+
+private:
+    bool readLine(std::string& s);
+
+    Format         fmt_ = Format::Line;
+    bool           ok_ = false;
+    std::size_t    count_ = 0;
+    std::uint64_t  pos_ = 0;       // 현재 레코드 시작 (텍스트)
+    std::uint64_t  next_ = 0;      // 다음에 읽을 바이트 (텍스트)
+
+    // 텍스트 (DB / line)
+    std::ifstream            in_;
+    std::string              header_;      // DB: "name\tN", line: 레코드 한 줄
+    std::vector<std::string> lines_;       // DB payload 줄 (용량 재사용)
+    std::size_t              nLines_ = 0;
+    LineNormDecoder          norm_;        // line: 정규화 출력의 base 표
+
+    // 메모리 조각 (openSpans)
+    bool                          mem_ = false;
+    std::vector<std::string_view> spans_;
+    std::size_t                   span_ = 0;
+
+    // 바이너리
+    TopologyDBFile bin_;
+    bool           binOk_ = false;   // 현재 레코드 머리가 제 구간 안에 있는지 (TopologyDBFile::valid)
+};
@@ -1,9 +1,20 @@
 // TopologyDB.cpp
 #include "TopologyDB.hpp"
+#include "TopologyDBBin.hpp"
+#include "TopologyCursor.hpp"
+#include "TopologyDBIndex.hpp"
+#include "TopologyDBDedupe.hpp"
+#include "FileUtil.hpp"
 #include <fstream>
 #include <sstream>
-#include <unordered_map>
+#include <atomic>
+#include <charconv>
 #include <filesystem>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 
 // ===== 내부 유틸 =====
 static inline int kindToInt(LKind k){
@@ -17,49 +28,55 @@ static inline LKind intToKind(int k){
 
 TopologyDB::TopologyDB(std::string path) : path_(std::move(path)) {}
 
-int TopologyDB::countLines(const std::string& s){ int n=0; for(char c: s) if(c=='\n') ++n; return n; }
+// ===== 직렬화/역직렬화 (기존 내용 그대로) =====
+static void trim_end(std::string& s){ while(!s.empty() && (s.back()=='\r'||s.back()=='\n')) s.pop_back(); }
+static int parseCount(const std::string& s, const char* key){ if (s.rfind(key,0)!=0) return 0; return std::stoi(s.substr(std::string(key).size())); }
 
-std::string TopologyDB::cheapHashHex(const std::string& s){
-    // 64-bit FNV-1a
-    uint64_t h = 1469598103934665603ULL;
-    for (unsigned char c : s) { h ^= c; h *= 1099511628211ULL; }
-    std::ostringstream os; os << std::hex << h; return os.str();
+// payload만 (to_chars, 스트림 없음)
+static inline void put_int(std::string& out, long v){
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof buf, v);
+    out.append(buf, r.ptr);
 }
-
-bool TopologyDB::writeFileAtomic(const std::string& path, const std::string& content){
-    const auto p = std::filesystem::path(path);
-    std::filesystem::create_directories(p.parent_path());
-    const auto tmp = (p.parent_path() / (p.filename().string() + ".tmp")).string();
-    { std::ofstream out(tmp, std::ios::binary|std::ios::trunc);
-      if(!out) return false;
-      out.write(content.data(), (std::streamsize)content.size());
-      if(!out.good()) return false;
-    }
-    std::error_code ec; std::filesystem::rename(tmp, path, ec);
-    if (ec) { std::filesystem::remove(tmp); return false; }
-    return true;
+static inline void put_count(std::string& out, const char* key, std::size_t n){
+    out += key; put_int(out, (long)n); out += '\n';
+}
+static inline void put_pair(std::string& out, int a, int b){
+    out += "  "; put_int(out, a); out += ','; put_int(out, b); out += '\n';
+}
+static inline void put_one(std::string& out, int a){
+    out += "  "; put_int(out, a); out += '\n';
 }
 
-// ===== 직렬화/역직렬화 (기존 내용 그대로) =====
-static void trim_end(std::string& s){ while(!s.empty() && (s.back()=='\r'||s.back()=='\n')) s.pop_back(); }
-static int parseCount(const std::string& s, const char* key){ if (s.rfind(key,0)!=0) return 0; return std::stoi(s.substr(std::string(key).size())); }
+static void append_payload(std::string& out, const Topology& T){
+    out += "name:"; out += T.name.str(); out += '\n';
+    put_count(out, "blocks:", T.block.size());
+    for (const auto& b : T.block) put_pair(out, kindToInt(b.kind), b.param);
+    put_count(out, "side_links:", T.side_links.size());
+    for (const auto& s : T.side_links) put_one(out, s.param);
+    put_count(out, "instantons:", T.instantons.size());
+    for (const auto& i : T.instantons) put_one(out, i.param);
+    // 암시적 체인도 간선으로 풀어 쓴다 (파일 형식 유지)
+    put_count(out, "l_conn:", (std::size_t)T.interiorEdgeCount());
+    for (int k = 0; k < T.interiorEdgeCount(); ++k){ const auto e = T.interiorEdge(k); put_pair(out, e.u, e.v); }
+    put_count(out, "s_conn:", T.s_connection.size());
+    for (const auto& e : T.s_connection) put_pair(out, e.u, e.v);
+    put_count(out, "i_conn:", T.i_connection.size());
+    for (const auto& e : T.i_connection) put_pair(out, e.u, e.v);
+}
 
 std::string TopologyDB::serializeCanonical(const Topology& T){
-    std::ostringstream os;
-    os << "name:" << T.name << "\n";
-    os << "blocks:" << T.block.size() << "\n";
-    for (const auto& b : T.block) os << "  " << kindToInt(b.kind) << "," << b.param << "\n";
-    os << "side_links:" << T.side_links.size() << "\n";
-    for (const auto& s : T.side_links) os << "  " << s.param << "\n";
-    os << "instantons:" << T.instantons.size() << "\n";
-    for (const auto& i : T.instantons) os << "  " << i.param << "\n";
-    os << "l_conn:" << T.l_connection.size() << "\n";
-    for (const auto& e : T.l_connection) os << "  " << e.u << "," << e.v << "\n";
-    os << "s_conn:" << T.s_connection.size() << "\n";
-    for (const auto& e : T.s_connection) os << "  " << e.u << "," << e.v << "\n";
-    os << "i_conn:" << T.i_connection.size() << "\n";
-    for (const auto& e : T.i_connection) os << "  " << e.u << "," << e.v << "\n";
-    return os.str();
+    std::string s;
+    append_payload(s, T);
+    return s;
+}
+
+// 헤더 줄 수는 세지 않고 계산한다 (섹션 7줄 + 항목)
+void TopologyDB::appendRecord(std::string& out, const Topology& T){
+    const std::size_t lines = 7 + T.block.size() + T.side_links.size() + T.instantons.size()
+                            + (std::size_t)T.interiorEdgeCount() + T.s_connection.size() + T.i_connection.size();
+    out += T.name.str(); out += '\t'; put_int(out, (long)lines); out += '\n';
+    append_payload(out, T);
 }
 
 bool TopologyDB::deserializeCanonical(std::istream& in, int /*nLines*/, Topology& T){
@@ -93,7 +110,7 @@ bool TopologyDB::deserializeCanonical(std::istream& in, int /*nLines*/, Topology
       std::vector<InteriorStructure> L;
       for(int i=0;i<n;i++){ if(!std::getline(in,line)) return false; trim_end(line);
         std::istringstream ls(line); int u,v; char comma; if(ls>>u>>comma>>v) L.push_back({u,v});
-      } T.LinkingBlocks(std::move(L)); }
+      } T.LinkingBlocks(std::move(L)); T.normalizeChain(); }
 
     if(!std::getline(in, line)) return false; trim_end(line);
     { int n = parseCount(line, "s_conn:");
@@ -112,115 +129,309 @@ bool TopologyDB::deserializeCanonical(std::istream& in, int /*nLines*/, Topology
     return true;
 }
 
-// ===== 기본 IO =====
-bool TopologyDB::append(const Topology& T) const{
-    const std::string payload = serializeCanonical(T);
-    const int lines = countLines(payload);
-    std::ofstream out(path_, std::ios::app);
-    if(!out) return false;
-    out << T.name << "\t" << lines << "\n" << payload;
+// ===== 세그먼트 / manifest =====
+namespace {
+// <db>.lock 에 flock (manifest 갱신과 compact를 직렬화)
+class DBLock {
+public:
+    explicit DBLock(const std::string& path){
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ >= 0 && ::flock(fd_, LOCK_EX) != 0) { ::close(fd_); fd_ = -1; }
+    }
+    ~DBLock(){ if (fd_ >= 0) { ::flock(fd_, LOCK_UN); ::close(fd_); } }
+    DBLock(const DBLock&) = delete;
+    DBLock& operator=(const DBLock&) = delete;
+    bool ok() const noexcept { return fd_ >= 0; }
+private:
+    int fd_ = -1;
+};
+
+bool write_all(int fd, const char* p, std::size_t n){
+    while (n > 0) {
+        const ssize_t w = ::write(fd, p, n);
+        if (w < 0) { if (errno == EINTR) continue; return false; }
+        p += w; n -= (std::size_t)w;
+    }
     return true;
 }
 
-std::vector<TopologyDB::Record> TopologyDB::loadAll() const{
-    std::vector<Record> out;
-    std::ifstream in(path_);
-    if(!in) return out;
-
-    std::string header;
-    while(std::getline(in, header)){
-        if(header.empty()) continue;
-        std::istringstream hs(header);
-        std::string nm, cnt;
-        if(!std::getline(hs, nm, '\t')) continue;
-        if(!std::getline(hs, cnt)) continue;
-        int n = std::stoi(cnt);
-
-        std::ostringstream payload;
-        for(int i=0;i<n;i++){ std::string l; if(!std::getline(in,l)) break; payload << l << "\n"; }
-
-        std::istringstream pin(payload.str());
-        Topology T;
-        if(!deserializeCanonical(pin, n, T)) continue;
-        if(T.name.empty()) T.name = nm;
+void remove_with_index(const std::string& file){
+    std::error_code ec;
+    std::filesystem::remove(file, ec);
+    std::filesystem::remove(TopologyDBIndex::pathFor(file), ec);
+}
 
-        out.push_back(Record{nm, std::move(T)});
+// 파일 하나에서 이름 찾기 (인덱스 우선)
+bool load_by_name_in(const std::string& file, const std::string& name, Topology& out){
+    TopologyCursor cur = TopologyCursor::openDB(file);
+    if (!cur.ok()) return false;
+
+    TopologyDBIndex idx;
+    if (idx.openOrRebuild(file)) {
+        std::vector<std::uint64_t> offs;
+        idx.findName(TopologyDBIndex::nameHash(name), offs);
+        for (const auto off : offs)
+            if (cur.seek(off) && cur.advance() && cur.name() == name && cur.decode(out)) return true;
+        return false;
     }
-    return out;
-}
 
-bool TopologyDB::loadByName(const std::string& name, Topology& out) const{
-    auto all = loadAll();
-    for (auto& r : all){
-        const std::string nm = r.topo.name.empty() ? r.name : r.topo.name;
-        if (nm == name){ out = r.topo; return true; }
+    while (cur.advance()){
+        if (cur.name() == name && cur.decode(out)) return true;
     }
     return false;
 }
 
-// ===== ✅ 중복제거 구현 =====
-int TopologyDB::dedupeByContentHash(bool keep_last) const {
-    auto all = loadAll();
-    if (all.empty()) return 0;
-
-    std::unordered_map<std::string, int> seen;
-    std::vector<Record> kept; kept.reserve(all.size());
-
-    if (!keep_last) {
-        // 처음 본 payload만 남김
-        for (auto& r : all) {
-            const std::string payload = serializeCanonical(r.topo);
-            const std::string h = cheapHashHex(payload);
-            if (seen.emplace(h, 1).second) kept.push_back(std::move(r));
-        }
-    } else {
-        // 마지막 것만 남기려면 뒤에서 앞으로 본 뒤 다시 뒤집기
-        std::vector<Record> rev(all.rbegin(), all.rend());
-        for (auto& r : rev) {
-            const std::string payload = serializeCanonical(r.topo);
-            const std::string h = cheapHashHex(payload);
-            if (seen.emplace(h, 1).second) kept.push_back(std::move(r));
-        }
-        std::reverse(kept.begin(), kept.end());
+bool contains_content_in(const std::string& file, const Topology& T){
+    TopologyCursor cur = TopologyCursor::openDB(file);
+    if (!cur.ok()) return false;
+    Topology R;
+
+    TopologyDBIndex idx;
+    if (idx.openOrRebuild(file)) {
+        std::vector<std::uint64_t> offs;
+        idx.findContent(TopologyDBIndex::contentHash(T), offs);
+        for (const auto off : offs)
+            if (cur.seek(off) && cur.advance() && cur.decode(R) && TopologyDBIndex::sameContent(R, T)) return true;
+        return false;
     }
 
-    // 재작성
-    std::ostringstream buf;
-    for (auto& r : kept) {
-        const std::string payload = serializeCanonical(r.topo);
-        buf << r.topo.name << "\t" << countLines(payload) << "\n" << payload;
+    while (cur.next(R)) if (TopologyDBIndex::sameContent(R, T)) return true;
+    return false;
+}
+}
+
+std::vector<std::string> TopologyDB::parts() const{
+    std::vector<std::string> out;
+    std::error_code ec;
+    if (std::filesystem::exists(path_, ec)) out.push_back(path_);
+    std::ifstream in(manifestPath());
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        const std::string seg = segmentDir() + "/" + line;
+        if (std::filesystem::exists(seg, ec)) out.push_back(seg);
     }
-    if (!writeFileAtomic(path_, buf.str())) return 0;
-    return (int)all.size() - (int)kept.size();
+    return out;
 }
 
-int TopologyDB::dedupeByName(bool keep_last) const {
-    auto all = loadAll();
-    if (all.empty()) return 0;
+bool TopologyDB::compact() const{
+    DBLock lock(lockPath());
+    if (!lock.ok()) return false;
 
-    std::unordered_map<std::string, int> seen;
-    std::vector<Record> kept; kept.reserve(all.size());
+    std::vector<std::string> segs = parts();
+    std::error_code ec;
+    if (!segs.empty() && segs.front() == path_) segs.erase(segs.begin());
+    if (segs.empty()) return true;
 
-    if (!keep_last) {
-        for (auto& r : all) {
-            const std::string nm = r.topo.name.empty() ? r.name : r.topo.name;
-            if (seen.emplace(nm, 1).second) kept.push_back(std::move(r));
+    const bool hasMain = std::filesystem::exists(path_, ec);
+    if (hasMain && isBinary()) {
+        TopologyDBBinWriter w(path_);
+        Topology T;
+        for (const auto& file : parts()) {
+            TopologyCursor cur = TopologyCursor::openDB(file);
+            while (cur.next(T)) if (!w.add(T, cur.name())) return false;
         }
+        if (!w.close()) return false;
     } else {
-        std::vector<Record> rev(all.rbegin(), all.rend());
-        for (auto& r : rev) {
-            const std::string nm = r.topo.name.empty() ? r.name : r.topo.name;
-            if (seen.emplace(nm, 1).second) kept.push_back(std::move(r));
+        // 텍스트끼리는 바이트 그대로 이어 붙인다 (본 파일 레코드의 오프셋도 그대로)
+        AtomicOutFile f(path_);
+        if (!f.ok()) return false;
+        for (const auto& file : parts()) {
+            if (std::filesystem::file_size(file, ec) == 0 || ec) continue;
+            std::ifstream in(file, std::ios::binary);
+            f.stream() << in.rdbuf();
         }
-        std::reverse(kept.begin(), kept.end());
+        if (!f.commit()) return false;
+    }
+
+    std::filesystem::remove(manifestPath(), ec);
+    for (const auto& seg : segs) remove_with_index(seg);
+    std::filesystem::remove(segmentDir(), ec);   // 비었을 때만 지워진다
+    rebuildIndex();
+    return true;
+}
+
+// ===== 기본 IO =====
+bool TopologyDB::isBinary() const{ return TopologyDBFile::isBinary(path_); }
+
+bool TopologyDB::append(const Topology& T) const{
+    if (isBinary()) return false;
+    Writer w = writer(0);
+    return w.add(T) && w.close();
+}
+
+TopologyDB::Writer TopologyDB::writer(std::size_t bufBytes) const{
+    Writer w;
+    if (!isBinary()) w.open(path_, path_, false, bufBytes);
+    return w;
+}
+
+TopologyDB::Writer TopologyDB::segmentWriter(std::size_t bufBytes) const{
+    static std::atomic<unsigned> counter{0};
+    Writer w;
+    std::error_code ec;
+    std::filesystem::create_directories(segmentDir(), ec);
+    // pid-번호: 다른 프로세스와 겹치면 O_EXCL이 실패하니 다음 번호로
+    for (int tries = 0; tries < 1000 && !w.ok(); ++tries) {
+        const std::string file = segmentDir() + "/" + std::to_string((long)::getpid()) + "-" + std::to_string(counter++) + ".db";
+        w.open(path_, file, true, bufBytes);
     }
+    return w;
+}
 
-    std::ostringstream buf;
-    for (auto& r : kept) {
-        const std::string payload = serializeCanonical(r.topo);
-        buf << r.topo.name << "\t" << countLines(payload) << "\n" << payload;
+std::vector<TopologyDB::Record> TopologyDB::loadAll() const{
+    std::vector<Record> out;
+    Topology T;
+    for (const auto& file : parts()) {
+        TopologyCursor cur = TopologyCursor::openDB(file);
+        while (cur.next(T)) out.push_back(Record{std::string(cur.name()), T});
     }
-    if (!writeFileAtomic(path_, buf.str())) return 0;
-    return (int)all.size() - (int)kept.size();
+    return out;
+}
+
+// 인덱스로 후보 오프셋만 찾아가 이름을 확인한다. 인덱스를 못 쓰면 이름만 보며 훑는다
+bool TopologyDB::loadByName(const std::string& name, Topology& out) const{
+    for (const auto& file : parts()) if (load_by_name_in(file, name, out)) return true;
+    return false;
+}
+
+bool TopologyDB::containsName(const std::string& name) const{
+    Topology T;
+    return loadByName(name, T);
+}
+
+bool TopologyDB::containsContent(const Topology& T) const{
+    for (const auto& file : parts()) if (contains_content_in(file, T)) return true;
+    return false;
+}
+
+bool TopologyDB::rebuildIndex() const{
+    bool ok = true;
+    for (const auto& file : parts()) ok = TopologyDBIndex::rebuild(file) && ok;
+    return ok;
+}
+
+// ===== Writer =====
+bool TopologyDB::Writer::open(std::string dbPath, std::string file, bool segment, std::size_t bufBytes){
+    close();
+    const int flags = O_WRONLY | O_CREAT | O_APPEND | (segment ? O_EXCL : 0);
+    fd_ = ::open(file.c_str(), flags, 0644);
+    if (fd_ < 0) return false;
+    struct stat st{};
+    bytes_   = (::fstat(fd_, &st) == 0) ? (std::uint64_t)st.st_size : 0;
+    dbPath_  = std::move(dbPath);
+    file_    = std::move(file);
+    segment_ = segment;
+    limit_   = bufBytes;
+    count_   = 0;
+    buf_.clear();
+    buf_.reserve(bufBytes + 4096);
+    pending_.clear();
+    return true;
 }
 
+TopologyDB::Writer& TopologyDB::Writer::operator=(Writer&& o) noexcept{
+    if (this == &o) return *this;
+    close();
+    dbPath_  = std::move(o.dbPath_);
+    file_    = std::move(o.file_);
+    segment_ = o.segment_;
+    fd_      = o.fd_;
+    limit_   = o.limit_;
+    count_   = o.count_;
+    bytes_   = o.bytes_;
+    buf_     = std::move(o.buf_);
+    pending_ = std::move(o.pending_);
+    o.fd_ = -1;
+    return *this;
+}
+
+bool TopologyDB::Writer::add(const Topology& T){
+    if (fd_ < 0) return false;
+    const std::uint64_t at = bytes_ + buf_.size();
+    pending_.push_back({TopologyDBIndex::nameHash(T.name.str()), TopologyDBIndex::contentHash(T), at});
+    appendRecord(buf_, T);
+    ++count_;
+    return buf_.size() < limit_ || flush();
+}
+
+bool TopologyDB::Writer::flush(){
+    if (fd_ < 0) return false;
+    if (buf_.empty()) return true;
+    if (!write_all(fd_, buf_.data(), buf_.size())) return false;
+    const std::uint64_t old = bytes_;
+    bytes_ += buf_.size();
+    buf_.clear();
+    // 인덱스가 맞아 있으면 꼬리에 붙인다 (낡았으면 다음 조회 때 재구축)
+    TopologyDBIndex::appendEntries(file_, old, pending_.data(), pending_.size(), bytes_);
+    pending_.clear();
+    return true;
+}
+
+bool TopologyDB::Writer::close(){
+    if (fd_ < 0) return false;
+    const bool ok = flush();
+    ::close(fd_);
+    fd_ = -1;
+    if (!segment_) return ok;
+
+    // 다 쓴 세그먼트만 manifest에 올린다 (읽는 쪽은 쓰는 중인 파일을 보지 않음)
+    if (!ok || count_ == 0) { remove_with_index(file_); return ok; }
+    const TopologyDB db(dbPath_);
+    DBLock lock(db.lockPath());
+    if (!lock.ok()) return false;
+    const int mf = ::open(db.manifestPath().c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (mf < 0) return false;
+    const std::string line = std::filesystem::path(file_).filename().string() + "\n";
+    const bool reg = write_all(mf, line.data(), line.size());
+    ::close(mf);
+    return reg;
+}
+
+// ===== ✅ 중복제거 구현 =====
+// 외부 메모리 + 병렬 (TopologyDBDedupe). 실패하면 0을 돌려주고 원본은 그대로
+int TopologyDB::dedupeByContentHash(bool keep_last) const {
+    if (!compact()) return 0;
+    topodb_dedupe::Options opt;
+    opt.keepLast = keep_last;
+    const long removed = topodb_dedupe::run(path_, topodb_dedupe::Key::Content, opt);
+    if (removed > 0) rebuildIndex();   // 오프셋이 전부 바뀐다
+    return removed > 0 ? (int)removed : 0;
+}
+
+int TopologyDB::dedupeByName(bool keep_last) const {
+    if (!compact()) return 0;
+    topodb_dedupe::Options opt;
+    opt.keepLast = keep_last;
+    const long removed = topodb_dedupe::run(path_, topodb_dedupe::Key::Name, opt);
+    if (removed > 0) rebuildIndex();
+    return removed > 0 ? (int)removed : 0;
+}
+
+// ===== 형식 변환 =====
+// 커서로 흘려 쓴다 (전체를 올리지 않음). 세그먼트도 포함
+bool TopologyDB::exportBinary(const std::string& binPath) const{
+    TopologyDBBinWriter w(binPath);
+    Topology T;
+    for (const auto& file : parts()) {
+        TopologyCursor cur = TopologyCursor::openDB(file);
+        while (cur.next(T)) if (!w.add(T, cur.name())) return false;
+    }
+    return w.close();
+}
+
+bool TopologyDB::exportText(const std::string& textPath) const{
+    AtomicOutFile f(textPath);
+    if (!f.ok()) return false;
+    std::string buf;
+    Topology T;
+    for (const auto& file : parts()) {
+        TopologyCursor cur = TopologyCursor::openDB(file);
+        while (cur.next(T)){
+            appendRecord(buf, T);
+            if (buf.size() >= (1u << 20)) { f.stream().write(buf.data(), (std::streamsize)buf.size()); buf.clear(); }
+        }
+    }
+    f.stream().write(buf.data(), (std::streamsize)buf.size());
+    return f.commit();
+}
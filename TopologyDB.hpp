@@ -1,9 +1,12 @@
 // TopologyDB.hpp
 #pragma once
 #include "Topology.h"
+#include "TopologyDBIndex.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
+#include <cstdint>
 
 class TopologyDB {
 public:
@@ -12,28 +15,89 @@ public:
         Topology    topo;
     };
 
+    class Writer;
+
     explicit TopologyDB(std::string path);
 
+    // 파일 형식: 텍스트(기존, append 가능) 또는 바이너리(TopologyDBBin, mmap 읽기 전용).
+    // 앞 8바이트로 판별하며, 읽기/중복제거는 두 형식 모두 같은 API
+    bool isBinary() const;
+
+    // 세그먼트: 동시에 쓰는 writer마다 자기 파일(<db>.seg/*.db)에 쓰고, 닫을 때 <db>.manifest에 등록한다.
+    // 읽기(loadAll/loadByName/contains*/export*)는 본 파일 + 등록된 세그먼트를 한 DB로 본다
+    std::vector<std::string> parts() const;
+    // 세그먼트를 본 파일로 합친다 (본 파일 형식 유지, 없으면 텍스트). 다른 writer가 닫는 동안은 잠금으로 기다린다
+    bool compact() const;
+
+    // 바이너리 DB에는 false (변환은 exportText/exportBinary로)
     bool append(const Topology& T) const;
+    // 묶어 쓰는 writer (bufBytes마다 write 한 번).
+    //   writer():        본 텍스트 파일에 바로 붙인다 (writer 하나만)
+    //   segmentWriter(): 자기 세그먼트에 쓴다 (여러 스레드/프로세스 동시에 가능)
+    Writer writer(std::size_t bufBytes = 1u << 20) const;
+    Writer segmentWriter(std::size_t bufBytes = 1u << 20) const;
+
     std::vector<Record> loadAll() const;
+    // 사이드카 인덱스(<db>.idx, TopologyDBIndex)로 O(log n) 조회. 없거나 낡았으면 한 번 다시 만든다
     bool loadByName(const std::string& name, Topology& out) const;
+    bool containsName(const std::string& name) const;
+    // 이름은 보지 않고 구조만 같은 레코드가 있는지
+    bool containsContent(const Topology& T) const;
+    bool rebuildIndex() const;
 
-    // ✅ 추가: 중복제거
+    // ✅ 추가: 중복제거 (흘려 읽기 + 해시 파티션 spill, 메모리 상한 있음). 세그먼트가 있으면 먼저 compact
     // 같은 payload(내용)인 레코드 제거. keep_last=true면 가장 마지막 것만 유지
     int  dedupeByContentHash(bool keep_last=false) const;
 
     // 같은 name인 레코드 제거. keep_last=true면 가장 마지막 것만 유지
     int  dedupeByName(bool keep_last=false) const;
 
+    // 형식 변환 (원본 형식과 무관, 대상은 원자적으로 교체)
+    bool exportBinary(const std::string& binPath) const;
+    bool exportText(const std::string& textPath) const;
+
     static std::string serializeCanonical(const Topology& T);
     static bool        deserializeCanonical(std::istream& in, int nLines, Topology& out);
+    // "name\tN\n" + payload 를 out 뒤에 붙인다 (스트림 없이 to_chars)
+    static void        appendRecord(std::string& out, const Topology& T);
 
 private:
     std::string path_;
-    static int  countLines(const std::string& s);
 
-    // 내부 유틸 (헤더 비공개 static)
-    static std::string cheapHashHex(const std::string& s);
-    static bool writeFileAtomic(const std::string& path, const std::string& content);
+    std::string manifestPath() const { return path_ + ".manifest"; }
+    std::string segmentDir() const   { return path_ + ".seg"; }
+    std::string lockPath() const     { return path_ + ".lock"; }
 };
 
+// 레코드를 버퍼에 모았다가 한 번의 write로 커밋한다 (group commit).
+// 인덱스가 맞아 있으면 커밋마다 항목을 한꺼번에 붙인다. 소멸 시 close()
+class TopologyDB::Writer {
+public:
+    Writer() = default;
+    Writer(Writer&& o) noexcept { *this = std::move(o); }
+    Writer& operator=(Writer&& o) noexcept;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer() { close(); }
+
+    bool ok() const noexcept { return fd_ >= 0; }
+    bool add(const Topology& T);
+    bool flush();
+    // 마지막 flush, 세그먼트면 manifest에 등록
+    bool close();
+
+    std::size_t        count() const noexcept { return count_; }
+    const std::string& file() const noexcept { return file_; }
+
+private:
+    friend class TopologyDB;
+    bool open(std::string dbPath, std::string file, bool segment, std::size_t bufBytes);
+
+    std::string   dbPath_, file_;
+    bool          segment_ = false;
+    int           fd_ = -1;
+    std::size_t   limit_ = 0, count_ = 0;
+    std::uint64_t bytes_ = 0;           // 파일에 이미 커밋된 크기
+    std::string   buf_;
+    std::vector<TopologyDBIndex::Entry> pending_;   // 커밋 대기 인덱스 항목
+};
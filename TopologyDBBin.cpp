@@ -0,0 +1,167 @@
+// TopologyDBBin.cpp
+#include "TopologyDBBin.hpp"
+#include <cstring>
+#include <filesystem>
+
+using namespace topodb_bin;
+
+// ===== 레코드 뷰 =====
+void TopologyRecordView::decode(Topology& out) const {
+    out.Initialize();
+    const int nB = p_[1], nSide = p_[2], nInst = p_[3], nL = p_[4], nS = p_[5], nI = p_[6];
+
+    out.block.resize(nB);
+    for (int k = 0; k < nB; ++k) out.block[k] = block(k);
+    out.side_links.resize(nSide);
+    for (int k = 0; k < nSide; ++k) out.side_links[k].param = sideParam(k);
+    out.instantons.resize(nInst);
+    for (int k = 0; k < nInst; ++k) out.instantons[k].param = instantonParam(k);
+
+    const std::int32_t* e = p_ + lWord();
+    out.l_connection.resize(nL);
+    for (int k = 0; k < nL; ++k, e += 2) out.l_connection[k] = {e[0], e[1]};
+    out.s_connection.resize(nS);
+    for (int k = 0; k < nS; ++k, e += 2) out.s_connection[k] = {e[0], e[1]};
+    out.i_connection.resize(nI);
+    for (int k = 0; k < nI; ++k, e += 2) out.i_connection[k] = {e[0], e[1]};
+
+    if (p_[0] > 0) out.name = std::string(name());
+}
+
+// ===== 리더 =====
+bool TopologyDBFile::isBinary(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char m[sizeof kMagic];
+    return in.read(m, sizeof m) && std::memcmp(m, kMagic, sizeof m) == 0;
+}
+
+bool TopologyDBFile::open(const std::string& path) {
+    hdr_ = nullptr;
+    offsets_ = nullptr;
+    err_ = nullptr;
+    if (!map_.open(path)) { err_ = "cannot map file"; return false; }
+
+    const std::size_t n = map_.size();
+    auto fail = [&](const char* why){ err_ = why; map_.close(); return false; };
+    if (n < kHeaderSize) return fail("truncated header");
+
+    const Header* h = reinterpret_cast<const Header*>(map_.data());
+    if (std::memcmp(h->magic, kMagic, sizeof kMagic) != 0) return fail("bad magic");
+    if (h->version != kVersion || h->bom != kBom) return fail("unsupported version or byte order");
+    if (h->offsetsPos % 8 || h->offsetsPos > n || (n - h->offsetsPos) / 8 < h->count + 1) return fail("truncated offset table");
+    if (h->recordsPos < kHeaderSize || h->recordsPos % 4 || h->recordsPos > h->offsetsPos) return fail("bad record area");
+
+    // 오프셋마다: 4바이트 정렬, 줄지 않음, 레코드 영역 안, 레코드는 고정부(kFixedWords) 이상
+    const std::uint64_t* off = reinterpret_cast<const std::uint64_t*>(map_.data() + h->offsetsPos);
+    if (off[0] != h->recordsPos || off[h->count] > h->offsetsPos) return fail("offset table out of range");
+    for (std::uint64_t i = 0; i < h->count; ++i)
+        if (off[i + 1] % 4 || off[i + 1] < off[i] || off[i + 1] - off[i] < kFixedWords * 4)
+            return fail("bad record offset");
+
+    hdr_ = h;
+    offsets_ = off;
+    return true;
+}
+
+bool TopologyDBFile::valid(std::size_t i) const noexcept {
+    if (i >= size()) return false;
+    const std::int32_t* p = reinterpret_cast<const std::int32_t*>(map_.data() + offsets_[i]);
+    const std::uint64_t span = (offsets_[i + 1] - offsets_[i]) / 4;   // open에서 >= kFixedWords
+    for (int k = 0; k < kFixedWords; ++k) if (p[k] < 0) return false;
+    // 개수는 int32라 합쳐도 u64를 넘지 않는다
+    const std::uint64_t words = kFixedWords + 2 * (std::uint64_t)p[1] + (std::uint64_t)p[2] + (std::uint64_t)p[3]
+                              + 2 * ((std::uint64_t)p[4] + (std::uint64_t)p[5] + (std::uint64_t)p[6])
+                              + ((std::uint64_t)p[0] + 3) / 4;
+    if (words > span) return false;
+    for (int k = 0; k < p[1]; ++k)
+        if ((std::uint32_t)p[kFixedWords + 2 * k] > (std::uint32_t)LKind::I) return false;   // 블록 종류
+    return true;
+}
+
+std::size_t TopologyDBFile::indexOf(std::uint64_t offset) const noexcept {
+    const std::size_t n = size();
+    std::size_t lo = 0, hi = n;
+    while (lo < hi) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (offsets_[mid] < offset) lo = mid + 1; else hi = mid;
+    }
+    return (lo < n && offsets_[lo] == offset) ? lo : n;
+}
+
+// ===== 작성기 =====
+TopologyDBBinWriter::TopologyDBBinWriter(std::string path) : path_(std::move(path)) {
+    const auto p = std::filesystem::path(path_);
+    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+    tmp_ = path_ + ".tmp";
+    out_.open(tmp_, std::ios::binary | std::ios::trunc);
+    Header h{};   // 자리만 잡고 close()에서 다시 쓴다
+    out_.write(reinterpret_cast<const char*>(&h), sizeof h);
+    pos_ = sizeof h;
+}
+
+TopologyDBBinWriter::~TopologyDBBinWriter() {
+    if (!closed_) close();
+}
+
+bool TopologyDBBinWriter::add(const Topology& T, std::string_view name) {
+    if (!out_) return false;
+    if (name.empty()) name = T.name.str();
+
+    buf_.clear();
+    buf_.push_back((std::int32_t)name.size());
+    buf_.push_back((std::int32_t)T.block.size());
+    buf_.push_back((std::int32_t)T.side_links.size());
+    buf_.push_back((std::int32_t)T.instantons.size());
+    buf_.push_back((std::int32_t)T.l_connection.size());
+    buf_.push_back((std::int32_t)T.s_connection.size());
+    buf_.push_back((std::int32_t)T.i_connection.size());
+    for (const auto& b : T.block)        { buf_.push_back((std::int32_t)b.kind); buf_.push_back(b.param); }
+    for (const auto& s : T.side_links)   buf_.push_back(s.param);
+    for (const auto& i : T.instantons)   buf_.push_back(i.param);
+    for (const auto& e : T.l_connection) { buf_.push_back(e.u); buf_.push_back(e.v); }
+    for (const auto& e : T.s_connection) { buf_.push_back(e.u); buf_.push_back(e.v); }
+    for (const auto& e : T.i_connection) { buf_.push_back(e.u); buf_.push_back(e.v); }
+
+    const std::size_t nameAt = buf_.size();
+    buf_.resize(nameAt + (name.size() + 3) / 4, 0);
+    if (!name.empty()) std::memcpy(buf_.data() + nameAt, name.data(), name.size());
+
+    offsets_.push_back(pos_);
+    const std::size_t bytes = buf_.size() * sizeof(std::int32_t);
+    out_.write(reinterpret_cast<const char*>(buf_.data()), (std::streamsize)bytes);
+    pos_ += bytes;
+    return (bool)out_;
+}
+
+bool TopologyDBBinWriter::close() {
+    if (closed_) return false;
+    closed_ = true;
+    if (!out_) { out_.close(); std::filesystem::remove(tmp_); return false; }
+
+    // 오프셋 표는 8바이트 정렬
+    const std::uint64_t pad = (8 - pos_ % 8) % 8;
+    static const char zeros[8] = {};
+    out_.write(zeros, (std::streamsize)pad);
+    const std::uint64_t offsetsPos = pos_ + pad;
+
+    const std::uint64_t end = pos_;
+    out_.write(reinterpret_cast<const char*>(offsets_.data()), (std::streamsize)(offsets_.size() * 8));
+    out_.write(reinterpret_cast<const char*>(&end), 8);
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version    = kVersion;
+    h.bom        = kBom;
+    h.count      = offsets_.size();
+    h.recordsPos = kHeaderSize;
+    h.offsetsPos = offsetsPos;
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out_.close();
+    if (!out_) { std::filesystem::remove(tmp_); return false; }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_, path_, ec);
+    if (ec) { std::filesystem::remove(tmp_, ec); return false; }
+    return true;
+}
@@ -0,0 +1,136 @@
+// TopologyDBBin.hpp
+#pragma once
+#include "Topology.h"
+#include "MappedFile.hpp"
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <cstdint>
+#include <vector>
+
+// 바이너리 TopologyDB: mmap으로 열고 레코드를 복사 없이 본다.
+// 레이아웃 (리틀 엔디언, 모든 영역 4바이트 정렬):
+//   [헤더 48B] magic "TOPODB\x01\0" | u32 version | u32 bom(0x01020304)
+//              | u64 count | u64 recordsPos | u64 offsetsPos | u64 reserved
+//   [레코드 영역] 레코드마다 int32 열
+//       nameLen nB nSide nInst nL nS nI
+//       (kind,param) x nB | side param x nSide | inst param x nInst
+//       (u,v) x nL | (u,v) x nS | (u,v) x nI | 이름 바이트 (4바이트로 패딩)
+//     nL = 0 이면 암시적 체인 (Topology와 같은 규약)
+//   [오프셋 표] u64 x (count+1): 레코드 시작 위치 (파일 기준), 마지막은 레코드 영역 끝
+namespace topodb_bin {
+inline constexpr char          kMagic[8] = {'T','O','P','O','D','B','\x01','\0'};
+inline constexpr std::uint32_t kVersion  = 1;
+inline constexpr std::uint32_t kBom      = 0x01020304u;
+inline constexpr std::size_t   kHeaderSize = 48;
+inline constexpr int           kFixedWords = 7;
+
+struct Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t bom;
+    std::uint64_t count;
+    std::uint64_t recordsPos;
+    std::uint64_t offsetsPos;
+    std::uint64_t reserved;
+};
+static_assert(sizeof(Header) == kHeaderSize, "header layout");
+}
+
+// 레코드 하나의 읽기 전용 뷰 (매핑된 메모리를 가리킴; TopologyDBFile보다 오래 쓰지 말 것)
+class TopologyRecordView {
+public:
+    TopologyRecordView() = default;
+    explicit TopologyRecordView(const std::int32_t* p) noexcept : p_(p) {}
+
+    std::string_view name() const noexcept {
+        return {reinterpret_cast<const char*>(p_ + nameWord()), (std::size_t)p_[0]};
+    }
+    int blockCount()    const noexcept { return p_[1]; }
+    int sideCount()     const noexcept { return p_[2]; }
+    int instantonCount()const noexcept { return p_[3]; }
+    bool isChain()      const noexcept { return p_[4] == 0; }
+
+    Block block(int k) const noexcept {
+        const std::int32_t* b = p_ + topodb_bin::kFixedWords + 2*k;
+        return Block{(LKind)b[0], (int)b[1]};
+    }
+    int sideParam(int k)      const noexcept { return p_[sideWord() + k]; }
+    int instantonParam(int k) const noexcept { return p_[instWord() + k]; }
+
+    // 재사용하는 Topology에 풀기 (inline 버퍼 안이면 할당 없음; 이름은 인턴)
+    void decode(Topology& out) const;
+
+    // 레코드 전체 크기 (int32 단위)
+    std::size_t words() const noexcept { return nameWord() + ((std::size_t)p_[0] + 3) / 4; }
+
+private:
+    std::size_t sideWord() const noexcept { return topodb_bin::kFixedWords + 2*(std::size_t)p_[1]; }
+    std::size_t instWord() const noexcept { return sideWord() + (std::size_t)p_[2]; }
+    std::size_t lWord()    const noexcept { return instWord() + (std::size_t)p_[3]; }
+    std::size_t sWord()    const noexcept { return lWord() + 2*(std::size_t)p_[4]; }
+    std::size_t iWord()    const noexcept { return sWord() + 2*(std::size_t)p_[5]; }
+    std::size_t nameWord() const noexcept { return iWord() + 2*(std::size_t)p_[6]; }
+
+    const std::int32_t* p_ = nullptr;
+};
+
+// mmap 리더
+class TopologyDBFile {
+public:
+    TopologyDBFile() = default;
+    explicit TopologyDBFile(const std::string& path) { open(path); }
+
+    // 헤더 + 오프셋 표 전체 검사 (정렬, 증가, 레코드 영역 안, 레코드마다 고정부 이상). 실패하면 false, 이유는 error()
+    bool open(const std::string& path);
+    const char* error() const noexcept { return err_; }
+    bool is_open() const noexcept { return map_.is_open() && hdr_ != nullptr; }
+
+    // 앞 8바이트만 보고 바이너리 DB인지
+    static bool isBinary(const std::string& path);
+
+    std::size_t size() const noexcept { return hdr_ ? (std::size_t)hdr_->count : 0; }
+    TopologyRecordView operator[](std::size_t i) const noexcept {
+        return TopologyRecordView(reinterpret_cast<const std::int32_t*>(map_.data() + offsets_[i]));
+    }
+    // 레코드 i의 머리(개수들, 이름 길이)가 음수가 아니고 [off[i], off[i+1]) 안에 들어가는지.
+    // 뷰의 접근자는 검사하지 않으므로 믿을 수 없는 파일은 이것을 먼저 본다 (TopologyCursor가 한다)
+    bool valid(std::size_t i) const noexcept;
+    std::uint64_t offsetOf(std::size_t i) const noexcept { return offsets_[i]; }
+    // 레코드 시작 오프셋 -> 번호 (레코드 시작이 아니면 size())
+    std::size_t indexOf(std::uint64_t offset) const noexcept;
+
+    void adviseSequential() const noexcept { map_.adviseSequential(); }
+
+private:
+    MappedFile                          map_;
+    const topodb_bin::Header*           hdr_ = nullptr;
+    const std::uint64_t*                offsets_ = nullptr;
+    const char*                         err_ = nullptr;
+};
+
+// 순차 작성기: 레코드를 흘려 쓰고 close()에서 오프셋 표와 헤더를 채운 뒤 rename (원자적)
+class TopologyDBBinWriter {
+public:
+    explicit TopologyDBBinWriter(std::string path);
+    ~TopologyDBBinWriter();
+
+    TopologyDBBinWriter(const TopologyDBBinWriter&) = delete;
+    TopologyDBBinWriter& operator=(const TopologyDBBinWriter&) = delete;
+
+    bool good() const noexcept { return (bool)out_; }
+
+    // name이 비어 있으면 T.name
+    bool add(const Topology& T, std::string_view name = {});
+    bool close();
+
+    std::size_t count() const noexcept { return offsets_.size(); }
+
+private:
+    std::string                path_, tmp_;
+    std::ofstream              out_;
+    std::vector<std::uint64_t> offsets_;
+    std::vector<std::int32_t>  buf_;
+    std::uint64_t              pos_ = 0;
+    bool                       closed_ = false;
+};
@@ -0,0 +1,359 @@
+// TopologyDBDedupe.cpp
+#include "TopologyDBDedupe.hpp"
+#include "TopologyDB.hpp"
+#include "TopologyDBBin.hpp"
+#include "TopologyCursor.hpp"
+#include "FileUtil.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace topodb_dedupe {
+namespace {
+
+// ===== 128-bit 해시 (murmur3 x64_128 단어 단위 변형) =====
+struct Hash128 { std::uint64_t lo, hi; };
+
+inline std::uint64_t rotl(std::uint64_t x, int r){ return (x << r) | (x >> (64 - r)); }
+inline std::uint64_t fmix(std::uint64_t x){
+    x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33; return x;
+}
+
+class Hasher128 {
+public:
+    void word(std::uint64_t k){
+        std::uint64_t k1 = rotl(k * c1, 31) * c2;
+        h1_ ^= k1; h1_ = rotl(h1_, 27) + h2_; h1_ = h1_ * 5 + 0x52dce729;
+        std::uint64_t k2 = rotl(k * c2, 33) * c1;
+        h2_ ^= k2; h2_ = rotl(h2_, 31) + h1_; h2_ = h2_ * 5 + 0x38495ab5;
+        ++n_;
+    }
+    void pair(int a, int b){ word((std::uint64_t)(std::uint32_t)a << 32 | (std::uint32_t)b); }
+    void bytes(std::string_view s){
+        std::size_t k = 0;
+        for (; k + 8 <= s.size(); k += 8) { std::uint64_t w; std::memcpy(&w, s.data() + k, 8); word(w); }
+        std::uint64_t w = 0;
+        std::memcpy(&w, s.data() + k, s.size() - k);
+        word(w ^ ((std::uint64_t)s.size() << 56));   // 길이까지 넣어 경계를 구분
+    }
+    Hash128 finish() const {
+        std::uint64_t a = h1_ ^ n_, b = h2_ ^ n_;
+        a += b; b += a;
+        a = fmix(a); b = fmix(b);
+        a += b; b += a;
+        return {a, b};
+    }
+private:
+    static constexpr std::uint64_t c1 = 0x87c37b91114253d5ULL;
+    static constexpr std::uint64_t c2 = 0x4cf5ad432745937fULL;
+    std::uint64_t h1_ = 0x9e3779b97f4a7c15ULL, h2_ = 0x6a09e667f3bcc909ULL, n_ = 0;
+};
+
+// serializeCanonical이 쓰는 필드 그대로 (문자열로 만들지 않음)
+Hash128 content_hash(const Topology& T){
+    Hasher128 h;
+    h.bytes(T.name.str());
+    h.pair((int)T.block.size(), (int)T.side_links.size());
+    h.pair((int)T.instantons.size(), T.interiorEdgeCount());
+    h.pair((int)T.s_connection.size(), (int)T.i_connection.size());
+    for (const auto& b : T.block)      h.pair((int)b.kind, b.param);
+    for (const auto& s : T.side_links) h.pair(s.param, 0);
+    for (const auto& i : T.instantons) h.pair(i.param, 1);
+    for (int k = 0; k < T.interiorEdgeCount(); ++k) { const auto e = T.interiorEdge(k); h.pair(e.u, e.v); }
+    for (const auto& e : T.s_connection) h.pair(e.u, e.v);
+    for (const auto& e : T.i_connection) h.pair(e.u, e.v);
+    return h.finish();
+}
+
+Hash128 name_hash(std::string_view name){
+    Hasher128 h;
+    h.bytes(name);
+    return h.finish();
+}
+
+// ===== 파티션 =====
+struct Entry {
+    std::uint64_t lo, hi;
+    std::uint64_t seq;      // 읽은 순서 (풀린 레코드만 센다)
+};
+
+struct Partition {
+    std::mutex         mu;
+    std::vector<Entry> mem;
+    std::string        spill;   // 비어 있으면 아직 메모리에만 있음
+};
+
+struct Batch {
+    std::uint64_t            first = 0;
+    std::size_t              n = 0;
+    std::vector<Topology>    topo;    // 용량 재사용
+    std::vector<std::string> names;   // Key::Name 일 때만
+};
+
+constexpr std::size_t kBatch    = 2048;
+constexpr std::size_t kMaxParts = 1024;
+
+inline std::size_t pow2_ceil(std::size_t x){ std::size_t p = 1; while (p < x) p <<= 1; return p; }
+inline int log2_exact(std::size_t p){ int b = 0; while ((std::size_t(1) << b) < p) ++b; return b; }
+
+class Dedupe {
+public:
+    Dedupe(const std::string& dbPath, Key key, const Options& opt)
+        : path_(dbPath), key_(key), opt_(opt), spillDir_(dbPath + ".dedupe")
+    {
+        threads_ = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+
+        // 레코드 수를 모르니 파일 크기로 어림한다 (레코드 >= 32바이트)
+        std::error_code ec;
+        const std::size_t fileBytes = (std::size_t)std::filesystem::file_size(dbPath, ec);
+        const std::size_t est       = std::max<std::size_t>(1, ec ? 1 : fileBytes / 32);
+        const std::size_t target    = std::max<std::size_t>(1u << 20, opt.memBytes / (2 * threads_));
+        nParts_   = std::min(kMaxParts, pow2_ceil((est * sizeof(Entry) + target - 1) / target));
+        partBits_ = log2_exact(nParts_);
+        partCap_  = std::max<std::size_t>(1024, opt.memBytes / 2 / nParts_ / sizeof(Entry));
+        // 워커마다 파티션 수만큼 작은 버퍼: 해시 단계에는 정렬 몫(나머지 절반)이 비어 있으니 거기서 나눠 쓴다
+        const std::size_t localAll = (std::size_t)threads_ * nParts_ * sizeof(Entry);
+        localCap_ = std::clamp<std::size_t>(opt.memBytes / 2 / localAll, 1, std::min<std::size_t>(256, partCap_));
+        parts_    = std::make_unique<Partition[]>(nParts_);
+    }
+
+    ~Dedupe(){
+        std::error_code ec;
+        std::filesystem::remove_all(spillDir_, ec);
+    }
+
+    long run(){
+        if (!hashPass()) return -1;
+        const std::uint64_t kept = selectPass();
+        if (failed_) return -1;
+        const long removed = (long)(seen_ - kept);
+        if (removed == 0 && bad_ == 0) return 0;   // 바뀔 게 없으면 다시 쓰지 않는다
+        return writePass() ? removed : -1;
+    }
+
+private:
+    std::size_t partOf(const Entry& e) const { return partBits_ ? (std::size_t)(e.hi >> (64 - partBits_)) : 0; }
+
+    // ===== 1) 해시 + 파티션 =====
+    bool hashPass(){
+        TopologyCursor cur = TopologyCursor::openDB(path_);
+        if (!cur.ok()) return false;
+
+        std::mutex mu;
+        std::condition_variable workCv, spaceCv;
+        std::deque<std::unique_ptr<Batch>> work, spare;
+        bool done = false;
+        const std::size_t maxQueued = 2 * threads_;
+
+        auto worker = [&]{
+            std::vector<std::vector<Entry>> local(nParts_);
+            for (;;) {
+                std::unique_ptr<Batch> b;
+                {
+                    std::unique_lock<std::mutex> lk(mu);
+                    workCv.wait(lk, [&]{ return done || !work.empty(); });
+                    if (work.empty()) break;
+                    b = std::move(work.front());
+                    work.pop_front();
+                }
+                spaceCv.notify_one();
+                for (std::size_t k = 0; k < b->n; ++k) {
+                    const Hash128 h = key_ == Key::Name ? name_hash(b->names[k]) : content_hash(b->topo[k]);
+                    const Entry e{h.lo, h.hi, b->first + k};
+                    auto& buf = local[partOf(e)];
+                    buf.push_back(e);
+                    if (buf.size() >= localCap_) { flush(partOf(e), buf); buf.clear(); }
+                }
+                {
+                    std::lock_guard<std::mutex> lk(mu);
+                    spare.push_back(std::move(b));
+                }
+            }
+            for (std::size_t p = 0; p < nParts_; ++p) if (!local[p].empty()) flush(p, local[p]);
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads_; ++t) pool.emplace_back(worker);
+
+        auto submit = [&](std::unique_ptr<Batch> b){
+            std::unique_lock<std::mutex> lk(mu);
+            spaceCv.wait(lk, [&]{ return work.size() < maxQueued; });
+            work.push_back(std::move(b));
+            lk.unlock();
+            workCv.notify_one();
+        };
+        auto fresh = [&]{
+            std::unique_ptr<Batch> b;
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                if (!spare.empty()) { b = std::move(spare.back()); spare.pop_back(); }
+            }
+            if (!b) b = std::make_unique<Batch>();
+            b->n = 0;
+            b->first = seen_;
+            return b;
+        };
+
+        std::unique_ptr<Batch> b = fresh();
+        while (cur.advance()) {
+            if (b->topo.size() <= b->n) b->topo.emplace_back();
+            if (!cur.decode(b->topo[b->n])) { ++bad_; continue; }   // loadAll처럼 깨진 레코드는 버린다
+            if (key_ == Key::Name) {
+                if (b->names.size() <= b->n) b->names.emplace_back();
+                b->names[b->n].assign(cur.name());
+            }
+            ++b->n;
+            ++seen_;
+            if (b->n == kBatch) { submit(std::move(b)); b = fresh(); }
+        }
+        if (b->n) submit(std::move(b));
+
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            done = true;
+        }
+        workCv.notify_all();
+        for (auto& t : pool) t.join();
+        return !failed_;
+    }
+
+    // 파티션으로 넘긴다: 메모리 상한을 넘으면 spill 파일에 덧붙인다
+    void flush(std::size_t p, const std::vector<Entry>& buf){
+        Partition& part = parts_[p];
+        std::lock_guard<std::mutex> lk(part.mu);
+        if (part.spill.empty() && part.mem.size() + buf.size() <= partCap_) {
+            part.mem.insert(part.mem.end(), buf.begin(), buf.end());
+            return;
+        }
+        if (part.spill.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(spillDir_, ec);
+            part.spill = spillDir_ + "/part-" + std::to_string(p) + ".bin";
+        }
+        std::FILE* f = std::fopen(part.spill.c_str(), "ab");
+        bool ok = f != nullptr;
+        if (ok && !part.mem.empty()) ok = std::fwrite(part.mem.data(), sizeof(Entry), part.mem.size(), f) == part.mem.size();
+        if (ok) ok = std::fwrite(buf.data(), sizeof(Entry), buf.size(), f) == buf.size();
+        if (f && std::fclose(f) != 0) ok = false;
+        if (!ok) failed_ = true;
+        part.mem.clear();
+        part.mem.shrink_to_fit();
+    }
+
+    // ===== 2) 파티션마다 남길 seq 고르기 =====
+    std::uint64_t selectPass(){
+        const std::size_t words = (seen_ + 63) / 64;
+        keep_ = std::make_unique<std::atomic<std::uint64_t>[]>(words);
+        for (std::size_t w = 0; w < words; ++w) keep_[w].store(0, std::memory_order_relaxed);
+
+        std::atomic<std::size_t>   next{0};
+        std::atomic<std::uint64_t> kept{0};
+        auto worker = [&]{
+            std::vector<Entry> v;
+            for (std::size_t p; (p = next.fetch_add(1)) < nParts_; ) {
+                Partition& part = parts_[p];
+                v.swap(part.mem);
+                std::vector<Entry>().swap(part.mem);
+                if (!part.spill.empty() && !readSpill(part.spill, v)) { failed_ = true; continue; }
+
+                std::sort(v.begin(), v.end(), [](const Entry& a, const Entry& b){
+                    if (a.lo != b.lo) return a.lo < b.lo;
+                    if (a.hi != b.hi) return a.hi < b.hi;
+                    return a.seq < b.seq;
+                });
+                std::uint64_t n = 0;
+                for (std::size_t i = 0; i < v.size(); ) {
+                    std::size_t j = i + 1;
+                    while (j < v.size() && v[j].lo == v[i].lo && v[j].hi == v[i].hi) ++j;
+                    const std::uint64_t s = opt_.keepLast ? v[j - 1].seq : v[i].seq;
+                    keep_[s >> 6].fetch_or(std::uint64_t(1) << (s & 63), std::memory_order_relaxed);
+                    ++n;
+                    i = j;
+                }
+                kept += n;
+                v.clear();
+            }
+        };
+        std::vector<std::thread> pool;
+        const unsigned nt = (unsigned)std::min<std::size_t>(threads_, nParts_);
+        for (unsigned t = 0; t < nt; ++t) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
+        return kept;
+    }
+
+    static bool readSpill(const std::string& path, std::vector<Entry>& v){
+        std::error_code ec;
+        const std::size_t n = (std::size_t)std::filesystem::file_size(path, ec) / sizeof(Entry);
+        if (ec) return false;
+        const std::size_t at = v.size();
+        v.resize(at + n);
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        const bool ok = std::fread(v.data() + at, sizeof(Entry), n, f) == n;
+        std::fclose(f);
+        std::filesystem::remove(path, ec);
+        return ok;
+    }
+
+    bool kept(std::uint64_t seq) const {
+        return (keep_[seq >> 6].load(std::memory_order_relaxed) >> (seq & 63)) & 1;
+    }
+
+    // ===== 3) 원래 순서대로 다시 쓰기 (원본 형식 유지) =====
+    bool writePass(){
+        TopologyCursor cur = TopologyCursor::openDB(path_);
+        if (!cur.ok()) return false;
+        Topology T;
+        std::uint64_t seq = 0;
+
+        if (cur.format() == TopologyCursor::Format::BinaryDB) {
+            TopologyDBBinWriter w(path_);
+            while (cur.next(T)) if (kept(seq++) && !w.add(T, cur.name())) return false;
+            return w.close();
+        }
+
+        AtomicOutFile f(path_);
+        if (!f.ok()) return false;
+        std::string buf;
+        while (cur.next(T)) {
+            if (!kept(seq++)) continue;
+            TopologyDB::appendRecord(buf, T);
+            if (buf.size() >= (1u << 20)) { f.stream().write(buf.data(), (std::streamsize)buf.size()); buf.clear(); }
+        }
+        f.stream().write(buf.data(), (std::streamsize)buf.size());
+        return f.commit();
+    }
+
+    const std::string path_;
+    const Key         key_;
+    const Options     opt_;
+    const std::string spillDir_;
+
+    unsigned    threads_ = 1;
+    std::size_t nParts_ = 1, partCap_ = 0, localCap_ = 0;
+    int         partBits_ = 0;
+    std::unique_ptr<Partition[]> parts_;
+
+    std::uint64_t seen_ = 0, bad_ = 0;
+    std::atomic<bool> failed_{false};
+    std::unique_ptr<std::atomic<std::uint64_t>[]> keep_;
+};
+
+}
+
+long run(const std::string& dbPath, Key key, const Options& opt){
+    Dedupe d(dbPath, key, opt);
+    return d.run();
+}
+
+}
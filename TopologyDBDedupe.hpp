@@ -0,0 +1,28 @@
+// TopologyDBDedupe.hpp
+#pragma once
+#include <string>
+#include <cstddef>
+
+// TopologyDB 외부 메모리 중복제거 (TopologyDB::dedupeBy* 구현).
+//   1) 커서로 흘려 읽으며 레코드마다 128-bit 키 해시 -> (hash, seq)를 해시 앞 비트로 파티션에 나눈다.
+//      해시는 스레드 풀에서, 파티션 버퍼가 차면 <db>.dedupe/ 아래 spill 파일로 내린다.
+//   2) 파티션마다 독립적으로 정렬해 남길 seq를 고른다 (병렬).
+//   3) 다시 흘려 읽으며 남길 레코드만 원래 순서대로 원자적으로 쓴다 (원본 형식 유지).
+// 메모리는 memBytes + 레코드당 1비트로 묶인다.
+namespace topodb_dedupe {
+
+enum class Key {
+    Content,   // payload 전체 (name: 포함, serializeCanonical과 같은 기준)
+    Name       // 레코드 이름
+};
+
+struct Options {
+    bool        keepLast = false;        // 같은 키면 마지막 것을 남김
+    unsigned    threads  = 0;            // 0: hardware_concurrency
+    std::size_t memBytes = 256u << 20;   // 절반은 파티션 버퍼, 절반은 해시 단계의 워커 버퍼 / 고르기 단계의 정렬
+};
+
+// 지운 레코드 수, 실패하면 -1 (원본은 그대로)
+long run(const std::string& dbPath, Key key, const Options& opt = Options());
+
+}
@@ -0,0 +1,215 @@
+// TopologyDBIndex.cpp
+#include "TopologyDBIndex.hpp"
+#include "TopologyCursor.hpp"
+#include "FileUtil.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+// ===== 내부 유틸 =====
+namespace {
+constexpr char          kIdxMagic[8] = {'T','O','P','O','I','D','X','1'};
+constexpr std::size_t   kIdxHeader   = 32;
+constexpr std::size_t   kCompactMin  = 4096;   // 꼬리가 이보다 크고 정렬부의 1/8을 넘으면 compact
+
+struct IdxHeader {
+    char          magic[8];
+    std::uint64_t dbBytes;
+    std::uint64_t nSorted;
+    std::uint64_t reserved;
+};
+static_assert(sizeof(IdxHeader) == kIdxHeader, "index header layout");
+
+// 64-bit FNV-1a
+struct Fnv {
+    std::uint64_t h = 1469598103934665603ULL;
+    void bytes(const void* p, size_t n){
+        const unsigned char* c = static_cast<const unsigned char*>(p);
+        for (size_t k = 0; k < n; ++k){ h ^= c[k]; h *= 1099511628211ULL; }
+    }
+    void add(int v){ bytes(&v, sizeof v); }
+};
+
+inline std::size_t tailStart(std::size_t nSorted){
+    const std::size_t end = kIdxHeader + nSorted * (sizeof(TopologyDBIndex::Entry) + sizeof(std::uint32_t));
+    return (end + 7) & ~std::size_t(7);
+}
+
+inline std::uint64_t file_bytes(const std::string& path){
+    std::error_code ec;
+    const auto n = std::filesystem::file_size(path, ec);
+    return ec ? 0 : (std::uint64_t)n;
+}
+}
+
+// ===== 해시 =====
+std::uint64_t TopologyDBIndex::nameHash(std::string_view name) noexcept {
+    Fnv f;
+    f.bytes(name.data(), name.size());
+    return f.h;
+}
+
+std::uint64_t TopologyDBIndex::contentHash(const Topology& T) noexcept {
+    Fnv f;
+    f.add((int)T.block.size());
+    for (const auto& b : T.block) { f.add((int)b.kind); f.add(b.param); }
+    f.add((int)T.side_links.size());
+    for (const auto& s : T.side_links) f.add(s.param);
+    f.add((int)T.instantons.size());
+    for (const auto& i : T.instantons) f.add(i.param);
+    f.add(T.interiorEdgeCount());
+    for (int k = 0; k < T.interiorEdgeCount(); ++k) { const auto e = T.interiorEdge(k); f.add(e.u); f.add(e.v); }
+    f.add((int)T.s_connection.size());
+    for (const auto& e : T.s_connection) { f.add(e.u); f.add(e.v); }
+    f.add((int)T.i_connection.size());
+    for (const auto& e : T.i_connection) { f.add(e.u); f.add(e.v); }
+    return f.h;
+}
+
+bool TopologyDBIndex::sameContent(const Topology& a, const Topology& b) noexcept {
+    if (a.block.size() != b.block.size() || a.side_links.size() != b.side_links.size()
+        || a.instantons.size() != b.instantons.size() || a.interiorEdgeCount() != b.interiorEdgeCount()
+        || a.s_connection.size() != b.s_connection.size() || a.i_connection.size() != b.i_connection.size())
+        return false;
+    for (size_t k = 0; k < a.block.size(); ++k)
+        if (a.block[k].kind != b.block[k].kind || a.block[k].param != b.block[k].param) return false;
+    for (size_t k = 0; k < a.side_links.size(); ++k) if (a.side_links[k].param != b.side_links[k].param) return false;
+    for (size_t k = 0; k < a.instantons.size(); ++k) if (a.instantons[k].param != b.instantons[k].param) return false;
+    for (int k = 0; k < a.interiorEdgeCount(); ++k) {
+        const auto x = a.interiorEdge(k), y = b.interiorEdge(k);
+        if (x.u != y.u || x.v != y.v) return false;
+    }
+    for (size_t k = 0; k < a.s_connection.size(); ++k)
+        if (a.s_connection[k].u != b.s_connection[k].u || a.s_connection[k].v != b.s_connection[k].v) return false;
+    for (size_t k = 0; k < a.i_connection.size(); ++k)
+        if (a.i_connection[k].u != b.i_connection[k].u || a.i_connection[k].v != b.i_connection[k].v) return false;
+    return true;
+}
+
+// ===== 열기 =====
+bool TopologyDBIndex::open(const std::string& dbPath) {
+    byName_ = nullptr; byContent_ = nullptr; tail_ = nullptr;
+    nSorted_ = nTail_ = 0;
+    if (!map_.open(pathFor(dbPath))) return false;
+
+    auto fail = [&]{ map_.close(); return false; };
+    const std::size_t n = map_.size();
+    if (n < kIdxHeader) return fail();
+    const IdxHeader* h = reinterpret_cast<const IdxHeader*>(map_.data());
+    if (std::memcmp(h->magic, kIdxMagic, sizeof kIdxMagic) != 0) return fail();
+    if (h->dbBytes != file_bytes(dbPath)) return fail();   // 낡은 인덱스
+
+    const std::size_t ts = tailStart((std::size_t)h->nSorted);
+    if (ts > n || (n - ts) % sizeof(Entry) != 0) return fail();
+
+    nSorted_   = (std::size_t)h->nSorted;
+    nTail_     = (n - ts) / sizeof(Entry);
+    byName_    = reinterpret_cast<const Entry*>(map_.data() + kIdxHeader);
+    byContent_ = reinterpret_cast<const std::uint32_t*>(map_.data() + kIdxHeader + nSorted_ * sizeof(Entry));
+    tail_      = reinterpret_cast<const Entry*>(map_.data() + ts);
+    return true;
+}
+
+bool TopologyDBIndex::openOrRebuild(const std::string& dbPath) {
+    return open(dbPath) || (rebuild(dbPath) && open(dbPath));
+}
+
+// ===== 조회 =====
+void TopologyDBIndex::findName(std::uint64_t h, std::vector<std::uint64_t>& out) const {
+    out.clear();
+    const Entry* it = std::lower_bound(byName_, byName_ + nSorted_, h,
+                                       [](const Entry& e, std::uint64_t k){ return e.name < k; });
+    for (; it != byName_ + nSorted_ && it->name == h; ++it) out.push_back(it->offset);
+    for (std::size_t k = 0; k < nTail_; ++k) if (tail_[k].name == h) out.push_back(tail_[k].offset);
+    std::sort(out.begin(), out.end());
+}
+
+void TopologyDBIndex::findContent(std::uint64_t h, std::vector<std::uint64_t>& out) const {
+    out.clear();
+    const std::uint32_t* it = std::lower_bound(byContent_, byContent_ + nSorted_, h,
+                                               [&](std::uint32_t i, std::uint64_t k){ return byName_[i].content < k; });
+    for (; it != byContent_ + nSorted_ && byName_[*it].content == h; ++it) out.push_back(byName_[*it].offset);
+    for (std::size_t k = 0; k < nTail_; ++k) if (tail_[k].content == h) out.push_back(tail_[k].offset);
+    std::sort(out.begin(), out.end());
+}
+
+// ===== 쓰기 =====
+bool TopologyDBIndex::writeSorted(const std::string& idxPath, std::uint64_t dbBytes, std::vector<Entry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b){
+        return a.name != b.name ? a.name < b.name : a.offset < b.offset;
+    });
+    std::vector<std::uint32_t> byContent(entries.size());
+    for (std::uint32_t i = 0; i < (std::uint32_t)entries.size(); ++i) byContent[i] = i;
+    std::sort(byContent.begin(), byContent.end(), [&](std::uint32_t a, std::uint32_t b){
+        return entries[a].content != entries[b].content ? entries[a].content < entries[b].content
+                                                        : entries[a].offset < entries[b].offset;
+    });
+
+    IdxHeader h{};
+    std::memcpy(h.magic, kIdxMagic, sizeof kIdxMagic);
+    h.dbBytes = dbBytes;
+    h.nSorted = entries.size();
+
+    AtomicOutFile f(idxPath);
+    auto& out = f.stream();
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(Entry)));
+    out.write(reinterpret_cast<const char*>(byContent.data()), (std::streamsize)(byContent.size() * sizeof(std::uint32_t)));
+    static const char zeros[8] = {};
+    const std::size_t written = kIdxHeader + entries.size() * (sizeof(Entry) + sizeof(std::uint32_t));
+    out.write(zeros, (std::streamsize)(tailStart(entries.size()) - written));
+    return f.commit();
+}
+
+bool TopologyDBIndex::rebuild(const std::string& dbPath) {
+    const std::uint64_t dbBytes = file_bytes(dbPath);
+    std::vector<Entry> entries;
+    TopologyCursor cur = TopologyCursor::openDB(dbPath);
+    if (!cur.ok()) return false;
+    Topology T;
+    while (cur.advance()) {
+        if (!cur.decode(T)) continue;
+        entries.push_back(Entry{nameHash(cur.name()), contentHash(T), cur.position()});
+    }
+    return writeSorted(pathFor(dbPath), dbBytes, std::move(entries));
+}
+
+// 꼬리를 정렬부로 합친다 (DB는 다시 읽지 않음)
+bool TopologyDBIndex::compact(const std::string& dbPath) {
+    TopologyDBIndex idx;
+    if (!idx.open(dbPath)) return false;
+    std::vector<Entry> entries(idx.byName_, idx.byName_ + idx.nSorted_);
+    entries.insert(entries.end(), idx.tail_, idx.tail_ + idx.nTail_);
+    const std::uint64_t dbBytes = file_bytes(dbPath);
+    idx.map_.close();
+    return writeSorted(pathFor(dbPath), dbBytes, std::move(entries));
+}
+
+bool TopologyDBIndex::appendEntries(const std::string& dbPath, std::uint64_t oldDbBytes,
+                                    const Entry* e, std::size_t n, std::uint64_t newDbBytes) {
+    const std::string idxPath = pathFor(dbPath);
+    if (!std::filesystem::exists(idxPath)) {
+        if (oldDbBytes != 0) return false;   // 기존 DB: 다음 조회 때 한 번에 만든다
+        return writeSorted(idxPath, newDbBytes, std::vector<Entry>(e, e + n));
+    }
+
+    std::fstream io(idxPath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!io) return false;
+    IdxHeader h{};
+    if (!io.read(reinterpret_cast<char*>(&h), sizeof h)) return false;
+    if (std::memcmp(h.magic, kIdxMagic, sizeof kIdxMagic) != 0 || h.dbBytes != oldDbBytes) return false;
+
+    io.seekp(0, std::ios::end);
+    const std::uint64_t idxBytes = (std::uint64_t)io.tellp();
+    io.write(reinterpret_cast<const char*>(e), (std::streamsize)(n * sizeof(Entry)));
+    h.dbBytes = newDbBytes;
+    io.seekp(0);
+    io.write(reinterpret_cast<const char*>(&h), sizeof h);
+    io.close();
+    if (!io) return false;
+
+    const std::size_t nTail = (idxBytes - tailStart((std::size_t)h.nSorted)) / sizeof(Entry) + n;
+    if (nTail > kCompactMin && nTail * 8 > h.nSorted) return compact(dbPath);
+    return true;
+}
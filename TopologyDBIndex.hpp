@@ -0,0 +1,65 @@
+// TopologyDBIndex.hpp
+#pragma once
+#include "Topology.h"
+#include "MappedFile.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// TopologyDB 사이드카 인덱스 (<db>.idx): 이름 해시 / 내용 해시 -> 레코드 바이트 오프셋.
+// 레이아웃 (리틀 엔디언):
+//   [헤더 32B] magic "TOPOIDX1" | u64 dbBytes (인덱스가 덮는 DB 크기) | u64 nSorted | u64 reserved
+//   [이름순]   Entry x nSorted      (name 해시, 같으면 offset 순)
+//   [내용순]   u32 x nSorted        (이름순 배열의 번호를 content 해시 순으로)
+//   (8바이트 패딩)
+//   [꼬리]     Entry x nTail        (append가 붙인 것, 정렬 안 됨; 커지면 compact)
+// 조회는 이름/내용 각각 이분 탐색 + 꼬리 선형 탐색. 해시 충돌은 호출 쪽이 레코드를 읽어 확인한다.
+// dbBytes가 DB 파일 크기와 다르면 (다른 도구가 DB를 고쳤으면) 낡은 인덱스로 보고 다시 만든다.
+class TopologyDBIndex {
+public:
+    struct Entry {
+        std::uint64_t name;
+        std::uint64_t content;
+        std::uint64_t offset;
+    };
+
+    static std::string pathFor(const std::string& dbPath) { return dbPath + ".idx"; }
+
+    static std::uint64_t nameHash(std::string_view name) noexcept;
+    // 이름 제외 구조만 (블록, 장식, 연결; 암시적/명시적 체인은 같게)
+    static std::uint64_t contentHash(const Topology& T) noexcept;
+    static bool          sameContent(const Topology& a, const Topology& b) noexcept;
+
+    // 인덱스 열기. 없거나 DB 크기와 안 맞으면 false
+    bool open(const std::string& dbPath);
+    // 열고, 안 되면 DB를 한 번 훑어 다시 만든 뒤 연다
+    bool openOrRebuild(const std::string& dbPath);
+
+    std::size_t size() const noexcept { return nSorted_ + nTail_; }
+
+    // 후보 오프셋 (오름차순)
+    void findName(std::uint64_t h, std::vector<std::uint64_t>& out) const;
+    void findContent(std::uint64_t h, std::vector<std::uint64_t>& out) const;
+
+    // DB를 훑어 새로 쓴다 (원자적 교체)
+    static bool rebuild(const std::string& dbPath);
+
+    // append 직후 호출: 인덱스가 oldDbBytes까지 맞으면 꼬리에 붙이고 dbBytes 갱신.
+    // 인덱스가 없고 DB가 비어 있었으면 새로 만든다. 낡았으면 건드리지 않는다 (다음 조회 때 재구축)
+    static bool appendEntries(const std::string& dbPath, std::uint64_t oldDbBytes,
+                              const Entry* e, std::size_t n, std::uint64_t newDbBytes);
+    static bool appendEntry(const std::string& dbPath, std::uint64_t oldDbBytes,
+                            const Entry& e, std::uint64_t newDbBytes)
+    { return appendEntries(dbPath, oldDbBytes, &e, 1, newDbBytes); }
+
+private:
+    static bool writeSorted(const std::string& idxPath, std::uint64_t dbBytes, std::vector<Entry> entries);
+    static bool compact(const std::string& dbPath);
+
+    MappedFile          map_;
+    const Entry*        byName_ = nullptr;
+    const std::uint32_t* byContent_ = nullptr;
+    const Entry*        tail_ = nullptr;
+    std::size_t         nSorted_ = 0, nTail_ = 0;
+};
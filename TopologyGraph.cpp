@@ -0,0 +1,210 @@
+// TopologyGraph.cpp
+#include "TopologyGraph.hpp"
+
+Spec spec_of(LKind k, int param) noexcept {
+    switch (k){
+        case LKind::g: return Spec{Kind::Node,         param};
+        case LKind::L: return Spec{Kind::InteriorLink, param};
+        case LKind::S: return Spec{Kind::SideLink,     param};
+        case LKind::I: return Spec{Kind::SideLink,     param};
+    }
+    return Spec{Kind::Node, param};
+}
+
+// connect(a,b) 자동 포트: a=Right, b=Left
+static inline GlueStatus check_auto(const Spec& a, const Spec& b) noexcept {
+    return TheoryGraph::checkGlue(a.kind, a.param, Port::Right, b.kind, b.param, Port::Left);
+}
+
+// check(a, b): 자동 포트(a=Right, b=Left) 글루잉 판정
+template <class Check>
+static GlueStatus validate_topology_(const Topology& T, Check&& check) noexcept {
+    const int nb = (int)T.block.size();
+    auto blockSpec = [&](int k){ return spec_of(T.block[k].kind, T.block[k].param); };
+    auto deco = [&](int u, int param){ return check(Spec{Kind::SideLink, param}, blockSpec(u)); };
+
+    // 1) 체인 (g/L 본체)
+    for (int k = 0; k < T.interiorEdgeCount(); ++k){
+        const auto e = T.interiorEdge(k);
+        if (e.u < 0 || e.u >= nb || e.v < 0 || e.v >= nb) return GlueStatus::BadIndex;
+        const GlueStatus st = check(blockSpec(e.u), blockSpec(e.v));
+        if (st != GlueStatus::Ok) return st;
+    }
+
+    // 2) side links
+    for (const auto& e : T.s_connection){
+        if (e.u < 0 || e.u >= nb || e.v < 0 || e.v >= (int)T.side_links.size()) return GlueStatus::BadIndex;
+        const GlueStatus st = deco(e.u, T.side_links[e.v].param);
+        if (st != GlueStatus::Ok) return st;
+    }
+
+    // 3) instantons
+    for (const auto& e : T.i_connection){
+        if (e.u < 0 || e.u >= nb || e.v < 0 || e.v >= (int)T.instantons.size()) return GlueStatus::BadIndex;
+        const GlueStatus st = deco(e.u, T.instantons[e.v].param);
+        if (st != GlueStatus::Ok) return st;
+    }
+    return GlueStatus::Ok;
+}
+
+GlueStatus validate_decoration(const Block& node, int decoParam) noexcept {
+    return check_auto(Spec{Kind::SideLink, decoParam}, spec_of(node.kind, node.param));
+}
+
+GlueStatus validate_extension(const Block& last, LKind nextKind, int nextParam) noexcept {
+    return check_auto(spec_of(last.kind, last.param), spec_of(nextKind, nextParam));
+}
+
+GlueStatus validate_topology(const Topology& T) noexcept {
+    return validate_topology_(T, [](const Spec& a, const Spec& b){ return check_auto(a, b); });
+}
+
+static inline GlueStatus check_auto(const RuleSet& R, const Spec& a, const Spec& b) noexcept {
+    return R.checkGlue(a.kind, a.param, Port::Right, b.kind, b.param, Port::Left);
+}
+
+GlueStatus validate_decoration(const Block& node, int decoParam, const RuleSet& rules) noexcept {
+    return check_auto(rules, Spec{Kind::SideLink, decoParam}, spec_of(node.kind, node.param));
+}
+
+GlueStatus validate_topology(const Topology& T, const RuleSet& rules) noexcept {
+    return validate_topology_(T, [&](const Spec& a, const Spec& b){ return check_auto(rules, a, b); });
+}
+
+RuleMask admit_mask(const Topology& T, const RuleSetList& rules){
+    RuleMask m = 0;
+    for (size_t r = 0; r < rules.size(); ++r){
+        if (validate_topology(T, rules[r]) == GlueStatus::Ok && rules[r].bankAdmits(T))
+            m |= RuleMask(1) << r;
+    }
+    return m;
+}
+
+// ========== Shape plan ==========
+template <class A, class B>
+static inline bool same_pairs(const A& a, const B& b) noexcept {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); ++k)
+        if (a[k].u != b[k].u || a[k].v != b[k].v) return false;
+    return true;
+}
+
+bool ShapePlan::matches(const Topology& T) const noexcept {
+    if (T.block.size() != blocks_.size()) return false;
+    for (size_t k = 0; k < blocks_.size(); ++k)
+        if (T.block[k].kind != blocks_[k].kind || T.block[k].param != blocks_[k].param) return false;
+    return T.side_links.size() == nSide_ && T.instantons.size() == nInst_
+        && same_pairs(T.l_connection, lconn_)
+        && same_pairs(T.s_connection, sconn_)
+        && same_pairs(T.i_connection, iconn_);
+}
+
+void ShapePlan::compile(const Topology& T){
+    blocks_ = T.block;
+    lconn_  = T.l_connection;
+    sconn_  = T.s_connection;
+    iconn_  = T.i_connection;
+    nSide_  = T.side_links.size();
+    nInst_  = T.instantons.size();
+    sSlots_.clear(); iSlots_.clear();
+
+    const int nb = (int)blocks_.size();
+    std::vector<const CurveEntry*> ce(nb);
+    std::vector<int> off(nb+1, 0);
+    for (int k = 0; k < nb; ++k){
+        ce[k] = &curve_entry(spec_of(blocks_[k].kind, blocks_[k].param));
+        off[k+1] = off[k] + ce[k]->ports.size;
+    }
+    nBase_ = off[nb];
+
+    // 본체 블록 대각합
+    base_ = Eigen::MatrixXi::Zero(nBase_, nBase_);
+    for (int k = 0; k < nb; ++k){
+        const int sz = ce[k]->ports.size;
+        if (sz > 0) base_.block(off[k], off[k], sz, sz) = ce[k]->tensor.GetIntersectionFormRef();
+    }
+
+    // 체인 간선 (u.Right -- v.Left). builtin 규칙 위반은 기록만 하고 간선은 넣는다 (compose용)
+    baseStatus_ = GlueStatus::Ok;
+    indexOk_ = true;
+    auto fail = [&](GlueStatus st){
+        if (st == GlueStatus::BadIndex) indexOk_ = false;
+        if (baseStatus_ == GlueStatus::Ok) baseStatus_ = st;
+    };
+    auto glue = [&](int u, int v){
+        if (u < 0 || u >= nb || v < 0 || v >= nb){ fail(GlueStatus::BadIndex); return; }
+        const GlueStatus st = validate_extension(blocks_[u], blocks_[v].kind, blocks_[v].param);
+        if (st != GlueStatus::Ok) fail(st);
+        const int iu = ce[u]->ports.right, iv = ce[v]->ports.left;
+        if (iu < 0 || iv < 0) return;
+        base_(off[u]+iu, off[v]+iv) += 1;
+        base_(off[v]+iv, off[u]+iu) += 1;
+    };
+    if (!lconn_.empty()) for (const auto& e : lconn_) glue(e.u, e.v);
+    else                 for (int k = 1; k < nb; ++k) glue(k-1, k);
+
+    // 장식 슬롯 (장식 Right -- 노드 Left)
+    auto slot = [&](int u, int deco, size_t nDeco, std::vector<Slot>& out){
+        if (u < 0 || u >= nb || deco < 0 || deco >= (int)nDeco){ fail(GlueStatus::BadIndex); return; }
+        const int left = ce[u]->ports.left;
+        out.push_back(Slot{ left < 0 ? -1 : off[u] + left, blocks_[u], deco });
+    };
+    for (const auto& e : sconn_) slot(e.u, e.v, nSide_, sSlots_);
+    for (const auto& e : iconn_) slot(e.u, e.v, nInst_, iSlots_);
+}
+
+GlueStatus ShapePlan::assemble(const Topology& T, Eigen::MatrixXi& out) const {
+    if (baseStatus_ != GlueStatus::Ok) return baseStatus_;
+
+    for (const auto& sl : sSlots_){
+        const GlueStatus st = validate_decoration(sl.node, T.side_links[sl.deco].param);
+        if (st != GlueStatus::Ok) return st;
+    }
+    for (const auto& sl : iSlots_){
+        const GlueStatus st = validate_decoration(sl.node, T.instantons[sl.deco].param);
+        if (st != GlueStatus::Ok) return st;
+    }
+    return compose(T, out);
+}
+
+GlueStatus ShapePlan::compose(const Topology& T, Eigen::MatrixXi& out) const {
+    if (!indexOk_) return GlueStatus::BadIndex;
+
+    // 장식 블록 크기/오프셋 (스레드별 plan이므로 scratch 재사용)
+    const int nS = (int)nSide_, nI = (int)nInst_;
+    decoCe_.resize(nS + nI);
+    decoOff_.resize(nS + nI);
+    int total = nBase_;
+    for (int k = 0; k < nS + nI; ++k){
+        const int p = (k < nS) ? T.side_links[k].param : T.instantons[k - nS].param;
+        decoCe_[k]  = &curve_entry(Spec{Kind::SideLink, p});
+        decoOff_[k] = total;
+        total += decoCe_[k]->ports.size;
+    }
+
+    out.setZero(total, total);
+    if (nBase_ > 0) out.topLeftCorner(nBase_, nBase_) = base_;
+    for (int k = 0; k < nS + nI; ++k){
+        const int sz = decoCe_[k]->ports.size;
+        if (sz > 0) out.block(decoOff_[k], decoOff_[k], sz, sz) = decoCe_[k]->tensor.GetIntersectionFormRef();
+    }
+
+    auto glue = [&](const Slot& sl, int k){
+        const int r = decoCe_[k]->ports.right;
+        if (sl.attach < 0 || r < 0) return;
+        const int J = decoOff_[k] + r;
+        out(sl.attach, J) += 1;
+        out(J, sl.attach) += 1;
+    };
+    for (const auto& sl : sSlots_) glue(sl, sl.deco);
+    for (const auto& sl : iSlots_) glue(sl, nS + sl.deco);
+    return GlueStatus::Ok;
+}
+
+const ShapePlan& ShapePlanCache::get(const Topology& T){
+    if (valid_ && plan_.matches(T)) { ++hits_; return plan_; }
+    plan_.compile(T);
+    valid_ = true;
+    ++misses_;
+    return plan_;
+}
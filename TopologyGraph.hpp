@@ -0,0 +1,91 @@
+// TopologyGraph.hpp
+#pragma once
+#include "Topology.h"
+#include "Theory.h"
+#include "RuleSet.hpp"
+
+// 포맷 규약 (세 바이너리 공통):
+// - block: g -> n(p), L -> i(p), S/I 블록 -> s(p)
+// - side_links / instantons -> s(p), (장식 -> 노드) 방향 자동 포트로 연결
+// - l_connection이 비어 있으면 0-1-2-... 선형 체인으로 간주
+
+// 블록 종류 -> Spec
+Spec spec_of(LKind k, int param) noexcept;
+
+// 텐서를 만들지 않고 파라미터만으로 Topology 전체의 글루잉 규칙을 검사.
+// 범위를 벗어난 연결 인덱스는 BadIndex.
+GlueStatus validate_topology(const Topology& T) noexcept;
+
+// 블록 u에 장식(side/instanton) param 하나를 붙이는 글루잉만 검사
+GlueStatus validate_decoration(const Block& node, int decoParam) noexcept;
+
+// 체인 오른쪽에 블록 하나를 붙이는 글루잉만 검사 (last -> next)
+GlueStatus validate_extension(const Block& last, LKind nextKind, int nextParam) noexcept;
+
+// 같은 검사를 RuleSet 규칙으로 (builtin RuleSet이면 위와 같다)
+GlueStatus validate_topology(const Topology& T, const RuleSet& rules) noexcept;
+GlueStatus validate_decoration(const Block& node, int decoParam, const RuleSet& rules) noexcept;
+
+// 레코드 하나를 모든 룰셋으로 판정: 글루잉 규칙 + 편집된 bank 포함 여부
+RuleMask admit_mask(const Topology& T, const RuleSetList& rules);
+
+// ========== Shape plan ==========
+// 같은 (kinds, bparams, 연결 패턴)을 가진 레코드들은 장식 파라미터(sp/ip)만 다르다.
+// plan은 본체 블록의 오프셋, 체인 간선이 반영된 본체 행렬, 장식이 붙을 곡선 위치를
+// 미리 계산해 두고, 새 레코드는 장식 블록만 채워 넣는다.
+// 결과 행렬은 TheoryGraph(블록 -> side_links -> instantons 순) ComposeIF_Gluing과 같다.
+class ShapePlan {
+public:
+    void compile(const Topology& T);
+    bool matches(const Topology& T) const noexcept;
+
+    // 본체 규칙 검사 결과 (compile 시 한 번)
+    GlueStatus baseStatus() const noexcept { return baseStatus_; }
+    int        baseSize()   const noexcept { return nBase_; }
+
+    // 장식 규칙 검사 + IF 조립. Ok가 아니면 out은 건드리지 않는다
+    GlueStatus assemble(const Topology& T, Eigen::MatrixXi& out) const;
+
+    // 규칙 검사 없이 IF만 조립 (룰셋별 판정은 호출자 몫). 인덱스 오류만 BadIndex
+    GlueStatus compose(const Topology& T, Eigen::MatrixXi& out) const;
+
+private:
+    struct Slot {
+        int   attach;  // 본체 행렬 안에서 장식이 붙는 곡선 (노드 Left 포트), 없으면 -1
+        Block node;    // 규칙 검사용
+        int   deco;    // side_links / instantons id
+    };
+
+    BlockList                       blocks_;
+    LConnList                       lconn_;
+    SConnList                       sconn_;
+    IConnList                       iconn_;
+    size_t nSide_ = 0, nInst_ = 0;
+
+    GlueStatus        baseStatus_ = GlueStatus::Ok;
+    bool              indexOk_ = true;
+    int               nBase_ = 0;
+    Eigen::MatrixXi   base_;
+    std::vector<Slot> sSlots_, iSlots_;
+
+    // assemble scratch
+    mutable std::vector<const CurveEntry*> decoCe_;
+    mutable std::vector<int>               decoOff_;
+};
+
+// 직전 레코드와 모양이 같으면 plan을 재사용 (스레드별로 하나씩 둘 것)
+class ShapePlanCache {
+public:
+    const ShapePlan& get(const Topology& T);
+    GlueStatus assemble(const Topology& T, Eigen::MatrixXi& out) { return get(T).assemble(T, out); }
+    GlueStatus compose(const Topology& T, Eigen::MatrixXi& out)  { return get(T).compose(T, out); }
+
+    long long hits()   const { return hits_; }
+    long long misses() const { return misses_; }
+
+private:
+    ShapePlan plan_;
+    bool      valid_  = false;
+    long long hits_   = 0;
+    long long misses_ = 0;
+};
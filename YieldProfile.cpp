@@ -0,0 +1,63 @@
+// YieldProfile.cpp
+#include "YieldProfile.hpp"
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+// 한 줄짜리 카운터 객체. 규칙별 거절은 0이 아닌 것만
+static void write_counts(std::ostream& os, const YieldCounts& c){
+    os << "\"tried\":" << c.n[kYieldTried] << ",\"rejected\":{";
+    bool first = true;
+    for (int s = 0; s < kGlueStatusCount; ++s){
+        const long long v = c.n[kYieldRejected + s];
+        if (!v) continue;
+        if (!first) os << ',';
+        os << '"' << to_cstr((GlueStatus)s) << "\":" << v;
+        first = false;
+    }
+    os << "},\"unimodal\":" << c.n[kYieldUnimodal]
+       << ",\"duplicate\":"  << c.n[kYieldDuplicate]
+       << ",\"error\":"      << c.n[kYieldError]
+       << ",\"non_lst_scft\":" << c.n[kYieldNonPhysical]
+       << ",\"lst\":"        << c.n[kYieldLST]
+       << ",\"scft\":"       << c.n[kYieldSCFT];
+}
+
+bool YieldProfile::writeJson(const std::string& path, const std::string& tool) const {
+    std::unordered_map<std::uint64_t, YieldCounts> merged;
+    YieldCounts total;
+    for (const auto& s : slots_){
+        for (const auto& [k, c] : s.by_){
+            YieldCounts& m = merged[k];
+            for (int i = 0; i < kYieldCols; ++i){ m.n[i] += c.n[i]; total.n[i] += c.n[i]; }
+        }
+    }
+
+    std::vector<std::pair<std::uint64_t, YieldCounts>> rows(merged.begin(), merged.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b){
+        if (a.second.n[kYieldTried] != b.second.n[kYieldTried]) return a.second.n[kYieldTried] > b.second.n[kYieldTried];
+        return a.first < b.first;
+    });
+
+    const auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+    std::ofstream os(path, std::ios::trunc);
+    if (!os) return false;
+
+    os << "{\n  \"tool\": \"" << tool << "\",\n  \"totals\": {";
+    write_counts(os, total);
+    os << "},\n  \"by_code\": [";
+    for (size_t r = 0; r < rows.size(); ++r){
+        const std::uint64_t k = rows[r].first;
+        const char kind = (char)(k >> 56);
+        int g = (int)((k >> 32) & 0xFFFFFF);
+        if (g & 0x800000) g -= 0x1000000;  // 음수 g
+        const int code = (int)(std::uint32_t)k;
+        os << (r ? ",\n    " : "\n    ")
+           << "{\"kind\":\"" << kind << "\",\"g\":" << g << ",\"code\":" << code << ',';
+        write_counts(os, rows[r].second);
+        os << '}';
+    }
+    os << "\n  ]\n}\n";
+    return (bool)os;
+}
@@ -0,0 +1,59 @@
+// YieldProfile.hpp
+#pragma once
+#include "Theory.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// 후보가 어디서 버려지는지 코드별로 센다 (--profile).
+// 키: (종류, g 값, 코드)
+//   종류 'S'/'I' : 장식 코드 (decorate_generator, classify_topology)
+//   종류 'L'     : 체인 확장의 interior link 코드 (topology_generator; g는 붙는 노드)
+//   종류 'B'     : 본체 자체가 규칙 위반 (g = 첫 노드, 코드 0)
+enum YieldCol : int {
+    kYieldTried = 0,
+    kYieldRejected,                                   // + (int)GlueStatus
+    kYieldUnimodal = kYieldRejected + kGlueStatusCount,
+    kYieldDuplicate,
+    kYieldError,                                      // 조립/분류 실패
+    kYieldNonPhysical,                                // LST도 SCFT도 아님
+    kYieldLST,
+    kYieldSCFT,
+    kYieldCols
+};
+
+struct YieldCounts {
+    long long n[kYieldCols] = {};
+};
+
+// 스레드별 슬롯: 캐시 라인 단위로 떨어뜨려 false sharing 없이 갱신하고 종료 시 합친다
+class alignas(64) YieldSlot {
+public:
+    void add(char kind, int g, int code, int col, long long v = 1){
+        by_[key(kind, g, code)].n[col] += v;
+    }
+    void tried (char kind, int g, int code){ add(kind, g, code, kYieldTried); }
+    void reject(char kind, int g, int code, GlueStatus st){ add(kind, g, code, kYieldRejected + (int)st); }
+
+    static std::uint64_t key(char kind, int g, int code){
+        return ((std::uint64_t)(unsigned char)kind << 56) | ((std::uint64_t)(g & 0xFFFFFF) << 32) | (std::uint32_t)code;
+    }
+
+private:
+    friend class YieldProfile;
+    std::unordered_map<std::uint64_t, YieldCounts> by_;
+};
+
+class YieldProfile {
+public:
+    explicit YieldProfile(int nThreads = 1) : slots_(nThreads > 0 ? nThreads : 1) {}
+
+    YieldSlot& slot(int t){ return slots_[t]; }
+
+    // 슬롯을 합쳐 JSON 리포트로 (totals + by_code, tried 내림차순)
+    bool writeJson(const std::string& path, const std::string& tool) const;
+
+private:
+    std::vector<YieldSlot> slots_;
+};
@@ -16,37 +16,20 @@
 #include <Eigen/Dense>
 #include "Topology.h"
 #include "TopologyDB.hpp"
+#include "TopologyCursor.hpp"
 #include "TopoLineCompact.hpp"
+#include "IFCodec.hpp"
 #include "Theory.h"
+#include "TopologyGraph.hpp"
+#include "RuleStamp.hpp"
+#include "YieldProfile.hpp"
+#include "PackFile.hpp"
+#include "ShardWriter.hpp"
 
 // ===== 유틸 =====
-static inline void ensure_linear_chain(const Topology& T,
-                                       std::vector<InteriorStructure>& out_chain){
-    if (!T.l_connection.empty()) { out_chain = T.l_connection; return; }
-    const int n = (int)T.block.size();
-    if (n <= 1) return;
-    out_chain.reserve(n-1);
-    for (int i=1; i<n; ++i) out_chain.push_back({i-1, i});
-}
-
-static inline void append_matrix_txt_batch(std::string& buf, const Eigen::MatrixXi& M){
-    const int R = M.rows(), C = M.cols();
-    for (int i=0;i<R;++i){
-        for (int j=0;j<C;++j){
-            if (j) buf.push_back(' ');
-            buf += std::to_string(M(i,j));
-        }
-        buf.push_back('\n');
-    }
-    buf.push_back('\n');
-}
-
-static inline void flush_to_file(const std::string& path, const std::string& buf){
-    if (buf.empty()) return;
-    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
-    std::ofstream out(path, std::ios::app);
-    if (!out) throw std::runtime_error("cannot open " + path);
-    out.write(buf.data(), (std::streamsize)buf.size());
+// <base>_IF_X.txt -> <base>_IF_X.deps (행렬 순서대로 의존 코드 한 줄씩)
+static inline std::string deps_path(const std::string& ifPath){
+    return std::filesystem::path(ifPath).replace_extension(".deps").string();
 }
 
 // ✨ ADDED: Extract base filename without extension
@@ -55,6 +38,21 @@ static inline std::string get_base_filename(const std::string& path){
     return p.stem().string();  // filename without extension
 }
 
+// 상대 경로 -> 안전한 파일 이름 (구분자/공백은 '_', 확장자 제거)
+static inline std::string safe_name_from_rel(std::string safe_name){
+    std::replace(safe_name.begin(), safe_name.end(), '/', '_');
+    std::replace(safe_name.begin(), safe_name.end(), '\\', '_');
+    std::replace(safe_name.begin(), safe_name.end(), ' ', '_');  // ✨ ADDED: handle spaces
+    
+    // Remove extension
+    auto ext_pos = safe_name.find_last_of('.');
+    if (ext_pos != std::string::npos) {
+        safe_name = safe_name.substr(0, ext_pos);
+    }
+    
+    return safe_name;
+}
+
 // ✨ ADDED: Get relative path from base directory and convert to safe filename
 static inline std::string get_safe_output_name(const std::string& fullPath, 
                                                 const std::string& baseDir){
@@ -72,65 +70,7 @@ static inline std::string get_safe_output_name(const std::string& fullPath,
     }
     
     // Replace directory separators and spaces with underscores
-    std::string safe_name = rel_path;
-    std::replace(safe_name.begin(), safe_name.end(), '/', '_');
-    std::replace(safe_name.begin(), safe_name.end(), '\\', '_');
-    std::replace(safe_name.begin(), safe_name.end(), ' ', '_');  // ✨ ADDED: handle spaces
-    
-    // Remove extension
-    auto ext_pos = safe_name.find_last_of('.');
-    if (ext_pos != std::string::npos) {
-        safe_name = safe_name.substr(0, ext_pos);
-    }
-    
-    return safe_name;
-}
-
-// ===== Topology -> TheoryGraph =====
-struct GraphBuildResult {
-    TheoryGraph G;
-};
-
-static GraphBuildResult build_graph_from_topology(const Topology& T){
-    GraphBuildResult R;
-
-    // 1) g/L 본체 노드
-    std::vector<int> nodeIdx_gL(T.block.size(), -1);
-    for (size_t i=0; i<T.block.size(); ++i){
-        const auto& b = T.block[i];
-        Spec sp;
-        switch (b.kind){
-            case LKind::g: sp = Spec{Kind::Node,         b.param}; break;
-            case LKind::L: sp = Spec{Kind::InteriorLink, b.param}; break;
-            case LKind::S: sp = Spec{Kind::SideLink,     b.param}; break;
-            case LKind::I: sp = Spec{Kind::SideLink,     b.param}; break;
-        }
-        nodeIdx_gL[i] = R.G.add(sp).id;
-    }
-
-    // 2) S/I 장식 노드
-    std::vector<int> nodeIdx_S(T.side_links.size(), -1);
-    for (size_t i=0; i<T.side_links.size(); ++i)
-        nodeIdx_S[i] = R.G.add(Spec{Kind::SideLink, T.side_links[i].param}).id;
-
-    std::vector<int> nodeIdx_I(T.instantons.size(), -1);
-    for (size_t i=0; i<T.instantons.size(); ++i)
-        nodeIdx_I[i] = R.G.add(Spec{Kind::SideLink, T.instantons[i].param}).id;
-
-    // 3) 연결 복원
-    std::vector<InteriorStructure> chain;
-    ensure_linear_chain(T, chain);
-
-    for (auto e : chain)
-        R.G.connect(NodeRef{nodeIdx_gL.at(e.u)}, NodeRef{nodeIdx_gL.at(e.v)});
-
-    for (auto e : T.s_connection)
-        R.G.connect(NodeRef{nodeIdx_S.at(e.v)}, NodeRef{nodeIdx_gL.at(e.u)});
-
-    for (auto e : T.i_connection)
-        R.G.connect(NodeRef{nodeIdx_I.at(e.v)}, NodeRef{nodeIdx_gL.at(e.u)});
-
-    return R;
+    return safe_name_from_rel(rel_path);
 }
 
 // ===== 판정 로직 (✨ UPDATED: 실제 고유값 기반으로 변경) =====
@@ -184,127 +124,365 @@ static inline bool is_lst_accurate(const Eigen::MatrixXi& IF, double tol=1e-8){
 }
 
 // ===== 입력 처리 =====
-enum class InFmt { Auto, DB, Line };
+enum class InFmt { Auto, DB, Line, Pack };
 static InFmt parse_infmt(const std::string& s){
     if (s=="db")   return InFmt::DB;
     if (s=="line") return InFmt::Line;
+    if (s=="pack") return InFmt::Pack;
     return InFmt::Auto;
 }
 
-// ✨ MODIFIED: process_line_file now takes base_name for output naming
-static long long process_line_file(const std::string& path,
-                                   const std::string& outDir,
-                                   const std::string& base_name){
-    std::ifstream fin(path);
-    if (!fin){ std::cerr << "[skip] cannot open " << path << "\n"; return 0; }
-    
-    long long Nproc=0, Nscft=0, Nlst=0;
-    
-    // ✨ MODIFIED: Output files named after input file
-    const std::string out_scft = outDir + "/" + base_name + "_IF_SCFT.txt";
-    const std::string out_lst  = outDir + "/" + base_name + "_IF_LST.txt";
-    
-    std::string buf_scft; buf_scft.reserve(1<<22);
-    std::string buf_lst;  buf_lst .reserve(1<<22);
-    
-    auto flush_all = [&](){
-        flush_to_file(out_scft, buf_scft); buf_scft.clear();
-        flush_to_file(out_lst,  buf_lst);  buf_lst.clear();
+// ===== 실행 설정 (파일마다 공유) =====
+struct ClassifyRun {
+    const RuleSetList&      rules;
+    std::vector<RuleTally>& tally;
+    const DepSet*           only = nullptr;  // --incremental: 이 코드에 닿는 레코드만
+    YieldSlot*              prof = nullptr;  // --profile (builtin 기준)
+    ShardWriter*            out = nullptr;   // 출력 (outDir 기준; --out-pack이면 팩의 논리 샤드로)
+    bool                    binaryIF = false; // --if-format bin: *_IF_*.ifb + .ifx (IFCodec.hpp)
+};
+
+// ===== 입력 파일 하나의 출력 (룰셋별) =====
+// IF 조립/판정은 레코드당 한 번, 룰셋별 허용 여부는 admit_mask 비트로.
+// 룰셋이 하나면 기존 위치(<outDir>/<base>_IF_*.txt), 여러 개면 <outDir>/<룰셋 이름>/ 아래.
+// 행렬마다 의존 코드 한 줄을 <base>_IF_*.deps에 같은 순서로 남긴다 (--incremental용).
+// 바이너리면 <base>_IF_*.ifb에 레코드, .ifx에 레코드 오프셋 (기존 파일 뒤에 이어진다).
+class ClassifySink {
+public:
+    long long Nproc=0, Nscft=0, Nlst=0;  // builtin 기준
+    long long Nkept=0;                   // --incremental: 규칙 변경과 무관해서 건너뜀
+
+    ClassifySink(const std::string& base_name, const ClassifyRun& run)
+        : rules_(run.rules), tally_(run.tally), only_(run.only), prof_(run.prof), sink_(*run.out),
+          binary_(run.binaryIF), out_(run.rules.size())
+    {
+        // 경로는 outDir 기준 상대 (= 팩 키). 파일마다 id를 한 번 받아 둔다
+        const char* ext = binary_ ? ".ifb" : ".txt";
+        for (size_t r = 0; r < rules_.size(); ++r){
+            const std::string dir = rules_.multi() ? rules_[r].name() + "/" : std::string();
+            // ✨ MODIFIED: Output files named after input file
+            out_[r].scft.open(sink_, dir + base_name + "_IF_SCFT" + ext, binary_);
+            out_[r].lst .open(sink_, dir + base_name + "_IF_LST" + ext, binary_);
+            out_[r].id_diff = sink_.id(dir + base_name + "_diff_vs_builtin.diff");
+            if (binary_) for (IFOut* o : {&out_[r].scft, &out_[r].lst}){
+                o->bytes = sink_.size(o->id);
+                if (o->bytes == 0) o->buf.assign(ifbin::kMagic, ifbin::kHeaderSize);
+            }
+        }
+        out_[0].scft.buf.reserve(binary_ ? 1<<18 : 1<<22);
+        out_[0].lst .buf.reserve(binary_ ? 1<<18 : 1<<22);
+    }
+
+    void classify(const Topology& T){
+        record_deps(T, deps_);
+        if (only_ && !touches(deps_, *only_)){ ++Nkept; return; }
+
+        if (prof_) profile_keys(T);
+
+        const RuleMask m = admit_mask(T, rules_);
+        if (!(m & 1) && prof_){
+            const GlueStatus st0 = validate_topology(T);
+            for (const auto& k : keys_) prof_->reject(k.kind, k.g, k.code, st0);
+        }
+        if (!m){
+            std::cerr << "[Error] " << glue_message(validate_topology(T)) << " on topology " << T.name << "\n";
+            return;
+        }
+
+        // 연속 레코드가 같은 모양이면 plan 재사용
+        const GlueStatus st = plans_.compose(T, IF_);
+        if (st != GlueStatus::Ok){
+            if ((m & 1) && prof_) for (const auto& k : keys_) prof_->add(k.kind, k.g, k.code, kYieldError);
+            std::cerr << "[Error] " << glue_message(st) << " on topology " << T.name << "\n";
+            return;
+        }
+
+        const bool scft = is_scft_accurate(IF_);
+        const bool lst  = !scft && is_lst_accurate(IF_);
+        if ((m & 1) && prof_){
+            const int col = scft ? kYieldSCFT : lst ? kYieldLST : kYieldNonPhysical;
+            for (const auto& k : keys_) prof_->add(k.kind, k.g, k.code, col);
+        }
+        if (m & 1){
+            if (scft) ++Nscft;
+            if (lst)  ++Nlst;
+        }
+        if (scft || lst){
+            std::string depLine;
+            for (DepCode c : deps_){
+                if (!depLine.empty()) depLine.push_back(' ');
+                depLine += dep_name(c);
+            }
+            depLine.push_back('\n');
+
+            std::string line;  // diff 기록용, 필요할 때만
+            for (size_t r = 0; r < rules_.size(); ++r){
+                const bool inR = (m >> r) & 1, inB = m & 1;
+                if (inR){
+                    IFOut& o = scft ? out_[r].scft : out_[r].lst;
+                    if (binary_){
+                        const std::uint64_t at = o.bytes + o.buf.size();
+                        o.idx.append(reinterpret_cast<const char*>(&at), sizeof at);
+                        append_if_binary(o.buf, IF_);
+                    } else {
+                        append_if_text(o.buf, IF_);
+                    }
+                    o.deps += depLine;
+                    ++(scft ? tally_[r].scft : tally_[r].lst);
+                }
+                if (r == 0 || inR == inB) continue;
+                if (line.empty()) append_line_compact(line, T);
+                std::string& d = out_[r].buf_diff;
+                d += inR ? "+ " : "- ";
+                d += scft ? "SCFT " : "LST ";
+                d += line;
+                d += '\n';
+                ++(inR ? tally_[r].added : tally_[r].removed);
+            }
+        }
+
+        if ((++Nproc % 2000)==0) flush();
+    }
+
+    void flush(){
+        for (auto& o : out_){
+            for (IFOut* f : {&o.scft, &o.lst}){
+                if (binary_ && f->idx.empty()) continue;   // 새 레코드 없음 (헤더만 있는 파일은 만들지 않는다)
+                f->bytes += f->buf.size();
+                emit(f->id, f->buf);
+                emit(f->id_deps, f->deps);
+                if (binary_) emit(f->id_idx, f->idx);
+            }
+            emit(o.id_diff, o.buf_diff);
+        }
+    }
+
+private:
+    void emit(ShardWriter::Id id, std::string& buf){
+        if (buf.empty()) return;
+        sink_.append(id, buf);
+        buf.clear();
+    }
+
+    // 프로파일 키: 장식마다 (S|I, 붙은 g, 코드). 장식이 없으면 ('B', 첫 노드, 0)
+    struct Key { char kind; int g; int code; };
+
+    void profile_keys(const Topology& T){
+        keys_.clear();
+        const int nb = (int)T.block.size();
+        auto gOf = [&](int u){ return (u >= 0 && u < nb) ? T.block[u].param : 0; };
+        for (const auto& e : T.s_connection)
+            if (e.v >= 0 && e.v < (int)T.side_links.size()) keys_.push_back(Key{'S', gOf(e.u), T.side_links[e.v].param});
+        for (const auto& e : T.i_connection)
+            if (e.v >= 0 && e.v < (int)T.instantons.size()) keys_.push_back(Key{'I', gOf(e.u), T.instantons[e.v].param});
+        if (keys_.empty()) keys_.push_back(Key{'B', gOf(0), 0});
+        for (const auto& k : keys_) prof_->tried(k.kind, k.g, k.code);
+    }
+
+    struct IFOut {
+        ShardWriter::Id id = 0, id_deps = 0, id_idx = 0;   // 본 파일, .deps, .ifx (바이너리)
+        std::string   buf, deps;
+        std::string   idx;         // 바이너리: 레코드 오프셋 u64
+        std::uint64_t bytes = 0;   // 바이너리: 이미 ShardWriter에 넘긴 크기
+
+        void open(ShardWriter& w, const std::string& path, bool binary){
+            id      = w.id(path);
+            id_deps = w.id(deps_path(path));
+            if (binary) id_idx = w.id(ifb_index_path(path));
+        }
     };
-    
-    std::string line;
-    while (std::getline(fin, line)){
-        if (line.empty()) continue;
-        Topology T;
-        if (!deserialize_line_compact(line, T)) continue;
-        
-        try{
-            auto R  = build_graph_from_topology(T);
-            Eigen::MatrixXi IF = R.G.ComposeIF_Gluing();
+    struct Out {
+        IFOut           scft, lst;
+        ShardWriter::Id id_diff = 0;
+        std::string     buf_diff;
+    };
+
+    const RuleSetList&      rules_;
+    std::vector<RuleTally>& tally_;
+    const DepSet*           only_;
+    YieldSlot*              prof_;
+    ShardWriter&            sink_;
+    bool                    binary_;
+    std::vector<Key>        keys_;
+    std::vector<Out>        out_;
+    std::vector<DepCode>    deps_;
+    ShapePlanCache          plans_;
+    Eigen::MatrixXi         IF_;
+};
 
-            if (is_scft_accurate(IF)) { append_matrix_txt_batch(buf_scft, IF); ++Nscft; }
-            else if (is_lst_accurate(IF)) { append_matrix_txt_batch(buf_lst, IF); ++Nlst; }
+// 커서 하나를 끝까지 분류 (레코드는 재사용하는 Topology 하나에 풀린다)
+static long long classify_cursor(TopologyCursor& cur,
+                                 const std::string& base_name,
+                                 const ClassifyRun& run){
+    ClassifySink sink(base_name, run);
 
-            if ((++Nproc % 2000)==0) flush_all();
+    Topology T;
+    while (cur.next(T)){
+        try{
+            sink.classify(T);
         } catch (const std::exception& e){
             std::cerr << "[Error] " << e.what() << " on topology " << T.name << "\n";
         }
     }
     
-    flush_all();
+    sink.flush();
     
-    std::cout << "File: " << base_name << " | Processed: " << Nproc
-              << " | SCFT: " << Nscft << " | LST: " << Nlst << "\n";
+    std::cout << "File: " << base_name << " | Processed: " << sink.Nproc
+              << " | SCFT: " << sink.Nscft << " | LST: " << sink.Nlst;
+    if (run.only) std::cout << " | Kept: " << sink.Nkept;
+    std::cout << "\n";
     
-    return Nproc;
+    return sink.Nproc;
+}
+
+// ✨ MODIFIED: process_line_file now takes base_name for output naming
+static long long process_line_file(const std::string& path,
+                                   const std::string& base_name,
+                                   const ClassifyRun& run){
+    TopologyCursor cur(path, TopologyCursor::Format::Line);
+    if (!cur.ok()){ std::cerr << "[skip] cannot open " << path << "\n"; return 0; }
+    return classify_cursor(cur, base_name, run);
 }
 
 // ✨ MODIFIED: process_line_path now handles each file separately with directory structure preserved
 static long long process_line_path(const std::string& inPath,
-                                   const std::string& outDir){
+                                   const ClassifyRun& run){
     long long total=0;
     if (std::filesystem::is_directory(inPath)){
         // ✨ MODIFIED: Use safe output name that includes directory structure
         for (auto& e : std::filesystem::recursive_directory_iterator(inPath)){
             if (e.is_regular_file() && e.path().extension()==".txt"){
                 std::string safe_name = get_safe_output_name(e.path().string(), inPath);
-                total += process_line_file(e.path().string(), outDir, safe_name);
+                total += process_line_file(e.path().string(), safe_name, run);
             }
         }
     } else {
         std::string base_name = get_base_filename(inPath);
-        total += process_line_file(inPath, outDir, base_name);
+        total += process_line_file(inPath, base_name, run);
     }
     return total;
 }
 
 // ✨ MODIFIED: process_db_file with base_name parameter
 static long long process_db_file(const std::string& dbPath,
-                                const std::string& outDir,
-                                const std::string& base_name){
-    TopologyDB db(dbPath);
-    
-    long long Nproc=0, Nscft=0, Nlst=0;
-    
-    // ✨ MODIFIED: Output files named after input file
-    const std::string out_scft = outDir + "/" + base_name + "_IF_SCFT.txt";
-    const std::string out_lst  = outDir + "/" + base_name + "_IF_LST.txt";
-    
-    std::string buf_scft; buf_scft.reserve(1<<22);
-    std::string buf_lst;  buf_lst .reserve(1<<22);
-    
-    auto flush_all = [&](){
-        flush_to_file(out_scft, buf_scft); buf_scft.clear();
-        flush_to_file(out_lst,  buf_lst);  buf_lst.clear();
-    };
-    
-    for (auto& rec : db.loadAll()){
-        try{
-            auto R  = build_graph_from_topology(rec.topo);
-            Eigen::MatrixXi IF = R.G.ComposeIF_Gluing();
+                                const std::string& base_name,
+                                const ClassifyRun& run){
+    // 본 파일 + manifest의 세그먼트를 한 입력으로 (같은 출력 파일에 이어진다)
+    long long total = 0;
+    for (const auto& part : TopologyDB(dbPath).parts()) {
+        TopologyCursor cur = TopologyCursor::openDB(part);
+        total += classify_cursor(cur, base_name, run);
+    }
+    return total;
+}
 
-            if (is_scft_accurate(IF)) { append_matrix_txt_batch(buf_scft, IF); ++Nscft; }
-            else if (is_lst_accurate(IF)) { append_matrix_txt_batch(buf_lst, IF); ++Nlst; }
+// 팩의 논리 샤드(.txt 키)마다: 풀어 놓은 디렉터리를 돌린 것과 같은 이름으로 출력
+static long long process_pack(const std::string& packPath,
+                              const ClassifyRun& run){
+    PackReader pack(packPath);
+    if (!pack.ok()){ std::cerr << "[skip] cannot open pack " << packPath << "\n"; return 0; }
+    pack.adviseSequential();
+    long long total = 0;
+    TopologyCursor cur;
+    for (const auto& [key, ext] : pack.directory()){
+        if (std::filesystem::path(key).extension() != ".txt") continue;
+        cur.openSpans(pack.spans(key));
+        total += classify_cursor(cur, safe_name_from_rel(key), run);
+    }
+    return total;
+}
 
-            if ((++Nproc % 2000)==0) flush_all();
-        } catch (const std::exception& e){
-            std::cerr << "[Error] " << e.what() << " on topology " << rec.topo.name << "\n";
+// ===== Incremental =====
+// <base>_IF_*.txt / .ifb와 같은 순서의 .deps를 함께 읽어 바뀐 코드에 닿는 행렬을 지운다 (.ifb는 .ifx도 다시 쓴다).
+// .deps가 없거나 개수가 안 맞는 파일이 있으면 -1 (전체 재실행 필요)
+static long long prune_if_outputs(const std::string& outDir, const DepSet& changed){
+    std::vector<std::filesystem::path> files;
+    for (auto& e : std::filesystem::directory_iterator(outDir)){
+        const std::string fn = e.path().filename().string();
+        const auto ext = e.path().extension();
+        if (e.is_regular_file() && (ext==".txt" || ext==".ifb") && fn.find("_IF_")!=std::string::npos)
+            files.push_back(e.path());
+    }
+
+    long long dropped = 0;
+    for (const auto& f : files){
+        const bool bin = f.extension() == ".ifb";
+        const std::string dp = deps_path(f.string());
+        std::ifstream fdeps(dp);
+        if (!fdeps){ std::cerr << "[Error] missing " << dp << "\n"; return -1; }
+
+        std::string keptIF, keptDeps, keptIdx, depLine;
+        std::vector<DepCode> deps;
+        long long n = 0;
+        // 다음 행렬의 의존 줄: 남길지 정하고, 남기면 keptDeps에 붙인다
+        auto next_keep = [&](bool& keep) -> bool {
+            if (!std::getline(fdeps, depLine)) return false;
+            std::istringstream ss(depLine);
+            std::string tok; DepCode c;
+            deps.clear();
+            while (ss >> tok) if (parse_dep(tok, c)) deps.push_back(c);
+            keep = !touches(deps, changed);
+            if (keep){ keptDeps += depLine; keptDeps += '\n'; }
+            else ++n;
+            return true;
+        };
+        bool ok = true, keep = false;
+        if (bin){
+            IFBinFile ifb(f.string());
+            ok = ifb.ok();
+            keptIF.assign(ifbin::kMagic, ifbin::kHeaderSize);
+            for (size_t k = 0; ok && k < ifb.size(); ++k){
+                ok = next_keep(keep);
+                if (!ok || !keep) continue;
+                const std::uint64_t at = keptIF.size();
+                keptIdx.append(reinterpret_cast<const char*>(&at), sizeof at);
+                keptIF += ifb.record(k);
+            }
+        } else {
+            std::ifstream fin(f);
+            std::string block, line;
+            auto finish_block = [&]() -> bool {
+                if (block.empty()) return true;
+                if (!next_keep(keep)) return false;
+                if (keep){ keptIF += block; keptIF += '\n'; }
+                block.clear();
+                return true;
+            };
+            while (ok && std::getline(fin, line)){
+                if (line.empty()) ok = finish_block();
+                else { block += line; block += '\n'; }
+            }
+            ok = ok && finish_block();
+        }
+        ok = ok && !std::getline(fdeps, depLine);
+        if (!ok){ std::cerr << "[Error] " << dp << " does not match " << f.string() << "\n"; return -1; }
+        if (n == 0) continue;
+
+        fdeps.close();
+        std::vector<std::pair<std::string, const std::string*>> outs{{f.string(), &keptIF}, {dp, &keptDeps}};
+        if (bin) outs.emplace_back(ifb_index_path(f.string()), &keptIdx);
+        for (const auto& [path, content] : outs){
+            const std::string tmp = path + ".tmp";
+            { std::ofstream out(tmp, std::ios::trunc | std::ios::binary); out.write(content->data(), (std::streamsize)content->size()); }
+            std::filesystem::rename(tmp, path);
         }
+        dropped += n;
     }
-    
-    flush_all();
-    
-    std::cout << "File: " << base_name << " | Processed: " << Nproc
-              << " | SCFT: " << Nscft << " | LST: " << Nlst << "\n";
-    
-    return Nproc;
+    return dropped;
 }
 
 // ===== 메인 =====
 int main(int argc, char** argv){
     if (argc < 3){
-        std::cerr << "usage: " << argv[0] << " <input_path_or_dir> <out_dir> [--in line|db|auto]\n";
+        std::cerr << "usage: " << argv[0] << " <input_path_or_dir> <out_dir> [--in line|db|pack|auto] [--rules file.rules ...]"
+                  << " [--incremental] [--profile report.json] [--out-pack file.pack] [--if-format text|bin]\n";
         std::cerr << "  Output files will be named: <input_basename>_IF_SCFT.txt and <input_basename>_IF_LST.txt\n";
+        std::cerr << "  --rules: classify once, admit per rule set; outputs go to <out_dir>/<rule set name>/\n";
+        std::cerr << "  --incremental: compare with <out_dir>/rules.stamp, drop and reclassify only records\n"
+                  << "                 whose codes changed (needs the .deps files from an earlier run)\n";
+        std::cerr << "  --out-pack: write the IF/deps/diff outputs as logical shards of one pack file\n";
+        std::cerr << "  --if-format bin: write <base>_IF_*.ifb (diagonal + sparse edge list, varint) with a .ifx\n"
+                  << "                 offset index instead of dense text; if_convert turns them back into text\n";
         return 1;
     }
     const std::string inPath = argv[1];
@@ -312,31 +490,121 @@ int main(int argc, char** argv){
     std::filesystem::create_directories(outDir);
 
     InFmt inFmt = InFmt::Auto;
+    RuleSetList rules;
+    bool incremental = false, binaryIF = false;
+    std::string profilePath, packPath;
     for (int i=3; i<argc; ++i){
         if (std::string(argv[i])=="--in" && i+1<argc){
             inFmt = parse_infmt(argv[++i]);
+        } else if (std::string(argv[i])=="--incremental"){
+            incremental = true;
+        } else if (std::string(argv[i])=="--profile" && i+1<argc){
+            profilePath = argv[++i];
+        } else if (std::string(argv[i])=="--out-pack" && i+1<argc){
+            packPath = argv[++i];
+        } else if (std::string(argv[i])=="--if-format" && i+1<argc){
+            const std::string f = argv[++i];
+            if (f != "text" && f != "bin"){ std::cerr << "[Error] bad --if-format " << f << "\n"; return 1; }
+            binaryIF = f == "bin";
+        } else if (std::string(argv[i])=="--rules" && i+1<argc){
+            try { rules.add(RuleSet::load(argv[++i])); }
+            catch (const std::exception& e){ std::cerr << "[Error] " << e.what() << "\n"; return 1; }
+        }
+    }
+    std::vector<RuleTally> tally(rules.size());
+    ClassifyRun run{rules, tally};
+    run.binaryIF = binaryIF;
+    YieldProfile profile(1);
+    if (!profilePath.empty()) run.prof = &profile.slot(0);
+
+    std::vector<RuleStamp> stamps;
+    for (size_t r = 0; r < rules.size(); ++r) stamps.push_back(RuleStamp::compute(rules[r]));
+
+    DepSet changed;
+    if (incremental){
+        RuleStamp old;
+        const std::string stampPath = outDir + "/" + RuleStamp::kFileName;
+        if (rules.multi()){
+            std::cerr << "[Error] --incremental cannot be combined with --rules\n";
+            return 1;
+        } else if (!packPath.empty()){
+            std::cerr << "[Error] --incremental cannot be combined with --out-pack\n";
+            return 1;
+        } else if (!RuleStamp::load(stampPath, old)){
+            std::cerr << "[warn] no " << stampPath << "; running a full pass\n";
+        } else {
+            changed = stamps[0].changedSince(old);
+            if (changed.empty()){
+                std::cout << "Rules unchanged since last run; nothing to reclassify.\n";
+                return 0;
+            }
+            const long long dropped = prune_if_outputs(outDir, changed);
+            if (dropped < 0){
+                std::cerr << "[Error] cannot prune " << outDir << "; rerun without --incremental into a fresh dir\n";
+                return 1;
+            }
+            std::cout << "Changed codes: " << changed.size() << " | Dropped " << dropped << " stale matrices\n";
+            run.only = &changed;
         }
     }
 
+    PackWriter pack;
+    if (!packPath.empty()){
+        if (!pack.open(packPath)){ std::cerr << "[Error] cannot open pack " << packPath << "\n"; return 1; }
+    }
+    ShardWriter out(outDir, pack.ok() ? &pack : nullptr);
+    run.out = &out;
+
     long long total = 0;
 
-    if (inFmt==InFmt::DB) {
+    if (inFmt==InFmt::Pack || (inFmt==InFmt::Auto && !std::filesystem::is_directory(inPath)
+                               && PackReader::isPack(inPath))) {
+        total = process_pack(inPath, run);
+    } else if (inFmt==InFmt::DB) {
         std::string base_name = get_base_filename(inPath);
-        total = process_db_file(inPath, outDir, base_name);
+        total = process_db_file(inPath, base_name, run);
     } else if (inFmt==InFmt::Line || std::filesystem::is_directory(inPath)
                || std::filesystem::path(inPath).extension()==".txt") {
-        total = process_line_path(inPath, outDir);
+        total = process_line_path(inPath, run);
     } else {
         try { 
             std::string base_name = get_base_filename(inPath);
-            total = process_db_file(inPath, outDir, base_name); 
+            total = process_db_file(inPath, base_name, run); 
         }
         catch (...) { 
-            total = process_line_path(inPath, outDir); 
+            total = process_line_path(inPath, run); 
         }
     }
 
+    if (!out.close()){
+        std::cerr << "[Error] failed to write output under " << outDir << "\n";
+        return 1;
+    }
+    if (pack.ok() && !pack.close()){
+        std::cerr << "[Error] failed to write pack " << packPath << "\n";
+        return 1;
+    }
+
+    for (size_t r = 0; r < rules.size(); ++r){
+        const std::string dir = rules.multi() ? outDir + "/" + rules[r].name() : outDir;
+        const std::string stampPath = dir + "/" + RuleStamp::kFileName;
+        if (!stamps[r].save(stampPath)) std::cerr << "[warn] cannot write " << stampPath << "\n";
+    }
+
     std::cout << "\nTotal processed: " << total << "\n";
+    if (run.prof){
+        if (profile.writeJson(profilePath, "classify_topology")) std::cout << "Profile: " << profilePath << "\n";
+        else std::cerr << "[warn] cannot write " << profilePath << "\n";
+    }
+    if (rules.multi()){
+        std::cout << "Rule sets (LST / SCFT / +added / -removed vs builtin):\n";
+        for (size_t r = 0; r < rules.size(); ++r){
+            std::cout << "  " << rules[r].name() << ": " << tally[r].lst << " / " << tally[r].scft
+                      << " / +" << tally[r].added << " / -" << tally[r].removed << "\n";
+        }
+        if (!write_rule_report(outDir + "/rules_report.tsv", rules, tally))
+            std::cerr << "[warn] cannot write " << outDir << "/rules_report.tsv\n";
+    }
     std::cout << "Output dir: " << outDir << "\n";
     return 0;
 }
@@ -9,17 +9,25 @@
 #include <condition_variable>
 #include <queue>
 #include <chrono>
+#include <algorithm>
+#include <memory>
 
 #include "Topology.h"
 #include "TopologyDB.hpp"
+#include "TopologyCursor.hpp"
 #include "TopoLineCompact.hpp"
+#include "TopoCanonical.hpp"
 #include "Theory.h"
+#include "TopologyGraph.hpp"
+#include "RuleStamp.hpp"
+#include "YieldProfile.hpp"
+#include "PackFile.hpp"
+#include "ShardPipe.hpp"
 #include <unordered_set>
 #include <unordered_map>
 #include <sstream>
 
 // ========== Configuration ==========
-static constexpr size_t BUFFER_SIZE = 64u << 20;      // 64MB per buffer
 static constexpr size_t BATCH_SIZE = 10000;           // Topologies per batch
 static constexpr int MAX_DECO_PER_NODE = 3;
 
@@ -28,46 +36,11 @@ struct TargetSpec {
     std::unordered_set<int> nodes;
     bool do_S = true, do_I = true;
     enum class PrefixMode {None, Kind, HeadKind} prefix = PrefixMode::None;
+    bool canonical = false;   // 반사 정규형으로 출력, 대칭 본체는 절반의 노드만
+    bool norm = false;        // 정규화 출력: 파일마다 base 표(B) + 장식 레코드(D)
 };
 
-enum class InFmt {Auto, DB, Line};
-
-// ========== Gluing rules (original) ==========
-static inline const std::vector<int>& allowed_S_params(int gval){
-    static std::vector<int> dummy;
-    static const std::vector<int> S_g4 = {1,882,883,22,32,23,33,42,991,9920,9902,92,93,97,98,912,915,916,917,331,43,53,99910,9913,924,925,927,928,929,934,936,937,938,940,941,942,943,956};
-    static const std::vector<int> S_g6 = {1,882,883,884,885,22,23,33,24,993,93,96,97,98,99,911,912,913,914,915,331,43,34,44,53,35,54,45,55,99910,99920,99930,994,995,9910,9912,9913,9914,918,920,921,922,924,925,926,927,928,929,933,934,935,936,937,938,939,943,944,945,9916,9917,947,951,952,955,956,957};
-    static const std::vector<int> S_g7 = {1,882,883,884,885,886,23,33,24,993,91,93,94,95,96,97,98,99,910,911,34,44,35,45,54,55,99920,99930,995,996,997,998,9911,9912,9913,9914,918,919,920,921,922,923,924,925,926,927,928,929,930,931,932,933,944,945,9915,9916,946,947,950,951,952,953,954};
-    static const std::vector<int> S_g8 = {1,882,883,884,885,886,887,23,33,24,993,91,93,94,95,96,97,98,99,910,911,34,44,35,45,54,55,99920,99930,995,996,997,998,9911,9912,9913,9914,918,919,920,921,922,923,924,925,926,927,928,929,930,931,932,933,944,945,9915,9916,946,947,950,951,952,953,954};
-    static const std::vector<int> S_g12 = {1,882,883,884,885,886,887,8881,889,8810,8811,24,93,94,95,96,35,45,55,99930,996,998,999,9912,918,919,920,921,922,923,945,9915,946,947,948,949,950};
-
-    switch (gval){
-        case 4: return S_g4;
-        case 6: return S_g6;
-        case 7: return S_g7;
-        case 8: return S_g8;
-        case 12: return S_g12;
-        default: return dummy;
-    }
-}
-
-static inline const std::vector<int>& allowed_I_params(int gval){
-    static std::vector<int> dummy;
-    static const std::vector<int> I_g4 = {1,882,883};
-    static const std::vector<int> I_g6 = {1,882,883,884,885};
-    static const std::vector<int> I_g7 = {1,882,883,884,885,886};
-    static const std::vector<int> I_g8 = {1,882,883,884,885,886,887};
-    static const std::vector<int> I_g12 = {1,882,883,884,885,886,887,8881,889,8810,8811};
-
-    switch (gval){
-        case 4: return I_g4;
-        case 6: return I_g6;
-        case 7: return I_g7;
-        case 8: return I_g8;
-        case 12: return I_g12;
-        default: return dummy;
-    }
-}
+enum class InFmt {Auto, DB, Line, Pack};
 
 // ========== ✨ ADDED: Topology to TheoryGraph conversion ==========
 TheoryGraph topology_to_theory_graph(const Topology& T) {
@@ -100,7 +73,8 @@ TheoryGraph topology_to_theory_graph(const Topology& T) {
         instNodes.push_back(G.add(s(inst.param)));
     }
     
-    for (const auto& conn : T.l_connection) {
+    for (int k = 0; k < T.interiorEdgeCount(); ++k) {
+        const auto conn = T.interiorEdge(k);
         if (conn.u >= 0 && conn.u < (int)nodes.size() &&
             conn.v >= 0 && conn.v < (int)nodes.size()) {
             try {
@@ -137,11 +111,10 @@ TheoryGraph topology_to_theory_graph(const Topology& T) {
 }
 
 // ========== ✨ ADDED: Classification functions ==========
-bool is_LST(const TheoryGraph& G) {
+bool is_LST(const Eigen::MatrixXi& IF) {
     // LST: Little String Theory
     // Condition: Exactly ONE zero eigenvalue, all others negative
     try {
-        auto IF = G.ComposeIF_Gluing();
         if (IF.rows() == 0) return false;
         
         Tensor t;
@@ -170,11 +143,10 @@ bool is_LST(const TheoryGraph& G) {
     }
 }
 
-bool is_SCFT(const TheoryGraph& G) {
+bool is_SCFT(const Eigen::MatrixXi& IF) {
     // SCFT: Superconformal Field Theory
     // Condition: Negative definite (all eigenvalues negative)
     try {
-        auto IF = G.ComposeIF_Gluing();
         if (IF.rows() == 0) return false;
         
         Tensor t;
@@ -197,6 +169,14 @@ bool is_SCFT(const TheoryGraph& G) {
     }
 }
 
+bool is_LST(const TheoryGraph& G) {
+    try { return is_LST(G.ComposeIF_Gluing()); } catch (...) { return false; }
+}
+
+bool is_SCFT(const TheoryGraph& G) {
+    try { return is_SCFT(G.ComposeIF_Gluing()); } catch (...) { return false; }
+}
+
 // ========== Sharding utilities (✨ MODIFIED: added category parameter) ==========
 static std::string prefix_from(const Topology& T, int upto=4){
     std::string s; s.reserve(std::min<int>(upto, (int)T.block.size()));
@@ -211,75 +191,71 @@ static std::string prefix_from(const Topology& T, int upto=4){
     return s.empty() ? "empty" : s;
 }
 
-static std::string shard_path_with_category(const Topology& T, const std::string& outdir,
-                                            TargetSpec::PrefixMode mode, char kindTag, 
-                                            int u, const std::string& category)
+// 샤드 파일 이름 (<category>/len-<len>/<이것>.txt). PrefixMode에 따라 장식 종류 태그를 앞에 붙인다
+static std::string shard_prefix(const Topology& T, TargetSpec::PrefixMode mode, char kindTag, int u)
 {
-    const int len = (int)T.block.size();
     std::string pref = prefix_from(T, 4);
     const bool head = (u == 0);
-    
-    if (mode == TargetSpec::PrefixMode::Kind) 
-        pref = std::string(1, kindTag) + pref;
-    if (mode == TargetSpec::PrefixMode::HeadKind && head) 
-        pref = std::string(1, kindTag) + pref;
-
-    std::string dir = outdir + "/" + category + "/len-" + std::to_string(len);  // ✨ MODIFIED: added category subdir
-    std::filesystem::create_directories(dir);
-    return dir + "/" + pref + ".txt";
-}
-
-// ========== Parallel processing structure ==========
-struct OutputBuffer {
-    std::unordered_map<std::string, std::string> buffers;
-    std::mutex mtx;
-    std::atomic<size_t> total_size{0};
 
-    void append(const std::string& path, const std::string& line) {
-        std::lock_guard<std::mutex> lock(mtx);
-        buffers[path] += line + '\n';
-        total_size += line.size() + 1;
-    }
-
-    void flush_to_disk(const std::string& outDir) {
-        std::lock_guard<std::mutex> lock(mtx);
-        
-        for (auto& [path, content] : buffers) {
-            if (content.empty()) continue;
-            
-            std::filesystem::create_directories(std::filesystem::path(path).parent_path());
-            std::ofstream fout(path, std::ios::app);
-            fout.write(content.data(), content.size());
-        }
-        
-        buffers.clear();
-        total_size = 0;
-    }
-
-    size_t size() const { return total_size.load(); }
-};
+    if (mode == TargetSpec::PrefixMode::Kind ||
+        (mode == TargetSpec::PrefixMode::HeadKind && head))
+        pref.insert(pref.begin(), kindTag);
+    return pref;
+}
 
 // ========== Worker pool ==========
+// 후보 판정 결과 (param 하나당 한 번만 분류)
+enum class Verdict : signed char { Unknown, Other, LST, SCFT, Error };
+
 class WorkerPool {
 private:
+    // 룰셋별 카운터 (비트 0 = builtin)
+    struct RuleCounters {
+        std::atomic<long long> lst{0}, scft{0}, added{0}, removed{0};
+    };
+
+    // 스레드별 scratch: shape plan 캐시 + IF 버퍼 + 후보별 판정/룰셋 마스크
+    struct Scratch {
+        ShapePlanCache        plans;
+        Eigen::MatrixXi       IF;
+        std::vector<Verdict>  verdict;
+        std::vector<RuleMask> mask;
+        std::vector<DepCode>  deps;
+        std::string           line;            // line-compact 출력 버퍼 (재사용)
+        YieldSlot*            prof = nullptr;  // --profile (builtin 룰셋만 센다)
+        ShardPipe::Local      out;             // 스레드별 샤드 버퍼 (잠금 없이 쓰기 스레드로 넘긴다)
+
+        explicit Scratch(ShardPipe& pipe) : out(pipe) {}
+    };
+
     std::vector<std::thread> workers;
     std::queue<std::vector<Topology>> task_queue;
     std::mutex queue_mtx;
     std::condition_variable cv;
+    std::condition_variable space_cv;  // 큐에 자리가 났다 (읽는 쪽 back-pressure)
+    size_t max_queued;                 // 대기 배치 상한: 메모리는 DB 크기가 아니라 배치 수에 묶인다
     std::atomic<bool> stop{false};
     std::atomic<long long> processed{0};
     std::atomic<long long> saved{0};
     
-    OutputBuffer output_buffer;
-    const std::string outDir;
+    ShardPipe& pipe;
+    std::vector<ShardPipe::Id> diff_ids;     // 룰셋별 diff_vs_builtin.diff
     const TargetSpec& spec;
+    const RuleSetList& rules;
+    const DepSet* only;  // --incremental: 이 코드에 닿는 후보만 (nullptr = 전부)
+    YieldProfile* profile;
+    std::vector<RuleCounters> counters;
 
 public:
-    WorkerPool(int num_threads, const std::string& outDir_, const TargetSpec& spec_)
-        : outDir(outDir_), spec(spec_)
+    WorkerPool(int num_threads, ShardPipe& pipe_, const TargetSpec& spec_,
+               const RuleSetList& rules_, const DepSet* only_ = nullptr, YieldProfile* profile_ = nullptr)
+        : max_queued(2 * (size_t)std::max(1, num_threads)),
+          pipe(pipe_), spec(spec_), rules(rules_), only(only_), profile(profile_), counters(rules_.size())
     {
+        for (size_t r = 0; r < rules.size(); ++r)
+            diff_ids.push_back(pipe.id(rule_dir(r) + "diff_vs_builtin.diff"));
         for (int i = 0; i < num_threads; ++i) {
-            workers.emplace_back([this]() { worker_thread(); });
+            workers.emplace_back([this, i]() { worker_thread(i); });
         }
     }
 
@@ -289,12 +265,13 @@ public:
         for (auto& t : workers) {
             if (t.joinable()) t.join();
         }
-        output_buffer.flush_to_disk(outDir);
+        pipe.close();
     }
 
     void submit_batch(std::vector<Topology>&& batch) {
         {
-            std::lock_guard<std::mutex> lock(queue_mtx);
+            std::unique_lock<std::mutex> lock(queue_mtx);
+            space_cv.wait(lock, [this]() { return task_queue.size() < max_queued; });
             task_queue.push(std::move(batch));
         }
         cv.notify_one();
@@ -303,14 +280,30 @@ public:
     long long get_processed() const { return processed.load(); }
     long long get_saved() const { return saved.load(); }
 
-    void flush_if_needed() {
-        if (output_buffer.size() > BUFFER_SIZE) {
-            output_buffer.flush_to_disk(outDir);
+    std::vector<RuleTally> tally() const {
+        std::vector<RuleTally> out(counters.size());
+        for (size_t r = 0; r < counters.size(); ++r) {
+            out[r].lst     = counters[r].lst.load();
+            out[r].scft    = counters[r].scft.load();
+            out[r].added   = counters[r].added.load();
+            out[r].removed = counters[r].removed.load();
         }
+        return out;
     }
 
+    // 모든 배치가 끝난 뒤 (워커 버퍼는 배치마다 넘어갔다)
+    bool flush() { return pipe.close(); }
+
 private:
-    void worker_thread() {
+    // 룰셋이 하나면 기존 위치, 여러 개면 <outDir>/<룰셋 이름>/ (출력 루트 기준 접두어)
+    std::string rule_dir(size_t r) const {
+        return rules.multi() ? rules[r].name() + "/" : std::string();
+    }
+
+    void worker_thread(int tid) {
+        Scratch sc(pipe);
+        if (profile) sc.prof = &profile->slot(tid);
+
         while (!stop) {
             std::vector<Topology> batch;
             
@@ -324,87 +317,153 @@ private:
                 batch = std::move(task_queue.front());
                 task_queue.pop();
             }
+            space_cv.notify_one();
 
             for (const auto& base : batch) {
-                process_one(base);
+                process_one(base, sc);
             }
-            
+            // 배치 출력은 processed보다 먼저 큐에 (main은 processed를 보고 pipe를 닫는다)
+            sc.out.flush();
             processed += batch.size();
-            flush_if_needed();
         }
     }
 
-    void process_one(const Topology& base) {
-        for (int u = 0; u < (int)base.block.size(); ++u) {
+    void process_one(const Topology& base, Scratch& sc) {
+        // 본체가 이미 규칙을 어기면 어떤 장식도 통과할 수 없다 (룰셋별로)
+        RuleMask baseMask = 0;
+        for (size_t r = 0; r < rules.size(); ++r) {
+            const GlueStatus st = validate_topology(base, rules[r]);
+            if (st == GlueStatus::Ok) baseMask |= RuleMask(1) << r;
+            else if (r == 0 && sc.prof) {
+                const int g0 = base.block.empty() ? 0 : base.block[0].param;
+                sc.prof->tried('B', g0, 0);
+                sc.prof->reject('B', g0, 0, st);
+            }
+        }
+        if (!baseMask) return;
+
+        // 본체가 바뀐 코드에 닿으면 모든 후보를 다시 만든다
+        bool baseTouched = true;
+        if (only) {
+            record_deps(base, sc.deps);
+            baseTouched = touches(sc.deps, *only);
+        }
+
+        // 반사 대칭인 본체: 노드 u와 n-1-u의 장식은 서로의 반사 -> 왼쪽 절반만
+        const int nb = (int)base.block.size();
+        const bool halve = spec.canonical && spec.all_nodes && is_mirror_symmetric(base);
+
+        for (int u = 0; u < nb; ++u) {
             if (base.block[u].kind != LKind::g) continue;
             if (!spec.all_nodes && !spec.nodes.count(u)) continue;
+            if (halve && nb - 1 - u < u) break;
 
-            const int gval = base.block[u].param;
-
-            // S decoration
-            if (spec.do_S) {
-                const auto& Sbank = allowed_S_params(gval);
-                for (int sp : Sbank) {
-                    Topology t = base;
-                    t.addDecoration(LKind::S, sp, u);
-                    
-                    // ✨ ADDED: Classify and save only LST/SCFT
-                    try {
-                        TheoryGraph G = topology_to_theory_graph(t);
-                        std::string category;
-                        
-                        if (is_LST(G)) {
-                            category = "LST";
-                        } else if (is_SCFT(G)) {
-                            category = "SCFT";
-                        } else {
-                            continue; // ✨ ADDED: Skip if not LST or SCFT
-                        }
-                        
-                        std::string path = shard_path_with_category(t, outDir, spec.prefix, 'S', u, category);
-                        std::string line = serialize_line_compact(t);
-                        output_buffer.append(path, line);
-                        saved++;
-                    } catch (...) {
-                        // Failed to classify - skip
-                    }
-                }
+            if (spec.do_S) decorate(base, u, LKind::S, 0, baseMask, baseTouched, sc);
+            if (spec.do_I) decorate(base, u, LKind::I, MAX_DECO_PER_NODE, baseMask, baseTouched, sc);
+        }
+    }
+
+    // 노드 u에 kind 장식 하나씩 붙여 보기.
+    // 후보는 모든 룰셋 bank의 합집합이고, IF 조립/분류는 param마다 한 번.
+    // 룰셋마다 자기 bank 순서대로 걸으며 허용 비트를 세운다.
+    // cap > 0 이면 룰셋별로 cap개 슬롯까지만 (규칙 위반/조립 실패/저장이 슬롯을 쓰고, 비LST/SCFT는 안 쓴다)
+    // only가 있으면 바뀐 코드에 닿는 후보만 출력 (cap이 있으면 슬롯 계산을 위해 분류는 그대로).
+    void decorate(const Topology& base, int u, LKind kind, int cap, RuleMask baseMask,
+                  bool baseTouched, Scratch& sc) {
+        const int  gval = base.block[u].param;
+        const bool side = (kind == LKind::S);
+        const auto& cand = side ? rules.unionSBank(gval) : rules.unionIBank(gval);
+        if (cand.empty()) return;
+
+        const bool allNeeded = baseTouched || (!side && only->count(dep_code('I', gval)));
+        auto needed = [&](int p) { return allNeeded || only->count(dep_code('s', p)) != 0; };
+        const char kindTag = side ? 'S' : 'I';
+
+        sc.verdict.assign(cand.size(), Verdict::Unknown);
+        sc.mask.assign(cand.size(), 0);
+
+        auto classify = [&](int p) -> Verdict {
+            Topology t = base;
+            t.addDecoration(kind, p, u);
+            try {
+                // 같은 모양이면 plan 재사용: 장식 블록만 채워서 IF 조립 (규칙은 룰셋별로 이미 검사)
+                if (sc.plans.compose(t, sc.IF) != GlueStatus::Ok) return Verdict::Error;
+                if (is_LST(sc.IF))  return Verdict::LST;
+                if (is_SCFT(sc.IF)) return Verdict::SCFT;
+                return Verdict::Other;
+            } catch (...) {
+                return Verdict::Error;  // Failed to classify - skip
             }
+        };
+
+        for (size_t r = 0; r < rules.size(); ++r) {
+            if (!(baseMask >> r & 1)) continue;
+            const RuleSet& R = rules[r];
+            const auto& bank = side ? R.sBank(gval) : R.iBank(gval);
+            YieldSlot* prof = (r == 0) ? sc.prof : nullptr;
+
+            int decoCount = 0;
+            for (int p : bank) {
+                if (cap && decoCount >= cap) break;
+                if (!cap && !needed(p)) continue;
+
+                if (prof) prof->tried(kindTag, gval, p);
 
-            // I decoration
-            if (spec.do_I) {
-                const auto& Ibank = allowed_I_params(gval);
-                int decoCount = 0;
-                for (int ip : Ibank) {
-                    if (decoCount >= MAX_DECO_PER_NODE) break;
-                    
-                    Topology t = base;
-                    t.addDecoration(LKind::I, ip, u);
-                    
-                    // ✨ ADDED: Classify and save only LST/SCFT
-                    try {
-                        TheoryGraph G = topology_to_theory_graph(t);
-                        std::string category;
-                        
-                        if (is_LST(G)) {
-                            category = "LST";
-                        } else if (is_SCFT(G)) {
-                            category = "SCFT";
-                        } else {
-                            continue;  // ✨ ADDED: Skip if not LST or SCFT
-                        }
-                        
-                        std::string path = shard_path_with_category(t, outDir, spec.prefix, 'I', u, category);
-                        std::string line = serialize_line_compact(t);
-                        output_buffer.append(path, line);
-                        saved++;
-                    } catch (...) {
-                        // Failed to classify - skip
-                    }
-                    
+                // 텐서를 만들기 전에 새 간선의 규칙만 검사 (예외 없음)
+                const GlueStatus st = validate_decoration(base.block[u], p, R);
+                if (st != GlueStatus::Ok) {
+                    if (prof) prof->reject(kindTag, gval, p, st);
                     ++decoCount;
+                    continue;
                 }
+
+                const size_t k = std::find(cand.begin(), cand.end(), p) - cand.begin();
+                Verdict& v = sc.verdict[k];
+                if (v == Verdict::Unknown) v = classify(p);
+
+                if (prof) {
+                    prof->add(kindTag, gval, p, v == Verdict::Error ? kYieldError
+                                              : v == Verdict::Other ? kYieldNonPhysical
+                                              : v == Verdict::LST   ? kYieldLST : kYieldSCFT);
+                }
+                if (v == Verdict::Error) { ++decoCount; continue; }
+                if (v == Verdict::Other) continue;  // ✨ ADDED: Skip if not LST or SCFT
+
+                sc.mask[k] |= RuleMask(1) << r;
+                ++decoCount;
+            }
+        }
+
+        // 합집합 순서대로 출력 (룰셋이 하나면 기존 bank 순서 그대로)
+        for (size_t k = 0; k < cand.size(); ++k) {
+            const RuleMask m = sc.mask[k];
+            if (!m || !needed(cand[k])) continue;
+
+            Topology t = base;
+            t.addDecoration(kind, cand[k], u);
+            int uOut = u;
+            if (spec.canonical && canonicalize(t)) uOut = (int)t.block.size() - 1 - u;
+            const bool lst = (sc.verdict[k] == Verdict::LST);
+            const std::string category = lst ? "LST" : "SCFT";
+            std::string& line = sc.line;
+            line.clear();
+            append_line_compact(line, t);
+
+            for (size_t r = 0; r < rules.size(); ++r) {
+                const bool inR = (m >> r) & 1, inB = m & 1;
+                if (inR) {
+                    const ShardPipe::Id id = sc.out.shard(rule_dir(r), category, (int)t.block.size(),
+                                                          shard_prefix(t, spec.prefix, kindTag, uOut));
+                    if (spec.norm) sc.out.append_norm(id, t);
+                    else           sc.out.append_line(id, line);
+                    ++(lst ? counters[r].lst : counters[r].scft);
+                }
+                if (r == 0 || inR == inB) continue;
+                // builtin 대비 차이: + 이 룰셋에만, - builtin에만
+                sc.out.append_line(diff_ids[r], std::string(inR ? "+ " : "- ") + category + " " + line);
+                ++(inR ? counters[r].added : counters[r].removed);
             }
+            saved++;
         }
     }
 };
@@ -413,6 +472,7 @@ private:
 static InFmt parse_infmt(const std::string& s){
     if (s == "db") return InFmt::DB;
     if (s == "line") return InFmt::Line;
+    if (s == "pack") return InFmt::Pack;
     return InFmt::Auto;
 }
 
@@ -449,27 +509,17 @@ static TargetSpec::PrefixMode parse_prefix_arg(const std::string& arg){
     return TargetSpec::PrefixMode::None;
 }
 
-// ========== Line file processing ==========
-static long long process_line_file(const std::string& path, WorkerPool& pool){
-    std::ifstream fin(path);
-    if (!fin) {
-        std::cerr << "[skip] cannot open " << path << "\n";
-        return 0;
-    }
-
+// ========== Input feeding ==========
+// 커서에서 BATCH_SIZE씩 묶어 풀에 넘긴다 (풀 큐가 차면 submit_batch가 기다린다)
+static long long feed_cursor(TopologyCursor& cur, WorkerPool& pool){
     std::vector<Topology> batch;
     batch.reserve(BATCH_SIZE);
     long long total = 0;
-    std::string line;
+    Topology T;
+
+    while (cur.next(T)) {
+        batch.push_back(T);
 
-    while (std::getline(fin, line)) {
-        if (line.empty()) continue;
-        
-        Topology T;
-        if (!deserialize_line_compact(line, T)) continue;
-        
-        batch.push_back(std::move(T));
-        
         if (batch.size() >= BATCH_SIZE) {
             pool.submit_batch(std::move(batch));
             batch.clear();
@@ -490,6 +540,16 @@ static long long process_line_file(const std::string& path, WorkerPool& pool){
     return total;
 }
 
+// ========== Line file processing ==========
+static long long process_line_file(const std::string& path, WorkerPool& pool){
+    TopologyCursor cur(path, TopologyCursor::Format::Line);
+    if (!cur.ok()) {
+        std::cerr << "[skip] cannot open " << path << "\n";
+        return 0;
+    }
+    return feed_cursor(cur, pool);
+}
+
 static long long process_line_path(const std::string& inPath, WorkerPool& pool){
     long long total = 0;
     if (std::filesystem::is_directory(inPath)) {
@@ -505,36 +565,73 @@ static long long process_line_path(const std::string& inPath, WorkerPool& pool){
     return total;
 }
 
+// ========== Pack processing ==========
+// 팩의 논리 샤드(.txt 키)를 파일처럼 차례로 읽는다
+static long long process_pack(const std::string& packPath, WorkerPool& pool){
+    PackReader pack(packPath);
+    if (!pack.ok()) {
+        std::cerr << "[skip] cannot open pack " << packPath << "\n";
+        return 0;
+    }
+    pack.adviseSequential();
+    long long total = 0;
+    TopologyCursor cur;
+    for (const auto& [key, ext] : pack.directory()) {
+        if (std::filesystem::path(key).extension() != ".txt") continue;
+        std::cout << "Processing: " << key << "\n";
+        cur.openSpans(pack.spans(key));
+        total += feed_cursor(cur, pool);
+    }
+    return total;
+}
+
 // ========== DB processing ==========
+// 본 파일 + manifest의 세그먼트
 static long long process_db(const std::string& dbPath, WorkerPool& pool){
-    TopologyDB db(dbPath);
-    auto recs = db.loadAll();
-    
-    std::vector<Topology> batch;
-    batch.reserve(BATCH_SIZE);
     long long total = 0;
+    for (const auto& part : TopologyDB(dbPath).parts()) {
+        TopologyCursor cur = TopologyCursor::openDB(part);
+        total += feed_cursor(cur, pool);
+    }
+    return total;
+}
 
-    for (auto& rec : recs) {
-        batch.push_back(std::move(rec.topo));
-        
-        if (batch.size() >= BATCH_SIZE) {
-            pool.submit_batch(std::move(batch));
-            batch.clear();
-            batch.reserve(BATCH_SIZE);
-            total += BATCH_SIZE;
-            
-            if (total % 50000 == 0) {
-                std::cout << "Read " << total << " topologies...\r" << std::flush;
+// ========== Incremental ==========
+// 바뀐 코드에 닿는 레코드만 기존 shard에서 지운다 (나머지는 그대로 둔다)
+static long long prune_line_shards(const std::string& root, const DepSet& changed){
+    long long dropped = 0;
+    std::vector<DepCode> deps;
+    for (auto& e : std::filesystem::recursive_directory_iterator(root)) {
+        if (!e.is_regular_file() || e.path().extension() != ".txt") continue;
+
+        std::ifstream fin(e.path());
+        std::string kept, line;
+        long long n = 0;
+        LineNormDecoder norm;   // 정규화 shard: B 줄은 그대로 두고 레코드만 거른다
+        Topology T;
+        while (std::getline(fin, line)) {
+            if (line.empty()) continue;
+            if (LineNormDecoder::isBaseLine(line)) {
+                norm.define(line);
+            } else if (norm.decode(line, T) == LineStatus::Ok) {
+                record_deps(T, deps);
+                if (touches(deps, changed)) { ++n; continue; }
             }
+            kept += line;
+            kept += '\n';
         }
-    }
+        fin.close();
+        if (n == 0) continue;
 
-    if (!batch.empty()) {
-        total += batch.size();
-        pool.submit_batch(std::move(batch));
+        const std::string path = e.path().string(), tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            out.write(kept.data(), kept.size());
+        }
+        std::filesystem::rename(tmp, path);
+        dropped += n;
     }
-
-    return total;
+    return dropped;
 }
 
 // ========== Main ==========
@@ -542,12 +639,28 @@ int main(int argc, char** argv)
 {
     if (argc < 3) {
         std::cerr << "usage: " << argv[0] << " <input> <out_dir> "
-                  << "[--in auto|db|line] "
+                  << "[--in auto|db|line|pack] "
                   << "[--nodes all|head|0,2,5] "
                   << "[--kinds S|I|S,I] "
                   << "[--prefix none|kind|head-kind] "
-                  << "[--threads N]\n";
+                  << "[--threads N] "
+                  << "[--rules file.rules ...] "
+                  << "[--incremental] "
+                  << "[--profile report.json] "
+                  << "[--canonical] "
+                  << "[--norm] "
+                  << "[--out-pack file.pack]\n";
         std::cerr << "\nGenerates decorated topologies and saves only LST and SCFT.\n";
+        std::cerr << "--rules: evaluate extra rule sets in the same pass (repeatable); outputs go to\n"
+                  << "         <out_dir>/<rule set name>/ with diff_vs_builtin.diff and rules_report.tsv\n";
+        std::cerr << "--incremental: compare with <out_dir>/rules.stamp and regenerate only records\n"
+                  << "         whose codes (g / L / side / I bank) changed\n";
+        std::cerr << "--canonical: write each decorated chain in mirror-canonical form; on mirror-symmetric\n"
+                  << "         bases only the left half of the nodes is decorated\n";
+        std::cerr << "--norm: write each shard as a base table (B lines) plus decoration records (D lines)\n"
+                  << "         instead of repeating the chain on every line; all readers accept both\n";
+        std::cerr << "--out-pack: write the shards as logical shards of one pack file (appendable; see shard_pack);\n"
+                  << "         stamps and reports still go to <out_dir>\n";
         return 1;
     }
 
@@ -555,6 +668,9 @@ int main(int argc, char** argv)
     const std::string outDir = argv[2];
 
     TargetSpec Tspec;
+    RuleSetList rules;
+    bool incremental = false;
+    std::string profilePath, packPath;
     InFmt inFmt = InFmt::Auto;
     int num_threads = std::thread::hardware_concurrency();
     if (num_threads == 0) num_threads = 4;
@@ -568,14 +684,79 @@ int main(int argc, char** argv)
         if (a == "--prefix" && need(i)) { Tspec.prefix = parse_prefix_arg(argv[++i]); continue; }
         if (a == "--in" && need(i)) { inFmt = parse_infmt(argv[++i]); continue; }
         if (a == "--threads" && need(i)) { num_threads = std::stoi(argv[++i]); continue; }
+        if (a == "--incremental") { incremental = true; continue; }
+        if (a == "--canonical") { Tspec.canonical = true; continue; }
+        if (a == "--norm") { Tspec.norm = true; continue; }
+        if (a == "--profile" && need(i)) { profilePath = argv[++i]; continue; }
+        if (a == "--out-pack" && need(i)) { packPath = argv[++i]; continue; }
+        if (a == "--rules" && need(i)) {
+            try {
+                rules.add(RuleSet::load(argv[++i]));
+            } catch (const std::exception& e) {
+                std::cerr << "[Error] " << e.what() << "\n";
+                return 1;
+            }
+            continue;
+        }
     }
 
     std::filesystem::create_directories(outDir);
 
+    // 룰셋별 출력 루트와 규칙 지문
+    auto rule_root = [&](size_t r) { return rules.multi() ? outDir + "/" + rules[r].name() : outDir; };
+    std::vector<RuleStamp> stamps;
+    for (size_t r = 0; r < rules.size(); ++r) stamps.push_back(RuleStamp::compute(rules[r]));
+
+    DepSet changed;
+    const DepSet* only = nullptr;
+    if (incremental) {
+        RuleStamp old;
+        const std::string stampPath = outDir + "/" + RuleStamp::kFileName;
+        if (rules.multi()) {
+            std::cerr << "[Error] --incremental cannot be combined with --rules\n";
+            return 1;
+        } else if (!packPath.empty()) {
+            std::cerr << "[Error] --incremental cannot be combined with --out-pack\n";
+            return 1;
+        } else if (!RuleStamp::load(stampPath, old)) {
+            std::cerr << "[warn] no " << stampPath << "; running a full pass\n";
+        } else {
+            changed = stamps[0].changedSince(old);
+            if (changed.empty()) {
+                std::cout << "Rules unchanged since last run; nothing to regenerate.\n";
+                return 0;
+            }
+            std::vector<DepCode> list(changed.begin(), changed.end());
+            std::sort(list.begin(), list.end());
+            std::cout << "Changed codes (" << list.size() << "):";
+            for (DepCode c : list) std::cout << " " << dep_name(c);
+            std::cout << "\n";
+            const long long dropped = prune_line_shards(outDir, changed);
+            std::cout << "Dropped " << dropped << " stale records; regenerating affected ones.\n";
+            only = &changed;
+        }
+    }
+
     std::cout << "Starting with " << num_threads << " threads...\n";
     std::cout << "Will save only LST and SCFT topologies.\n";
+    if (rules.multi()) {
+        std::cout << "Rule sets:";
+        for (size_t r = 0; r < rules.size(); ++r) std::cout << " " << rules[r].name();
+        std::cout << "\n";
+    }
     
-    WorkerPool pool(num_threads, outDir, Tspec);
+    std::unique_ptr<YieldProfile> profile;
+    if (!profilePath.empty()) profile = std::make_unique<YieldProfile>(num_threads);
+
+    PackWriter pack;
+    if (!packPath.empty() && !pack.open(packPath)) {
+        std::cerr << "[Error] cannot open pack " << packPath << "\n";
+        return 1;
+    }
+
+    ShardWriter out(outDir, pack.ok() ? &pack : nullptr);
+    ShardPipe pipe(out);
+    WorkerPool pool(num_threads, pipe, Tspec, rules, only, profile.get());
     
     auto start = std::chrono::high_resolution_clock::now();
     long long input_count = 0;
@@ -584,9 +765,13 @@ int main(int argc, char** argv)
         input_count = process_db(inPath, pool);
     } else if (inFmt == InFmt::Line) {
         input_count = process_line_path(inPath, pool);
+    } else if (inFmt == InFmt::Pack) {
+        input_count = process_pack(inPath, pool);
     } else {
         if (std::filesystem::is_directory(inPath)) {
             input_count = process_line_path(inPath, pool);
+        } else if (PackReader::isPack(inPath)) {
+            input_count = process_pack(inPath, pool);
         } else {
             try {
                 input_count = process_db(inPath, pool);
@@ -610,6 +795,33 @@ int main(int argc, char** argv)
     std::cout << "Input: " << input_count << " topologies\n";
     std::cout << "Processed: " << pool.get_processed() << " topologies\n";
     std::cout << "Saved (LST/SCFT only): " << pool.get_saved() << " topologies\n";
+    if (rules.multi()) {
+        const auto tally = pool.tally();
+        std::cout << "Rule sets (LST / SCFT / +added / -removed vs builtin):\n";
+        for (size_t r = 0; r < rules.size(); ++r) {
+            std::cout << "  " << rules[r].name() << ": " << tally[r].lst << " / " << tally[r].scft
+                      << " / +" << tally[r].added << " / -" << tally[r].removed << "\n";
+        }
+        if (!write_rule_report(outDir + "/rules_report.tsv", rules, tally))
+            std::cerr << "[warn] cannot write " << outDir << "/rules_report.tsv\n";
+    }
+    // 출력이 디스크에 내려간 뒤에 stamp를 남긴다
+    if (!pool.flush()) {
+        std::cerr << "[Error] failed to write output under " << outDir << "\n";
+        return 1;
+    }
+    if (pack.ok() && !pack.close()) {
+        std::cerr << "[Error] failed to write pack " << packPath << "\n";
+        return 1;
+    }
+    for (size_t r = 0; r < rules.size(); ++r) {
+        const std::string stampPath = rule_root(r) + "/" + RuleStamp::kFileName;
+        if (!stamps[r].save(stampPath)) std::cerr << "[warn] cannot write " << stampPath << "\n";
+    }
+    if (profile) {
+        if (profile->writeJson(profilePath, "decorate_generator")) std::cout << "Profile: " << profilePath << "\n";
+        else std::cerr << "[warn] cannot write " << profilePath << "\n";
+    }
     std::cout << "Time: " << duration << " seconds\n";
     std::cout << "Output dir: " << outDir << "\n";
 
@@ -0,0 +1,82 @@
+// if_convert.cpp — classify IF 출력: 바이너리(.ifb) <-> 텍스트(.txt)
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include "IFCodec.hpp"
+#include "MappedFile.hpp"
+#include "FileUtil.hpp"
+
+namespace fs = std::filesystem;
+
+// .ifb -> 텍스트 (행렬마다 행들 + 빈 줄, 기존 *_IF_*.txt와 같음)
+static long long ifb_to_text(const std::string& in, const std::string& out){
+    IFBinFile f(in);
+    if (!f.ok()){ std::cerr << "cannot open " << in << "\n"; return -1; }
+    f.adviseSequential();
+    AtomicOutFile o(out);
+    Eigen::MatrixXi M;
+    std::string buf;
+    for (std::size_t k = 0; k < f.size(); ++k){
+        if (!f.read(k, M)){ std::cerr << "[Error] bad record " << k << " in " << in << "\n"; return -1; }
+        append_if_text(buf, M);
+        if (buf.size() >= (1u << 20)){ o.stream().write(buf.data(), (std::streamsize)buf.size()); buf.clear(); }
+    }
+    o.stream().write(buf.data(), (std::streamsize)buf.size());
+    return o.commit() ? (long long)f.size() : -1;
+}
+
+// 텍스트 -> .ifb + .ifx
+static long long text_to_ifb(const std::string& in, const std::string& out){
+    MappedFile f(in);
+    if (!f.is_open()){ std::cerr << "cannot open " << in << "\n"; return -1; }
+    f.adviseSequential();
+    std::string_view rest(f.data(), f.size());
+    std::string data(ifbin::kMagic, ifbin::kHeaderSize), idx;
+    Eigen::MatrixXi M;
+    long long n = 0;
+    for (;;){
+        const IFStatus st = parse_if_text(rest, M);
+        if (st == IFStatus::End) break;
+        if (st != IFStatus::Ok){ std::cerr << "[Error] bad matrix " << n << " in " << in << "\n"; return -1; }
+        const std::uint64_t at = data.size();
+        idx.append(reinterpret_cast<const char*>(&at), sizeof at);
+        append_if_binary(data, M);
+        ++n;
+    }
+    AtomicOutFile o(out), x(ifb_index_path(out));
+    o.stream().write(data.data(), (std::streamsize)data.size());
+    x.stream().write(idx.data(), (std::streamsize)idx.size());
+    return o.commit() && x.commit() ? n : -1;
+}
+
+// 형식은 내용(magic)으로 보고, 출력 이름은 확장자만 바꾼다
+static long long convert(const fs::path& in, const fs::path& out){
+    const bool bin = IFBinFile::isBinary(in.string());
+    const long long n = bin ? ifb_to_text(in.string(), out.string()) : text_to_ifb(in.string(), out.string());
+    if (n >= 0) std::cout << in.string() << " -> " << out.string() << " (" << n << " matrices)\n";
+    return n;
+}
+
+int main(int argc, char** argv){
+    if (argc != 3){
+        std::cerr << "usage: " << argv[0] << " <in.ifb|in.txt|dir> <out>\n";
+        std::cerr << "  .ifb (binary, see IFCodec.hpp) -> dense text; text -> .ifb + .ifx index\n";
+        std::cerr << "  dir: converts every *_IF_*.ifb / *_IF_*.txt into <out>/ with the other extension\n";
+        return 1;
+    }
+    const fs::path in = argv[1], out = argv[2];
+    if (!fs::is_directory(in)) return convert(in, out) < 0 ? 1 : 0;
+
+    fs::create_directories(out);
+    int failed = 0;
+    for (const auto& e : fs::directory_iterator(in)){
+        const auto ext = e.path().extension();
+        if (!e.is_regular_file() || (ext != ".ifb" && ext != ".txt")
+            || e.path().filename().string().find("_IF_") == std::string::npos) continue;
+        fs::path dst = out / e.path().filename();
+        dst.replace_extension(ext == ".ifb" ? ".txt" : ".ifb");
+        if (convert(e.path(), dst) < 0) ++failed;
+    }
+    return failed ? 1 : 0;
+}
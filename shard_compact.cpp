@@ -0,0 +1,320 @@
+// shard_compact.cpp — 생성기 출력 트리의 샤드(<cat>/len-N/<prefix>.txt)를 정렬 + 중복 제거 + 성긴 인덱스로 다시 쓴다
+// topology_generator / decorate_generator는 샤드를 덧붙이기로 열기 때문에, 다시 돌리거나 나눠 돌리면
+// 정렬 안 된 중복 레코드가 쌓인다. 샤드마다:
+//   1) 메모리 예산만큼씩 읽어 (장식 정렬 후) compare_topology 순으로 정렬한 run을 만들고
+//   2) run이 여럿이면 <shard>.compact.N.tmp로 흘려 쓴 뒤 k-way 병합,
+//   3) 같은 레코드는 하나만 남겨 AtomicOutFile로 교체하고 <shard>.sidx(ShardIndex)를 쓴다.
+// 샤드끼리는 독립이므로 스레드마다 샤드를 하나씩 가져간다 (큰 것부터). 생성기가 쓰는 중에는 돌리지 말 것.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "Topology.h"
+#include "TopologyCursor.hpp"
+#include "TopoLineCompact.hpp"
+#include "TopoCanonical.hpp"
+#include "ShardIndex.hpp"
+#include "MappedFile.hpp"
+#include "FileUtil.hpp"
+
+namespace fs = std::filesystem;
+
+struct CompactOptions {
+    int           threads = 0;
+    std::size_t   memBytes = 512u << 20;   // 전체 예산 (스레드마다 memBytes / threads)
+    std::uint32_t stride = 256;            // 인덱스 블록 크기 (레코드 수)
+    bool          force = false;           // 인덱스가 맞아도 다시 쓴다
+};
+
+struct CompactStats {
+    std::size_t   shards = 0, skipped = 0, failed = 0, spilled = 0;
+    std::uint64_t in = 0, out = 0, bytesIn = 0, bytesOut = 0;
+    void add(const CompactStats& o){
+        shards += o.shards; skipped += o.skipped; failed += o.failed; spilled += o.spilled;
+        in += o.in; out += o.out; bytesIn += o.bytesIn; bytesOut += o.bytesOut;
+    }
+};
+
+// 레코드 하나가 run에서 차지하는 대략의 바이트 (Topology 인라인 버퍼 + 정렬 순서)
+static constexpr std::size_t kRecordBytes = sizeof(Topology) + 16;
+
+static std::uint64_t file_bytes(const fs::path& p){
+    std::error_code ec;
+    const auto n = fs::file_size(p, ec);
+    return ec ? 0 : (std::uint64_t)n;
+}
+
+// "512M", "2G", "65536"
+static bool parse_bytes(const std::string& s, std::size_t& out){
+    char* end = nullptr;
+    const double v = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || v <= 0) return false;
+    double mul = 1;
+    switch (*end) {
+        case 'k': case 'K': mul = 1024.0; break;
+        case 'm': case 'M': mul = 1024.0 * 1024; break;
+        case 'g': case 'G': mul = 1024.0 * 1024 * 1024; break;
+        case '\0': break;
+        default: return false;
+    }
+    out = (std::size_t)(v * mul);
+    return true;
+}
+
+// 정규화(B/D) 샤드인지: B 줄이 하나라도 있으면 출력도 정규화로 쓴다
+static bool has_base_lines(const std::string& path){
+    MappedFile f(path);
+    if (!f.is_open() || f.size() == 0) return false;
+    const char* d = f.data();
+    if (d[0] == 'B') return true;
+    static const char pat[2] = {'\n', 'B'};
+    return memmem(d, f.size(), pat, sizeof pat) != nullptr;
+}
+
+// 생성기 샤드: .../len-N/<prefix>.txt (IF 덤프 등 다른 .txt는 제외)
+static std::vector<fs::path> collect_shards(const std::string& root){
+    std::vector<fs::path> out;
+    for (const auto& e : fs::recursive_directory_iterator(root)){
+        if (!e.is_regular_file() || e.path().extension() != ".txt") continue;
+        if (e.path().parent_path().filename().string().rfind("len-", 0) != 0) continue;
+        if (e.path().filename().string().find("_IF_") != std::string::npos) continue;
+        out.push_back(e.path());
+    }
+    return out;
+}
+
+// ===== 출력: 중복 제거 + stride마다 인덱스 오프셋 =====
+class ShardSink {
+public:
+    ShardSink(const std::string& path, bool norm, std::uint32_t stride)
+        : file_(path), norm_(norm), stride_(stride) {}
+
+    bool ok() const noexcept { return file_.ok(); }
+
+    // 정렬 순서로 넘길 것. 바로 앞과 같으면 버린다
+    void add(const Topology& T){
+        if (n_ > 0 && compare_topology(last_, T) == 0) return;
+        if (n_ % stride_ == 0) {
+            offs_.push_back(written_ + buf_.size());
+            enc_.reset();   // 블록마다 B 줄부터: 인덱스 오프셋에서 혼자 풀린다
+        }
+        if (norm_) enc_.append(buf_, T);
+        else     { append_line_compact(buf_, T); buf_ += '\n'; }
+        last_ = T;
+        ++n_;
+        if (buf_.size() >= (1u << 20)) drain();
+    }
+
+    bool commit(){
+        drain();
+        return file_.commit();
+    }
+
+    std::uint64_t records() const noexcept { return n_; }
+    std::uint64_t bytes() const noexcept { return written_; }
+    const std::vector<std::uint64_t>& offsets() const noexcept { return offs_; }
+
+private:
+    void drain(){
+        file_.stream().write(buf_.data(), (std::streamsize)buf_.size());
+        written_ += buf_.size();
+        buf_.clear();
+    }
+
+    AtomicOutFile              file_;
+    bool                       norm_;
+    std::uint32_t              stride_;
+    LineNormEncoder            enc_;
+    std::string                buf_;
+    std::uint64_t              written_ = 0, n_ = 0;
+    std::vector<std::uint64_t> offs_;
+    Topology                   last_;
+};
+
+// run 정렬 (Topology는 크므로 번호만 옮긴다)
+static void sort_run(const std::vector<Topology>& run, std::vector<std::uint32_t>& order){
+    order.resize(run.size());
+    for (std::uint32_t i = 0; i < (std::uint32_t)run.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b){
+        return compare_topology(run[a], run[b]) < 0;
+    });
+}
+
+// 흘려 쓴 run 파일들. 끝나면 (실패해도) 지운다
+struct SpillFiles {
+    std::vector<std::string> paths;
+    ~SpillFiles(){
+        std::error_code ec;
+        for (const auto& p : paths) fs::remove(p, ec);
+    }
+};
+
+// run 하나를 평범한 line-compact로 (run 안의 중복은 여기서 뺀다)
+static bool spill_run(const std::vector<Topology>& run, const std::string& path){
+    std::vector<std::uint32_t> order;
+    sort_run(run, order);
+    ShardSink sink(path, false, 0xffffffffu);
+    if (!sink.ok()) return false;
+    for (const std::uint32_t i : order) sink.add(run[i]);
+    return sink.commit();
+}
+
+// ===== 샤드 하나 =====
+static bool compact_shard(const fs::path& shard, const CompactOptions& opt, std::size_t budget, CompactStats& st){
+    const std::string path = shard.string();
+    if (!opt.force) {
+        ShardIndex idx;
+        if (idx.open(path)) { ++st.skipped; return true; }   // 이미 정렬 + 인덱스, 그 뒤로 덧붙인 것 없음
+    }
+
+    const bool norm = has_base_lines(path);
+    const std::size_t perRun = std::max<std::size_t>(1024, budget / kRecordBytes);
+    const std::uint64_t bytesIn = file_bytes(shard);
+
+    TopologyCursor cur(path, TopologyCursor::Format::Line);
+    if (!cur.ok()) { std::cerr << "[skip] cannot open " << path << "\n"; ++st.failed; return false; }
+
+    std::vector<Topology> run;
+    SpillFiles spills;
+    Topology T;
+    std::uint64_t in = 0;
+    while (cur.advance()) {
+        // 깨진 줄이 있으면 버리지 않고 샤드를 그대로 둔다
+        if (!cur.decode(T)) {
+            std::cerr << "[skip] bad record " << cur.index() << " in " << path << "\n";
+            ++st.failed;
+            return false;
+        }
+        sort_decorations(T);
+        run.push_back(T);
+        ++in;
+        if (run.size() >= perRun) {
+            spills.paths.push_back(path + ".compact." + std::to_string(spills.paths.size()) + ".tmp");
+            if (!spill_run(run, spills.paths.back())) {
+                std::cerr << "[skip] cannot write " << spills.paths.back() << "\n";
+                ++st.failed;
+                return false;
+            }
+            run.clear();
+        }
+    }
+
+    ShardSink sink(path, norm, opt.stride);
+    if (!sink.ok()) { std::cerr << "[skip] cannot write " << path << "\n"; ++st.failed; return false; }
+
+    if (spills.paths.empty()) {
+        std::vector<std::uint32_t> order;
+        sort_run(run, order);
+        for (const std::uint32_t i : order) sink.add(run[i]);
+    } else {
+        if (!run.empty()) {
+            spills.paths.push_back(path + ".compact." + std::to_string(spills.paths.size()) + ".tmp");
+            if (!spill_run(run, spills.paths.back())) { ++st.failed; return false; }
+        }
+        std::vector<Topology>().swap(run);
+
+        // k-way 병합: run마다 커서 하나, 머리 레코드를 힙으로
+        const std::size_t k = spills.paths.size();
+        std::vector<TopologyCursor> runs(k);
+        std::vector<Topology> head(k);
+        auto greater = [&](std::size_t a, std::size_t b){ return compare_topology(head[a], head[b]) > 0; };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+        for (std::size_t r = 0; r < k; ++r) {
+            if (!runs[r].open(spills.paths[r], TopologyCursor::Format::Line)) { ++st.failed; return false; }
+            if (runs[r].next(head[r])) heap.push(r);
+        }
+        while (!heap.empty()) {
+            const std::size_t r = heap.top();
+            heap.pop();
+            sink.add(head[r]);
+            if (runs[r].next(head[r])) heap.push(r);
+        }
+        st.spilled += k;
+    }
+
+    if (!sink.commit()) { std::cerr << "[skip] cannot write " << path << "\n"; ++st.failed; return false; }
+    if (!ShardIndex::write(path, opt.stride, sink.records(), sink.bytes(), sink.offsets()))
+        std::cerr << "[warn] cannot write index for " << path << "\n";
+
+    ++st.shards;
+    st.in += in;
+    st.out += sink.records();
+    st.bytesIn += bytesIn;
+    st.bytesOut += sink.bytes();
+    return true;
+}
+
+int main(int argc, char** argv){
+    if (argc < 2){
+        std::cerr << "usage: " << argv[0] << " <out-tree> [--threads N] [--mem BYTES] [--stride K] [--force]\n";
+        std::cerr << "  Rewrites every generator shard (<cat>/len-N/<prefix>.txt) sorted in compare_topology order\n"
+                  << "  (decorations sorted), drops duplicate records and writes a sparse offset index <shard>.sidx.\n";
+        std::cerr << "  --mem:    total memory budget across threads (default 512M); larger shards are sorted\n"
+                  << "            in runs spilled to <shard>.compact.N.tmp and k-way merged\n";
+        std::cerr << "  --stride: records per index block (default 256)\n";
+        std::cerr << "  --force:  also rewrite shards whose index is still valid (nothing appended since)\n";
+        return 1;
+    }
+    const std::string root = argv[1];
+    CompactOptions opt;
+    for (int i = 2; i < argc; ++i){
+        const std::string a = argv[i];
+        if (a == "--threads" && i+1 < argc){
+            opt.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (a == "--mem" && i+1 < argc){
+            if (!parse_bytes(argv[++i], opt.memBytes)){ std::cerr << "[Error] bad --mem " << argv[i] << "\n"; return 1; }
+        } else if (a == "--stride" && i+1 < argc){
+            opt.stride = (std::uint32_t)std::max(1, std::atoi(argv[++i]));
+        } else if (a == "--force"){
+            opt.force = true;
+        }
+    }
+    if (!fs::is_directory(root)){ std::cerr << "[Error] not a directory: " << root << "\n"; return 1; }
+    if (opt.threads <= 0){
+        const unsigned n = std::thread::hardware_concurrency();
+        opt.threads = n ? (int)n : 4;
+    }
+
+    // 큰 샤드부터 나눠 줘야 마지막에 한 스레드만 남는 일이 적다
+    std::vector<fs::path> shards = collect_shards(root);
+    std::vector<std::pair<std::uint64_t, std::size_t>> bySize;
+    for (std::size_t i = 0; i < shards.size(); ++i) bySize.push_back({file_bytes(shards[i]), i});
+    std::sort(bySize.begin(), bySize.end(), [](const auto& a, const auto& b){ return a.first > b.first; });
+
+    const int threads = (int)std::min<std::size_t>((std::size_t)opt.threads, std::max<std::size_t>(1, shards.size()));
+    const std::size_t budget = opt.memBytes / (std::size_t)threads;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    CompactStats total;
+    std::mutex mu;
+    std::atomic<std::size_t> next{0};
+    auto work = [&]{
+        CompactStats st;
+        for (std::size_t k; (k = next.fetch_add(1)) < bySize.size(); )
+            compact_shard(shards[bySize[k].second], opt, budget, st);
+        std::lock_guard<std::mutex> lk(mu);
+        total.add(st);
+    };
+    if (threads == 1) {
+        work();
+    } else {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t) pool.emplace_back(work);
+        for (auto& t : pool) t.join();
+    }
+
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Shards: " << total.shards << " compacted | " << total.skipped << " already compact | "
+              << total.failed << " failed | " << total.spilled << " spill runs\n";
+    std::cout << "Records: " << total.in << " -> " << total.out << " (" << (total.in - total.out) << " duplicates dropped)\n";
+    std::cout << "Bytes: " << total.bytesIn << " -> " << total.bytesOut
+              << " | Threads: " << threads << " | " << sec << " s\n";
+    return total.failed ? 1 : 0;
+}
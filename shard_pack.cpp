@@ -0,0 +1,129 @@
+// shard_pack.cpp — 샤드 트리 <-> 팩 파일 (PackFile.hpp)
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include "PackFile.hpp"
+
+namespace fs = std::filesystem;
+
+// 팩 키가 출력 디렉터리 밖을 가리키지 않는지 (절대 경로, "..")
+static bool safe_key(const std::string& key){
+    const fs::path p(key);
+    if (key.empty() || p.is_absolute()) return false;
+    for (const auto& part : p) if (part == "..") return false;
+    return true;
+}
+
+// 줄 단위 텍스트 키 (.txt 샤드, .deps, .diff): 청크가 줄 경계에서 끝나야 커서가 조각별로 읽는다.
+// 나머지(.ifb/.ifx 같은 바이너리, 보고서)는 바이트 그대로
+static bool line_key(const fs::path& p){
+    const auto ext = p.extension();
+    return ext == ".txt" || ext == ".deps" || ext == ".diff";
+}
+
+static bool read_file(const fs::path& p, std::string& buf){
+    std::ifstream in(p, std::ios::binary);
+    buf.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return in.good() || in.eof();
+}
+
+// 디렉터리 아래 파일을 전부 (상대 경로 = 키) 팩에 붙인다. 같은 키가 있으면 그 뒤에 이어진다
+static int do_pack(const std::string& dir, const std::string& packPath){
+    PackWriter pack;
+    if (!pack.open(packPath)){ std::cerr << "cannot open pack " << packPath << "\n"; return 1; }
+    long long files = 0, bytes = 0;
+    std::string buf;
+    for (const auto& e : fs::recursive_directory_iterator(dir)){
+        if (!e.is_regular_file()) continue;
+        if (!read_file(e.path(), buf)){ std::cerr << "cannot read " << e.path().string() << "\n"; return 1; }
+        if (line_key(e.path()) && !buf.empty() && buf.back() != '\n') buf += '\n';
+        if (!pack.append(fs::relative(e.path(), dir).generic_string(), buf)){
+            std::cerr << "cannot write pack " << packPath << "\n";
+            return 1;
+        }
+        ++files;
+        bytes += (long long)buf.size();
+    }
+    if (!pack.close()){ std::cerr << "cannot write pack " << packPath << "\n"; return 1; }
+    std::cout << "Packed " << files << " files (" << bytes << " bytes) into " << packPath << "\n";
+    return 0;
+}
+
+// 논리 샤드마다 <dir>/<key> 로 풀기 (있는 파일은 덮어쓴다)
+static int do_unpack(const std::string& packPath, const std::string& dir){
+    PackReader pack(packPath);
+    if (!pack.ok()){ std::cerr << "cannot open pack " << packPath << "\n"; return 1; }
+    pack.adviseSequential();
+    long long files = 0;
+    for (const auto& [key, ext] : pack.directory()){
+        if (!safe_key(key)){ std::cerr << "[skip] unsafe key " << key << "\n"; continue; }
+        const fs::path out = fs::path(dir) / key;
+        fs::create_directories(out.parent_path());
+        std::ofstream f(out, std::ios::binary | std::ios::trunc);
+        for (const auto sv : pack.spans(key)) f.write(sv.data(), (std::streamsize)sv.size());
+        if (!f){ std::cerr << "cannot write " << out.string() << "\n"; return 1; }
+        ++files;
+    }
+    std::cout << "Unpacked " << files << " shards into " << dir << "\n";
+    return 0;
+}
+
+// 왕복 검사: 디렉터리의 파일마다 팩의 같은 키가 같은 내용인지 (줄 단위 키는 끝 '\n' 하나까지 허용).
+// 새로 만든 팩 기준 (이어 붙인 팩은 키 내용이 파일보다 길다)
+static int do_check(const std::string& dir, const std::string& packPath){
+    PackReader pack(packPath);
+    if (!pack.ok()){ std::cerr << "cannot open pack " << packPath << "\n"; return 1; }
+    long long files = 0, bad = 0;
+    std::string want, got;
+    for (const auto& e : fs::recursive_directory_iterator(dir)){
+        if (!e.is_regular_file()) continue;
+        const std::string key = fs::relative(e.path(), dir).generic_string();
+        if (!read_file(e.path(), want)){ std::cerr << "cannot read " << e.path().string() << "\n"; return 1; }
+        got.clear();
+        pack.read(key, got);
+        const bool same = got == want
+            || (line_key(e.path()) && !want.empty() && want.back() != '\n'
+                && got.size() == want.size() + 1 && got.back() == '\n' && got.compare(0, want.size(), want) == 0);
+        if (!same){
+            std::cerr << "[mismatch] " << key << " (file " << want.size() << " bytes, pack " << got.size() << " bytes)\n";
+            ++bad;
+        }
+        ++files;
+    }
+    std::cout << "Checked " << files << " files, " << bad << " mismatches\n";
+    return bad ? 1 : 0;
+}
+
+static int do_list(const std::string& packPath){
+    PackReader pack(packPath);
+    if (!pack.ok()){ std::cerr << "cannot open pack " << packPath << "\n"; return 1; }
+    long long total = 0;
+    for (const auto& [key, ext] : pack.directory()){
+        long long bytes = 0;
+        for (const auto& x : ext) bytes += (long long)x.size;
+        total += bytes;
+        std::cout << key << "\t" << ext.size() << "\t" << bytes << "\n";
+    }
+    std::cout << "# " << pack.directory().size() << " shards, " << total << " bytes\n";
+    return 0;
+}
+
+int main(int argc, char** argv){
+    const std::string cmd = argc > 1 ? argv[1] : "";
+    if      (cmd == "pack"   && argc == 4) return do_pack(argv[2], argv[3]);
+    else if (cmd == "unpack" && argc == 4) return do_unpack(argv[2], argv[3]);
+    else if (cmd == "check"  && argc == 4) return do_check(argv[2], argv[3]);
+    else if (cmd == "ls"     && argc == 3) return do_list(argv[2]);
+
+    std::cerr << "usage: " << argv[0] << " pack <shard_dir> <file.pack>\n"
+              << "       " << argv[0] << " unpack <file.pack> <out_dir>\n"
+              << "       " << argv[0] << " check <shard_dir> <file.pack>\n"
+              << "       " << argv[0] << " ls <file.pack>\n";
+    std::cerr << "  pack:   append every file under <shard_dir> as a logical shard (key = relative path)\n";
+    std::cerr << "          (.txt/.deps/.diff get a trailing newline if missing; other files, e.g. .ifb/.ifx, are copied byte-for-byte)\n";
+    std::cerr << "  unpack: write each logical shard back to <out_dir>/<key>\n";
+    std::cerr << "  check:  round-trip check of a freshly packed <shard_dir> against <file.pack>\n";
+    std::cerr << "  ls:     key, extent count and bytes per logical shard\n";
+    return 1;
+}
@@ -0,0 +1,64 @@
+// topodb.cpp — TopologyDB 관리: 세그먼트 합치기, 중복제거, 형식 변환 (TopologyDB.hpp)
+#include <iostream>
+#include <string>
+#include "TopologyDB.hpp"
+#include "TopologyCursor.hpp"
+
+// 본 파일 + 세그먼트마다 레코드 수
+static int do_info(const TopologyDB& db){
+    const auto parts = db.parts();
+    if (parts.empty()){ std::cerr << "no such DB\n"; return 1; }
+    long long total = 0;
+    for (const auto& file : parts){
+        TopologyCursor cur = TopologyCursor::openDB(file);
+        long long n = 0;
+        while (cur.advance()) ++n;
+        total += n;
+        std::cout << file << "\t" << (cur.format() == TopologyCursor::Format::BinaryDB ? "bin" : "text") << "\t" << n << "\n";
+    }
+    std::cout << "# " << parts.size() << " parts, " << total << " records\n";
+    return 0;
+}
+
+int main(int argc, char** argv){
+    const std::string cmd = argc > 1 ? argv[1] : "";
+    if (argc >= 3){
+        const TopologyDB db(argv[2]);
+        if (cmd == "info" && argc == 3) return do_info(db);
+        if (cmd == "compact" && argc == 3){
+            if (!db.compact()){ std::cerr << "[Error] compact failed for " << argv[2] << "\n"; return 1; }
+            std::cout << "Compacted " << argv[2] << "\n";
+            return 0;
+        }
+        if (cmd == "dedupe" && (argc == 4 || argc == 5)){
+            const std::string key = argv[3];
+            const bool last = argc == 5 && std::string(argv[4]) == "--keep-last";
+            if ((key != "content" && key != "name") || (argc == 5 && !last)){
+                std::cerr << "[Error] bad dedupe arguments\n";
+                return 1;
+            }
+            // 세그먼트는 먼저 본 파일로 합쳐진다
+            const int removed = key == "content" ? db.dedupeByContentHash(last) : db.dedupeByName(last);
+            std::cout << "Removed " << removed << " duplicate records (by " << key << ")\n";
+            return 0;
+        }
+        if (cmd == "export" && argc == 5){
+            const std::string fmt = argv[4];
+            if (fmt != "bin" && fmt != "text"){ std::cerr << "[Error] bad export format " << fmt << "\n"; return 1; }
+            const bool ok = fmt == "bin" ? db.exportBinary(argv[3]) : db.exportText(argv[3]);
+            if (!ok){ std::cerr << "[Error] cannot write " << argv[3] << "\n"; return 1; }
+            std::cout << "Exported " << argv[2] << " to " << argv[3] << " (" << fmt << ")\n";
+            return 0;
+        }
+    }
+
+    std::cerr << "usage: " << argv[0] << " info <db>\n"
+              << "       " << argv[0] << " compact <db>\n"
+              << "       " << argv[0] << " dedupe <db> content|name [--keep-last]\n"
+              << "       " << argv[0] << " export <db> <out> bin|text\n";
+    std::cerr << "  info:    records per part (main file + segments listed in <db>.manifest)\n";
+    std::cerr << "  compact: fold the segments written by --out-db into the main file\n";
+    std::cerr << "  dedupe:  compact, then drop records with the same content (or name); keeps the first unless --keep-last\n";
+    std::cerr << "  export:  write main file + segments as one binary (mmap) or text DB\n";
+    return 1;
+}
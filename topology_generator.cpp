@@ -2,80 +2,43 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include "Topology.h"
 #include "TopologyDB.hpp"
+#include "TopologyCursor.hpp"
+#include "TopologyDBIndex.hpp"
 #include "Theory.h"
+#include "TopologyGraph.hpp"
+#include "RuleBanks.hpp"
+#include "YieldProfile.hpp"
+#include "PackFile.hpp"
+#include "ShardWriter.hpp"
+#include "ShardPipe.hpp"
+#include "ChainFactor.hpp"
+#include "FingerprintSet.hpp"
+#include "ShardIndex.hpp"
 #include <filesystem>
-#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <chrono>
 #include "TopoLineCompact.hpp"
+#include "TopoCanonical.hpp"
 
 // ========== Input format enum ==========
-enum class InFmt { DB, Line, Auto };
+enum class InFmt { DB, Line, Pack, Auto };
 static InFmt parse_infmt(const std::string& s){
     if (s=="db")   return InFmt::DB;
     if (s=="line") return InFmt::Line;
+    if (s=="pack") return InFmt::Pack;
     return InFmt::Auto;
 }
 
-// ========== Banks (same as original) ==========
-static constexpr int G_BANK[] = {4,6,7,8,12};
-static constexpr int L_BANK[] = {
-  11,22,33,44,55,331,32,23,42,24,43,34,53,35,54,45
-};
-
-const int numG = (int)(sizeof(G_BANK)/sizeof(G_BANK[0]));
-const int numL = (int)(sizeof(L_BANK)/sizeof(L_BANK[0]));
-
-// ========== Gluing rules ==========
-struct IntView {
-  const int* data = nullptr;
-  std::size_t size = 0;
-  bool empty() const { return size==0; }
-};
-
-#define RET_ARR(...) do { \
-  static constexpr int A__[] = { __VA_ARGS__ }; \
-  return IntView{A__, std::size(A__)}; \
-} while(0)
-
-[[nodiscard]] inline IntView allowed(LKind k, int param)
-{
-  if (k==LKind::g){
-    switch(param){
-      case 4:  RET_ARR(11,22,32,23,33,24,331,34,35);
-      case 6:  RET_ARR(22,32,33,42,331,43,34,44,53,35,45,54,55);
-      case 7:  RET_ARR(32,33,42,43,44,53,54,45,55);
-      case 8:  RET_ARR(32,33,42,43,44,53,54,45,55);
-      case 12: RET_ARR(42,53,54,55);
-      default: return {};
-    }
-  }
-
-  if (k==LKind::L){
-    switch(param){
-      case 11:  RET_ARR(4);
-      case 22:  RET_ARR(4,6);
-      case 32:  RET_ARR(4);
-      case 23:  RET_ARR(4,6,7,8);
-      case 33:  RET_ARR(4,6,7,8);
-      case 42:  RET_ARR(4);
-      case 24:  RET_ARR(6,7,8,12);
-      case 331: RET_ARR(4,6);
-      case 43:  RET_ARR(4,6);
-      case 34:  RET_ARR(6,7,8);
-      case 44:  RET_ARR(6,7,8);
-      case 53:  RET_ARR(4,6);
-      case 35:  RET_ARR(6,7,8,12);
-      case 54:  RET_ARR(6,7,8);
-      case 45:  RET_ARR(6,7,8,12);
-      case 55:  RET_ARR(6,7,8,12);
-      default: return {};
-    }
-  }
-
-  return {};
-}
-
 // ========== ✨ ADDED: Topology to TheoryGraph conversion ==========
 TheoryGraph topology_to_theory_graph(const Topology& T) {
     TheoryGraph G;
@@ -112,7 +75,8 @@ TheoryGraph topology_to_theory_graph(const Topology& T) {
     }
     
     // Connect interior links (l_connection)
-    for (const auto& conn : T.l_connection) {
+    for (int k = 0; k < T.interiorEdgeCount(); ++k) {
+        const auto conn = T.interiorEdge(k);
         if (conn.u >= 0 && conn.u < (int)nodes.size() &&
             conn.v >= 0 && conn.v < (int)nodes.size()) {
             try {
@@ -234,7 +198,95 @@ bool is_SUGRA(const TheoryGraph& G) {
 }
 
 // ========== Deduplication ==========
-static std::unordered_set<std::string> g_seen_lines;
+// 저장한 위상의 128비트 지문 (스레드 공유, 조각마다 잠금). --seen-mem을 넘으면 <out>/.seen-spill/에 run으로 흘린다
+static FingerprintSet* g_seen = nullptr;
+
+// "1G", "512M", "65536"
+static bool parse_bytes(const std::string& s, std::size_t& out){
+    char* end = nullptr;
+    const double v = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || v <= 0) return false;
+    double mul = 1;
+    switch (*end) {
+        case 'k': case 'K': mul = 1024.0; break;
+        case 'm': case 'M': mul = 1024.0 * 1024; break;
+        case 'g': case 'G': mul = 1024.0 * 1024 * 1024; break;
+        case '\0': break;
+        default: return false;
+    }
+    out = (std::size_t)(v * mul);
+    return true;
+}
+
+// ========== Canonical mode (--canonical) ==========
+// 체인과 그 반사는 같은 이론: 정규형 하나만 저장하고, 그 양 끝을 확장한다
+static bool g_canonical = false;
+
+// ========== Known DB (--known) ==========
+// 이미 대상 DB에 있는 구조는 다시 분류/저장하지 않는다 (인덱스 조회 + 레코드 확인).
+// 본 파일과 세그먼트마다 인덱스 + 커서. 커서가 seek하므로 스레드마다 하나씩 연다
+struct KnownDB {
+    struct Part {
+        TopologyDBIndex idx;
+        TopologyCursor  cur;
+    };
+    std::vector<std::unique_ptr<Part>> parts;
+    Topology        rec;
+    std::vector<std::uint64_t> offs;
+
+    bool open(const std::string& dbPath){
+        parts.clear();
+        for (const auto& file : TopologyDB(dbPath).parts()) {
+            auto p = std::make_unique<Part>();
+            p->cur = TopologyCursor::openDB(file);
+            if (!p->cur.ok() || !p->idx.openOrRebuild(file)) return false;
+            parts.push_back(std::move(p));
+        }
+        return !parts.empty();
+    }
+    bool contains(const Topology& T){
+        const auto h = TopologyDBIndex::contentHash(T);
+        for (auto& p : parts) {
+            p->idx.findContent(h, offs);
+            for (const auto off : offs)
+                if (p->cur.seek(off) && p->cur.advance() && p->cur.decode(rec) && TopologyDBIndex::sameContent(rec, T)) return true;
+        }
+        return false;
+    }
+};
+static std::string g_known_path;
+
+// ========== Known shards (--known-shards) ==========
+// shard_compact를 거친 이전 출력 트리 (<dir>/<category>/len-N/<prefix>.txt + .sidx).
+// 같은 자리의 샤드를 .sidx로 seek해서 한 블록만 읽고 이미 있으면 건너뛴다
+static std::string g_known_shards;
+
+// ========== DB output (--out-db) ==========
+// 샤드 파일 대신 TopologyDB 세그먼트에 묶어 쓴다 (이름 = 분류). 여러 프로세스가 같은 DB에 동시에 써도 된다
+static TopologyDB::Writer* g_outdb = nullptr;
+static std::mutex          g_outdb_mtx;   // writer 하나를 스레드들이 나눠 쓴다
+
+// ========== Shard output ==========
+// <category>/len-N/<prefix>.txt (출력 루트 기준; --out-pack이면 팩의 논리 샤드로).
+// 워커마다 ShardPipe::Local에 모으고 쓰기 스레드 하나가 ShardWriter에 쓴다 (워커는 디스크/공유 잠금을 잡지 않는다)
+static ShardPipe* g_pipe = nullptr;
+
+// ========== Worker scratch ==========
+class GenPool;
+struct GenScratch {
+    int                      tid = 0;
+    YieldSlot*               prof = nullptr;   // --profile (스레드별 칸)
+    std::unique_ptr<KnownDB> known;            // --known
+    std::unique_ptr<ShardLookup> knownShards;  // --known-shards
+    Topology                 sorted;           // --known-shards 조회 키 (장식 정렬, 재사용)
+    std::string              line;             // line-compact 출력 버퍼 (재사용)
+    std::string              key;              // 지문용 바이너리 키 (재사용)
+    std::unique_ptr<ShardPipe::Local>           out;      // 샤드 출력 (--out-db가 아닐 때)
+    std::unordered_map<std::uint32_t, ShardPipe::Id> shards; // shard_key -> 파이프 번호
+    GenPool*                 pool = nullptr;
+    long long                saved = 0;
+    long long                pruned = 0;       // 관성으로 잘라낸 죽은 확장 (ChainFactor)
+};
 
 // ========== Sharding utilities (✨ MODIFIED: added category parameter) ==========
 static std::string prefix_from(const Topology& T, int upto=4){
@@ -253,12 +305,12 @@ static std::string prefix_from(const Topology& T, int upto=4){
     return s;
 }
 
-static std::string shard_path(const Topology& T, const std::string& outdir, const std::string& category) {
-    const int len = (int)T.block.size();
-    const std::string pref = prefix_from(T,4);
-    std::string dir = outdir + "/" + category + "/len-" + std::to_string(len);  // ✨ MODIFIED: added category subdir
-    std::filesystem::create_directories(dir);
-    return dir + "/" + pref + ".txt";
+// (분류, 길이, 앞 4블록) -> 정수 키. 블록 종류는 2비트씩, 앞 블록 수 3비트
+static std::uint32_t shard_key(bool lst, const Topology& T){
+    const int nb = (int)T.block.size(), n = std::min(nb, 4);
+    std::uint32_t k = (std::uint32_t)nb;
+    for (int i = 0; i < n; ++i) k = (k << 2) | (std::uint32_t)T.block[i].kind;
+    return (((k << 3) | (std::uint32_t)n) << 1) | (lst ? 1u : 0u);
 }
 
 // ========== Unimodal check (✨ MODIFIED: treat g=7 and g=8 as equivalent) ==========
@@ -288,41 +340,114 @@ static inline bool g_unimodal_prefix_ok(const Topology& T){
     return is_unimodal_non_strict(gvals);
 }
 
+// ========== Classification ==========
+// 반환: kYieldLST / kYieldSCFT / kYieldNonPhysical / kYieldError (조립/분류 실패)
+static int classify_chain(const Topology& T){
+    try {
+        TheoryGraph G = topology_to_theory_graph(T);
+        if (is_LST(G))  return kYieldLST;
+        if (is_SCFT(G)) return kYieldSCFT;
+        return kYieldNonPhysical;
+    } catch (const std::exception& e) {
+        return kYieldError;
+    }
+}
+
+// ========== Multi-step mode (--max-len) ==========
+// 시드에서 길이 N까지 깊이 우선으로 키운다. 중간 길이는 분류만 하고 (LST/SCFT만 더 키움 = 한 단계씩
+// 다시 돌리는 것과 같은 가지) 파일에 쓰지 않는다. 스택에는 체인 하나씩만 있다 (메모리 O(깊이))
+static int               g_max_len = 0;   // 0: 한 단계 (기존)
+static std::vector<char> g_emit_len;      // 저장할 길이 (--emit-len; 비면 N만)
+
+static bool emit_len(int len){
+    if (g_max_len <= 0) return true;
+    if (g_emit_len.empty()) return len == g_max_len;
+    return len < (int)g_emit_len.size() && g_emit_len[len];
+}
+
+// "5,7,9"
+static bool parse_len_list(const std::string& s, std::vector<char>& out){
+    out.clear();
+    std::size_t p = 0;
+    while (p <= s.size()) {
+        const std::size_t c = std::min(s.find(',', p), s.size());
+        const int n = std::atoi(s.substr(p, c - p).c_str());
+        if (n <= 0) return false;
+        if ((int)out.size() <= n) out.resize(n + 1, 0);
+        out[n] = 1;
+        p = c + 1;
+    }
+    return !out.empty();
+}
+
 // ========== ✨ MODIFIED: Save with classification (only LST/SCFT) ==========
-static inline void save_one_compact_classified(const Topology& T, const std::string& outdir){
-    const std::string line = serialize_line_compact(T);
-    if (!g_seen_lines.insert(line).second) return; 
+// 반환: 결과 YieldCol (duplicate / error / non_lst_scft / lst / scft).
+// known: ChainFactor가 이미 정한 판정 (-1이면 고윳값으로 분류)
+static inline int save_one_compact_classified(const Topology& T0, GenScratch& sc, int known = -1){
+    Topology canon;
+    if (g_canonical) { canon = T0; canonicalize(canon); }
+    const Topology& T = g_canonical ? canon : T0;
+    if (!g_seen->insert(topology_fingerprint(T, sc.key))) return kYieldDuplicate;
+    if (sc.known && sc.known->contains(T)) return kYieldDuplicate;
+    if (sc.knownShards) {
+        sc.sorted = T;
+        sort_decorations(sc.sorted);
+        const int len = (int)T.block.size();
+        const std::string prefix = prefix_from(T, 4);
+        for (const char* cat : {"LST", "SCFT"})
+            if (sc.knownShards->contains(ShardWriter::shard_path(g_known_shards, cat, len, prefix), sc.sorted))
+                return kYieldDuplicate;
+    }
     
-    // ✨ ADDED: Convert to TheoryGraph and classify
+    const int outcome = known >= 0 ? known : classify_chain(T);
+    // ✨ ADDED: Only save LST or SCFT
+    if (outcome != kYieldLST && outcome != kYieldSCFT) return outcome;
+    std::string& line = sc.line;
+    line.clear();
+    append_line_compact(line, T);
+    const char* category = outcome == kYieldLST ? "LST" : "SCFT";
     try {
-        TheoryGraph G = topology_to_theory_graph(T);
-        
-        std::string category = "other";
-        if (is_LST(G)) {
-            category = "LST";
-        } else if (is_SCFT(G)) {
-            category = "SCFT";
-        }
-        // ✨ ADDED: Only save LST or SCFT
-        else {
-            return; // Skip this topology
+        if (g_outdb) {
+            Topology R = T;
+            R.name = category;
+            std::lock_guard<std::mutex> lock(g_outdb_mtx);
+            if (!g_outdb->add(R)) return kYieldError;
+        } else {
+            const std::uint32_t k = shard_key(outcome == kYieldLST, T);
+            auto it = sc.shards.find(k);
+            if (it == sc.shards.end())
+                it = sc.shards.emplace(k, sc.out->shard("", category, (int)T.block.size(), prefix_from(T, 4))).first;
+            sc.out->append_line(it->second, line);
         }
-        
-        const std::string path = shard_path(T, outdir, category);
-        std::ofstream fout(path, std::ios::app);
-        fout << line << '\n';
+        return outcome;
     } catch (const std::exception& e) {
-        // Failed to convert or classify - skip
-        return;
+        return kYieldError;
     }
 }
 
 // ========== Generation ==========
-static int generate_one_step(const Topology& base, const std::string& outDir)
+// --canonical --max-len: 쓰지 않는 중간 길이 체인은 save의 중복 검사를 거치지 않는다.
+// 양 끝으로 키우면 같은 체인에 왼쪽/오른쪽 순서마다 한 번씩 닿으므로, 정규형마다 처음 닿았을 때만 더 키운다.
+// 출력용 지문과 같은 집합에 넣되 키 끝에 표시를 붙여 구분한다
+static bool first_growth(const Topology& t, GenScratch& sc)
 {
-    if (base.block.empty()) return 0;
+    if (!g_canonical) return true;
+    Topology c = t;
+    canonicalize(c);
+    pack_topology_key(sc.key, c);
+    sc.key += "grow";
+    return g_seen->insert(fingerprint_bytes(sc.key.data(), sc.key.size()));
+}
 
-    if (!g_unimodal_prefix_ok(base)) return 0;
+static int extend_chain(const Topology& in, const ChainFactor& f, GenScratch& sc);
+static bool pool_hungry(const GenScratch& sc);
+static void pool_spawn(GenScratch& sc, Topology&& t, const ChainFactor& f);
+
+// 오른쪽 끝에 블록 하나씩 붙여 본다 (본체 검사는 호출 쪽에서).
+// f: base의 소거 상태. 자식 상태는 블록 하나만큼 갱신하고, 죽은 자식은 분류/중복 검사 없이 버린다.
+// --max-len이면 LST/SCFT가 된 자식을 바로 이어서 키운다
+static int extend_right(const Topology& base, const ChainFactor& f, GenScratch& sc)
+{
     const auto& last = base.block.back();
     const LKind k = last.kind;
     const int   p = last.param;
@@ -335,53 +460,300 @@ static int generate_one_step(const Topology& base, const std::string& outDir)
 
     int saved = 0;
     for (std::size_t i = 0; i < opts.size; ++i) {
-        Topology t = base;
         const int nextParam = opts.data[i];
 
         const LKind nextKind = (k == LKind::g ? LKind::L : LKind::g);
+        // 프로파일 키: (붙는 g 값, L 코드)
+        const int kg = (k == LKind::g) ? p : nextParam;
+        const int kl = (k == LKind::g) ? nextParam : p;
+        if (sc.prof) sc.prof->tried('L', kg, kl);
+
+        // 텐서를 만들기 전에 새 간선만 검사 (예외 없음)
+        const GlueStatus st = validate_extension(last, nextKind, nextParam);
+        if (st != GlueStatus::Ok) {
+            if (sc.prof) sc.prof->reject('L', kg, kl, st);
+            continue;
+        }
+
+        Topology t = base;
         t.addBlockRight(nextKind, nextParam);
 
-        if (!g_unimodal_prefix_ok(t)) continue;
-        save_one_compact_classified(t, outDir); ++saved;
+        if (!g_unimodal_prefix_ok(t)) {
+            if (sc.prof) sc.prof->add('L', kg, kl, kYieldUnimodal);
+            continue;
+        }
+        // 양의 고윳값 또는 0 두 개: 이 자식과 그 아래 가지 전체가 LST/SCFT가 아니다
+        const ChainFactor cf = extend_factor(f, nextKind, nextParam);
+        if (cf.dead()) {
+            ++sc.pruned;
+            if (sc.prof) sc.prof->add('L', kg, kl, kYieldNonPhysical);
+            continue;
+        }
+        const int  len  = (int)t.block.size();
+        const bool emit = emit_len(len);
+        const int  known = cf.yield();
+        const int outcome = emit ? save_one_compact_classified(t, sc, known)
+                                 : (known >= 0 ? known : classify_chain(t));
+        const bool physical = outcome == kYieldLST || outcome == kYieldSCFT;
+        if (emit && physical) ++saved;   // 실제로 쓴 것만 (중복으로 거절된 것은 빼고)
+        if (sc.prof) sc.prof->add('L', kg, kl, outcome);
+
+        // 노는 스레드가 있으면 가지를 작업으로 내놓고, 아니면 바로 재귀 (스택 = 깊이).
+        // 저장한 길이는 save의 중복 검사가 이미 걸렀다. 안 쓰는 중간 길이는 --canonical에서 여기서 거른다
+        if (len < g_max_len && physical && (emit || first_growth(t, sc))) {
+            if (pool_hungry(sc)) pool_spawn(sc, std::move(t), cf);
+            else                 saved += extend_chain(t, cf, sc);
+        }
+    }
+    return saved;
+}
+
+// 본체 검사를 마친 체인의 확장 (--canonical이면 양 끝)
+static int extend_chain(const Topology& in, const ChainFactor& f, GenScratch& sc)
+{
+    if (!g_canonical) return extend_right(in, f, sc);
+
+    // 정규형의 오른쪽 + 반사본의 오른쪽(= 정규형의 왼쪽). 반사하면 소거 상태의 양 끝도 바뀐다.
+    // 반사본은 g로 시작할 때만 (L로 양 끝이 막힌 체인은 g 시드에서 나오지 않는다)
+    Topology base = in, mirror;
+    ChainFactor fb = f;
+    if (canonicalize(base)) fb.reflect();
+    int saved = extend_right(base, fb, sc);
+    if (reflect_topology(base, mirror) && mirror.block.front().kind == LKind::g
+        && compare_topology(mirror, base) != 0) {
+        ChainFactor fm = fb;
+        fm.reflect();
+        saved += extend_right(mirror, fm, sc);
     }
     return saved;
 }
 
-// ========== Process DB ==========
-static int expand_db_one_step(const TopologyDB& inDB, const std::string& outDir)
+static int generate_one_step(const Topology& in, GenScratch& sc)
 {
-    int total = 0;
-    auto recs = inDB.loadAll();
+    if (in.block.empty()) return 0;
 
-    for (const auto& r : recs) {
-        total += generate_one_step(r.topo, outDir);
+    const int g0 = in.block[0].param;
+    if (!g_unimodal_prefix_ok(in)) {
+        if (sc.prof) { sc.prof->tried('B', g0, 0); sc.prof->add('B', g0, 0, kYieldUnimodal); }
+        return 0;
+    }
+    // 본체가 규칙을 어기면 모든 확장이 실패한다
+    const GlueStatus baseSt = validate_topology(in);
+    if (baseSt != GlueStatus::Ok) {
+        if (sc.prof) { sc.prof->tried('B', g0, 0); sc.prof->reject('B', g0, 0, baseSt); }
+        return 0;
+    }
+    if (g_max_len > 0 && (int)in.block.size() >= g_max_len) return 0;
+    // 시드의 소거 상태는 한 번만 (블록마다 접는다). 시드가 이미 죽었으면 어떤 확장도 남지 않는다
+    const ChainFactor f = factor_chain(in);
+    if (f.dead()) {
+        ++sc.pruned;
+        if (sc.prof) { sc.prof->tried('B', g0, 0); sc.prof->add('B', g0, 0, kYieldNonPhysical); }
+        return 0;
+    }
+    return extend_chain(in, f, sc);
+}
+
+// ========== Parallel generation (work-stealing pool) ==========
+// 작업 = 체인 하나 (시드: 본체 검사부터 / 가지: --max-len에서 내놓은 중간 체인).
+// 스레드마다 deque 하나: 주인은 뒤에서 꺼내고 (깊이 우선, 메모리 O(깊이)), 일이 없는 스레드는
+// 남의 앞에서 훔친다 (먼저 들어온 = 큰 가지). 가지는 노는 스레드가 있을 때만 내놓는다.
+// 시드는 뒤에 있어도 앞에서부터 꺼낸다: --threads 1이면 (가지가 없으니) 입력 순서대로 처리되어
+// 샤드의 줄 순서까지 실행마다 같다. 여러 스레드면 내용만 같고 줄 순서는 달라진다 (shard_compact로 정렬).
+struct GenTask {
+    Topology    T;
+    ChainFactor F;          // 가지: T의 소거 상태 (시드는 generate_one_step에서)
+    bool        seed = true;
+};
+
+class GenPool {
+public:
+    GenPool(int threads, YieldProfile* profile)
+        : maxQueued_(64 * (size_t)std::max(1, threads))
+    {
+        for (int t = 0; t < threads; ++t) {
+            auto sc = std::make_unique<GenScratch>();
+            sc->tid  = t;
+            sc->pool = this;
+            if (g_pipe) sc->out = std::make_unique<ShardPipe::Local>(*g_pipe);
+            if (profile) sc->prof = &profile->slot(t);
+            if (!g_known_path.empty()) {
+                sc->known = std::make_unique<KnownDB>();
+                if (!sc->known->open(g_known_path)) sc->known.reset();
+            }
+            if (!g_known_shards.empty()) sc->knownShards = std::make_unique<ShardLookup>();
+            scratch_.push_back(std::move(sc));
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (int t = 0; t < threads; ++t) workers_.emplace_back([this, t]{ worker(t); });
+    }
+
+    ~GenPool() { finish(); }
+
+    // 읽는 쪽: 시드 하나. 대기 작업이 많으면 줄 때까지 기다린다 (메모리는 입력 크기와 무관)
+    void submit(Topology&& T) {
+        {
+            // 일꾼은 잠금 없이 알리므로 가끔 다시 본다
+            std::unique_lock<std::mutex> lock(mtx_);
+            while (queued_.load() >= maxQueued_) space_cv_.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        push(next_++ % queues_.size(), GenTask{std::move(T), ChainFactor{}, true});
+    }
+
+    // 일꾼: 자기 deque에 가지 하나
+    void spawn(int tid, Topology&& T, const ChainFactor& F) { push((size_t)tid, GenTask{std::move(T), F, false}); }
+    bool hungry() const noexcept { return idle_.load(std::memory_order_relaxed) > 0; }
+
+    // 입력이 끝났다: 남은 작업을 마치고 스레드를 거둔다. 반환: 저장 시도 수
+    long long finish(long long* pruned = nullptr) {
+        if (!workers_.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                closed_ = true;
+            }
+            cv_.notify_all();
+            for (auto& t : workers_) t.join();
+            workers_.clear();
+            for (auto& sc : scratch_) if (sc->out) sc->out->flush();
+        }
+        long long saved = 0;
+        if (pruned) *pruned = 0;
+        for (const auto& sc : scratch_) {
+            saved += sc->saved;
+            if (pruned) *pruned += sc->pruned;
+        }
+        return saved;
+    }
+
+    // --known-shards에서 .sidx가 없어 건너뛴 샤드 수 (스레드마다 따로 열므로 가장 많이 본 스레드 기준)
+    std::size_t unindexed_shards() const {
+        std::size_t n = 0;
+        for (const auto& sc : scratch_) if (sc->knownShards) n = std::max(n, sc->knownShards->unindexed());
+        return n;
+    }
+
+private:
+    struct Queue {
+        std::mutex          mtx;
+        std::deque<GenTask> q;
+    };
+
+    void push(size_t qi, GenTask&& task) {
+        ++pending_;
+        {
+            std::lock_guard<std::mutex> lock(queues_[qi]->mtx);
+            queues_[qi]->q.push_back(std::move(task));
+        }
+        ++queued_;
+        { std::lock_guard<std::mutex> lock(mtx_); }
+        cv_.notify_one();
+    }
+
+    // 자기 deque 뒤 (시드면 앞) -> 다른 deque 앞 (tid 다음부터 돌며)
+    bool pop(int tid, GenTask& out) {
+        {
+            Queue& own = *queues_[tid];
+            std::lock_guard<std::mutex> lock(own.mtx);
+            if (!own.q.empty() && !own.q.back().seed) { out = std::move(own.q.back()); own.q.pop_back(); return true; }
+            if (!own.q.empty()) { out = std::move(own.q.front()); own.q.pop_front(); return true; }
+        }
+        const size_t n = queues_.size();
+        for (size_t k = 1; k < n; ++k) {
+            Queue& v = *queues_[(tid + k) % n];
+            std::lock_guard<std::mutex> lock(v.mtx);
+            if (!v.q.empty()) { out = std::move(v.q.front()); v.q.pop_front(); return true; }
+        }
+        return false;
+    }
+
+    void worker(int tid) {
+        GenScratch& sc = *scratch_[tid];
+        GenTask task;
+        for (;;) {
+            if (pop(tid, task)) {
+                if (--queued_ < maxQueued_) space_cv_.notify_one();
+                sc.saved += task.seed ? generate_one_step(task.T, sc) : extend_chain(task.T, task.F, sc);
+                if (--pending_ == 0) {
+                    { std::lock_guard<std::mutex> lock(mtx_); }
+                    cv_.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mtx_);
+            ++idle_;
+            cv_.wait(lock, [this]{ return queued_.load() > 0 || (closed_ && pending_.load() == 0); });
+            --idle_;
+            if (queued_.load() == 0 && closed_ && pending_.load() == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<GenScratch>> scratch_;
+    std::vector<std::unique_ptr<Queue>>      queues_;
+    std::vector<std::thread>                 workers_;
+    const size_t              maxQueued_;
+    size_t                    next_ = 0;       // 시드를 돌아가며 넣을 deque
+    std::atomic<size_t>       queued_{0};      // deque에 있는 작업
+    std::atomic<long long>    pending_{0};     // 넣었지만 아직 끝나지 않은 작업
+    std::atomic<int>          idle_{0};
+    bool                      closed_ = false; // mtx_
+    std::mutex                mtx_;
+    std::condition_variable   cv_, space_cv_;
+};
+
+static bool pool_hungry(const GenScratch& sc) { return sc.pool && sc.pool->hungry(); }
+static void pool_spawn(GenScratch& sc, Topology&& t, const ChainFactor& f) { sc.pool->spawn(sc.tid, std::move(t), f); }
+
+// ========== Process input (cursor) ==========
+// 반환: 읽은 레코드 수 (확장은 풀에서)
+static long long expand_cursor(TopologyCursor& cur, GenPool& pool)
+{
+    long long read = 0;
+    Topology T;
+    while (cur.next(T)) { pool.submit(std::move(T)); ++read; }
+    return read;
+}
+
+// 본 파일 + manifest의 세그먼트 (--out-db로 쓴 DB는 세그먼트만 있을 수 있다)
+static long long expand_db_one_step(const std::string& dbPath, GenPool& pool)
+{
+    long long total = 0;
+    for (const auto& part : TopologyDB(dbPath).parts()) {
+        TopologyCursor cur = TopologyCursor::openDB(part);
+        total += expand_cursor(cur, pool);
     }
     return total;
 }
 
-// ========== Process line files ==========
-static long long process_line_file(const std::string& path, const std::string& outDir){
-    std::ifstream fin(path);
-    if (!fin){ std::cerr << "[skip] cannot open " << path << "\n"; return 0; }
-    long long made = 0; std::string line;
-    while (std::getline(fin, line)){
-        if (line.empty()) continue;
-        Topology T;
-        if (!deserialize_line_compact(line, T)) continue;
-        made += generate_one_step(T, outDir);
-    }
-    return made;
+static long long process_line_file(const std::string& path, GenPool& pool){
+    TopologyCursor cur(path, TopologyCursor::Format::Line);
+    if (!cur.ok()){ std::cerr << "[skip] cannot open " << path << "\n"; return 0; }
+    return expand_cursor(cur, pool);
 }
 
-static long long process_line_path(const std::string& inPath, const std::string& outDir){
+// 팩의 논리 샤드(.txt 키)를 차례로
+static long long process_pack(const std::string& packPath, GenPool& pool){
+    PackReader pack(packPath);
+    if (!pack.ok()){ std::cerr << "[skip] cannot open pack " << packPath << "\n"; return 0; }
+    pack.adviseSequential();
+    long long total = 0;
+    TopologyCursor cur;
+    for (const auto& [key, ext] : pack.directory()){
+        if (std::filesystem::path(key).extension() != ".txt") continue;
+        cur.openSpans(pack.spans(key));
+        total += expand_cursor(cur, pool);
+    }
+    return total;
+}
+
+static long long process_line_path(const std::string& inPath, GenPool& pool){
     long long total = 0;
     if (std::filesystem::is_directory(inPath)){
         for (auto& e: std::filesystem::recursive_directory_iterator(inPath)){
             if (e.is_regular_file() && e.path().extension()==".txt")
-                total += process_line_file(e.path().string(), outDir);
+                total += process_line_file(e.path().string(), pool);
         }
     } else {
-        total += process_line_file(inPath, outDir);
+        total += process_line_file(inPath, pool);
     }
     return total;
 }
@@ -390,37 +762,131 @@ static long long process_line_path(const std::string& inPath, const std::string&
 int main(int argc, char** argv)
 {
     if (argc < 3){
-        std::cerr << "usage: " << argv[0] << " <input> <out_dir> [--in db|line|auto]\n";
+        std::cerr << "usage: " << argv[0] << " <input> <out_dir> [--in db|line|pack|auto] [--profile report.json] [--canonical] [--known db] [--known-shards dir] [--out-db db]"
+                  << " [--out-pack file.pack] [--max-len N [--emit-len a,b,...]] [--threads N] [--seen-mem BYTES]\n";
         std::cerr << "  Generates topologies and saves only LST and SCFT to line-compact format\n";
+        std::cerr << "  --canonical: store one representative per chain/mirror pair and grow it at both ends\n";
+        std::cerr << "  --known: skip topologies already stored in this TopologyDB (uses <db>.idx)\n";
+        std::cerr << "  --known-shards: skip topologies already in this output tree (shards must be sorted by shard_compact;\n"
+                  << "                  shards without a current .sidx are ignored)\n";
+        std::cerr << "  --out-db: write LST/SCFT records into this TopologyDB (own segment; readers see all segments,\n"
+                  << "          fold them into the main file with: topodb compact <db>)\n";
+        std::cerr << "  --out-pack: write the shards as logical shards of one pack file (appendable; see shard_pack)\n";
+        std::cerr << "  --max-len: grow each seed depth-first up to N blocks in one run (only LST/SCFT prefixes are grown,\n"
+                  << "             as when rerunning on the previous output); intermediate lengths are not written\n";
+        std::cerr << "  --emit-len: lengths to save in --max-len mode (default: N only)\n";
+        std::cerr << "  --threads: worker threads (default: all cores); with 1 the shard lines follow the input order,\n"
+                  << "             with more only the content is deterministic (sort with shard_compact)\n";
+        std::cerr << "  --seen-mem: memory for the dedupe fingerprint table (default 1G); beyond it sorted runs\n"
+                  << "              are spilled to <out_dir>/.seen-spill/ and removed at exit; minimum 16K\n"
+                  << "              (budgets under 1M use fewer lock stripes)\n";
         return 1;
     }
     std::string inPath  = argv[1];
     std::string outPath = argv[2];
     InFmt inFmt = InFmt::Auto;
+    std::string profilePath, knownPath, knownShards, outDbPath, packPath;
+    std::size_t seenMem = std::size_t(1) << 30;
+    int num_threads = (int)std::thread::hardware_concurrency();
+    if (num_threads <= 0) num_threads = 4;
     for (int i=3;i<argc;i++){
         if (std::string(argv[i])=="--in" && i+1<argc) inFmt = parse_infmt(argv[++i]);
+        else if (std::string(argv[i])=="--profile" && i+1<argc) profilePath = argv[++i];
+        else if (std::string(argv[i])=="--canonical") g_canonical = true;
+        else if (std::string(argv[i])=="--known" && i+1<argc) knownPath = argv[++i];
+        else if (std::string(argv[i])=="--known-shards" && i+1<argc) knownShards = argv[++i];
+        else if (std::string(argv[i])=="--out-db" && i+1<argc) outDbPath = argv[++i];
+        else if (std::string(argv[i])=="--out-pack" && i+1<argc) packPath = argv[++i];
+        else if (std::string(argv[i])=="--threads" && i+1<argc) num_threads = std::max(1, std::atoi(argv[++i]));
+        else if (std::string(argv[i])=="--seen-mem" && i+1<argc) {
+            if (!parse_bytes(argv[++i], seenMem)) { std::cerr << "[Error] bad --seen-mem " << argv[i] << "\n"; return 1; }
+            if (seenMem < FingerprintSet::kMinBytes) {
+                std::cerr << "[Error] --seen-mem " << argv[i] << " is below the minimum " << FingerprintSet::kMinBytes << " bytes (16K)\n";
+                return 1;
+            }
+        }
+        else if (std::string(argv[i])=="--max-len" && i+1<argc) g_max_len = std::max(0, std::atoi(argv[++i]));
+        else if (std::string(argv[i])=="--emit-len" && i+1<argc) {
+            if (!parse_len_list(argv[++i], g_emit_len)) { std::cerr << "[Error] bad --emit-len " << argv[i] << "\n"; return 1; }
+        }
     }
+    if (!g_emit_len.empty() && g_max_len <= 0) { std::cerr << "[Error] --emit-len needs --max-len\n"; return 1; }
     std::filesystem::create_directories(outPath);
 
-    int saved = 0;
+    // 인덱스가 없으면 여기서 한 번 만든다 (스레드마다 다시 열기만)
+    if (!knownPath.empty()) {
+        KnownDB known;
+        if (known.open(knownPath)) g_known_path = knownPath;
+        else std::cerr << "[warn] cannot open known DB " << knownPath << "\n";
+    }
+
+    if (!knownShards.empty()) {
+        if (std::filesystem::is_directory(knownShards)) g_known_shards = knownShards + "/";
+        else std::cerr << "[warn] cannot open known shard dir " << knownShards << "\n";
+    }
+
+    TopologyDB::Writer outDb;
+    if (!outDbPath.empty()) {
+        outDb = TopologyDB(outDbPath).segmentWriter();
+        if (!outDb.ok()) { std::cerr << "cannot open output DB " << outDbPath << "\n"; return 1; }
+        g_outdb = &outDb;
+    }
+
+    PackWriter pack;
+    if (!packPath.empty() && !g_outdb) {
+        if (!pack.open(packPath)) { std::cerr << "cannot open pack " << packPath << "\n"; return 1; }
+    }
+    ShardWriter out(outPath, pack.ok() ? &pack : nullptr);
+    std::unique_ptr<ShardPipe> pipe;
+    if (!g_outdb) { pipe = std::make_unique<ShardPipe>(out); g_pipe = pipe.get(); }
+
+    FingerprintSet seen(seenMem, outPath + "/.seen-spill");
+    g_seen = &seen;
+
+    YieldProfile profile(num_threads);
+    GenPool pool(num_threads, profilePath.empty() ? nullptr : &profile);
+
     if (inFmt==InFmt::DB){
-        TopologyDB inDB(inPath);
-        saved = expand_db_one_step(inDB, outPath);
+        expand_db_one_step(inPath, pool);
     } else if (inFmt==InFmt::Line){
-        saved = (int)process_line_path(inPath, outPath);
+        process_line_path(inPath, pool);
+    } else if (inFmt==InFmt::Pack){
+        process_pack(inPath, pool);
     } else { // Auto
         if (std::filesystem::is_directory(inPath)){
-            saved = (int)process_line_path(inPath, outPath);
+            process_line_path(inPath, pool);
+        } else if (PackReader::isPack(inPath)){
+            process_pack(inPath, pool);
         } else {
             try {
-                TopologyDB inDB(inPath);
-                saved = expand_db_one_step(inDB, outPath);
+                expand_db_one_step(inPath, pool);
             } catch (...) {
-                saved = (int)process_line_path(inPath, outPath);
+                process_line_path(inPath, pool);
             }
         }
     }
-    std::cout << "Generated " << saved << " LST/SCFT topologies into " << outPath
-              << " (line-compact, sharded by category)\n";
+    long long pruned = 0;
+    const long long saved = pool.finish(&pruned);
+    if (pipe && !pipe->close()) { std::cerr << "failed to write output under " << outPath << "\n"; return 1; }
+    if (g_outdb) {
+        const std::size_t n = outDb.count();
+        if (!outDb.close()) { std::cerr << "failed to commit output DB " << outDbPath << "\n"; return 1; }
+        std::cout << "Generated " << saved << " LST/SCFT topologies; " << n << " records into " << outDbPath
+                  << " (segment)\n";
+    } else if (pack.ok()) {
+        if (!pack.close()) { std::cerr << "failed to write pack " << packPath << "\n"; return 1; }
+        std::cout << "Generated " << saved << " LST/SCFT topologies into " << packPath
+                  << " (line-compact, packed shards)\n";
+    } else {
+        std::cout << "Generated " << saved << " LST/SCFT topologies into " << outPath
+                  << " (line-compact, sharded by category)\n";
+    }
+    if (const std::size_t n = pool.unindexed_shards())
+        std::cerr << "[warn] " << n << " shards under " << knownShards << " have no current .sidx (run shard_compact); not checked\n";
+    if (pruned > 0) std::cout << "Cut " << pruned << " dead prefixes (positive or repeated null direction)\n";
+    if (!profilePath.empty()) {
+        if (profile.writeJson(profilePath, "topology_generator")) std::cout << "Profile: " << profilePath << "\n";
+        else std::cerr << "[warn] cannot write " << profilePath << "\n";
+    }
     return 0;
 }